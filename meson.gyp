@@ -146,12 +146,24 @@
                         'src/renderer/resources/extensions/web_view.js',
                     ],
                     'outputs': [
-                        'src/renderer/resources/extensions/web_view.js.bin',
+                        'src/renderer/resources/extensions/web_view.js.gz',
                     ],
-                    'action_name': 'xxd web_view.js',
-                    'action': ['xxd', '-i',
+                    'action_name': 'gzip web_view.js',
+                    'action': ['python', 'script/gzip_file.py',
                                'src/renderer/resources/extensions/web_view.js',
-                               'src/renderer/resources/extensions/web_view.js.bin'],
+                               'src/renderer/resources/extensions/web_view.js.gz'],
+                },
+                {
+                    'inputs': [
+                        'src/renderer/resources/extensions/web_view.js.gz',
+                    ],
+                    'outputs': [
+                        'src/renderer/resources/extensions/web_view.js.gz.bin',
+                    ],
+                    'action_name': 'xxd web_view.js.gz',
+                    'action': ['xxd', '-i',
+                               'src/renderer/resources/extensions/web_view.js.gz',
+                               'src/renderer/resources/extensions/web_view.js.gz.bin'],
                 },
                 {
                     'inputs': [
@@ -218,6 +230,15 @@
                 'libraries': [ '<@(libchromiumcontent_v8_libraries)' ],
             },
             'conditions': [
+                ['libchromiumcontent_component==0', {
+                    'link_settings': {
+                        # inflate() for the embedded web_view.js. zlib is one
+                        # of the shared libraries in the component build.
+                        'libraries': [
+                            '<(libchromiumcontent_dir)/libchrome_zlib.a',
+                        ],
+                    },
+                }],  # libchromiumcontent_component==0
                 ['OS=="mac" and mas_build==0', {
                     'dependencies': [
                     ],
@@ -0,0 +1,24 @@
+#!/usr/bin/env python
+
+import gzip
+import sys
+
+
+def main():
+  if len(sys.argv) != 3:
+    print('Usage: gzip_file.py <input> <output>')
+    return 1
+
+  with open(sys.argv[1], 'rb') as f:
+    data = f.read()
+  # Fixed mtime and no file name so the output is reproducible.
+  with open(sys.argv[2], 'wb') as raw:
+    out = gzip.GzipFile(filename='', mode='wb', compresslevel=9,
+                        fileobj=raw, mtime=0)
+    out.write(data)
+    out.close()
+  return 0
+
+
+if __name__ == '__main__':
+  sys.exit(main())
@@ -0,0 +1,214 @@
+#include "api/api_frame_ring_buffer.h"
+
+#include <string.h>
+#include <map>
+#include "base/lazy_instance.h"
+#include "base/logging.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+
+namespace meson {
+namespace {
+const int kBytesPerPixel = 4;
+
+struct FrameRingBufferRegistry {
+  base::Lock lock;
+  unsigned int next_id = 1;
+  std::map<unsigned int, scoped_refptr<FrameRingBuffer>> rings;
+};
+base::LazyInstance<FrameRingBufferRegistry>::Leaky g_frame_ring_registry = LAZY_INSTANCE_INITIALIZER;
+}
+
+// static
+scoped_refptr<FrameRingBuffer> FrameRingBuffer::Create(int slot_count, size_t slot_size) {
+  DCHECK(slot_count > 0 && slot_size > 0);
+  std::unique_ptr<base::SharedMemory> memory(new base::SharedMemory);
+  if (!memory->CreateAndMapAnonymous(slot_size * slot_count)) {
+    LOG(ERROR) << __PRETTY_FUNCTION__ << " : failed to allocate " << slot_count << "x" << slot_size;
+    return nullptr;
+  }
+  auto& registry = g_frame_ring_registry.Get();
+  base::AutoLock locker(registry.lock);
+  unsigned int id = registry.next_id++;
+  if (registry.next_id == 0) {
+    // 0 is never a valid subscription id.
+    registry.next_id = 1;
+  }
+  scoped_refptr<FrameRingBuffer> ring(new FrameRingBuffer(id, slot_count, slot_size, std::move(memory)));
+  registry.rings[id] = ring;
+  return ring;
+}
+
+// static
+scoped_refptr<FrameRingBuffer> FrameRingBuffer::FromID(unsigned int id) {
+  auto& registry = g_frame_ring_registry.Get();
+  base::AutoLock locker(registry.lock);
+  auto fiter = registry.rings.find(id);
+  if (fiter == registry.rings.end()) {
+    return nullptr;
+  }
+  return (*fiter).second;
+}
+
+FrameRingBuffer::FrameRingBuffer(unsigned int id, int slot_count, size_t slot_size, std::unique_ptr<base::SharedMemory> memory)
+    : id_(id),
+      slot_size_(slot_size),
+      memory_(std::move(memory)),
+      slots_(slot_count),
+      next_sequence_(1),
+      written_(0),
+      dropped_(0),
+      skipped_(0) {
+  for (auto& slot : slots_) {
+    slot.state = SLOT_FREE;
+    memset(&slot.info, 0, sizeof(slot.info));
+  }
+}
+
+FrameRingBuffer::~FrameRingBuffer(void) {
+}
+
+void FrameRingBuffer::Close(void) {
+  auto& registry = g_frame_ring_registry.Get();
+  scoped_refptr<FrameRingBuffer> self;
+  {
+    base::AutoLock locker(registry.lock);
+    auto fiter = registry.rings.find(id_);
+    if (fiter == registry.rings.end()) {
+      return;
+    }
+    self = (*fiter).second;
+    registry.rings.erase(fiter);
+  }
+  // the last reference may be dropped here, outside of the lock.
+}
+
+int FrameRingBuffer::FindWritableSlot(void) {
+  lock_.AssertAcquired();
+  int oldest = -1;
+  for (size_t i = 0; i < slots_.size(); i++) {
+    if (slots_[i].state == SLOT_FREE) {
+      return static_cast<int>(i);
+    }
+    if (slots_[i].state == SLOT_READY &&
+        (oldest < 0 || slots_[i].info.sequence < slots_[oldest].info.sequence)) {
+      oldest = static_cast<int>(i);
+    }
+  }
+  if (oldest >= 0) {
+    // the host did not pick this frame up in time.
+    dropped_++;
+  }
+  return oldest;
+}
+
+bool FrameRingBuffer::Write(const SkBitmap& bitmap, const gfx::Rect& dirty_rect, unsigned int* sequence) {
+  if (bitmap.bytesPerPixel() != kBytesPerPixel) {
+    return false;
+  }
+  const size_t stride = static_cast<size_t>(bitmap.width()) * kBytesPerPixel;
+  if (stride * bitmap.height() > slot_size_) {
+    LOG(ERROR) << __PRETTY_FUNCTION__ << " : frame is larger than slot " << bitmap.width() << "x" << bitmap.height();
+    base::AutoLock locker(lock_);
+    dropped_++;
+    return false;
+  }
+
+  int index;
+  {
+    base::AutoLock locker(lock_);
+    index = FindWritableSlot();
+    if (index < 0) {
+      // every slot is locked by the host.
+      dropped_++;
+      return false;
+    }
+    slots_[index].state = SLOT_WRITING;
+  }
+
+  // copy outside of the lock, the host can't touch a writing slot.
+  base::TimeTicks start = base::TimeTicks::Now();
+  uint8_t* dst = static_cast<uint8_t*>(memory_->memory()) + slot_size_ * index;
+  {
+    SkAutoLockPixels pixels_lock(bitmap);
+    const uint8_t* src = static_cast<const uint8_t*>(bitmap.getPixels());
+    if (bitmap.rowBytes() == stride) {
+      memcpy(dst, src, stride * bitmap.height());
+    } else {
+      for (int y = 0; y < bitmap.height(); y++) {
+        memcpy(dst + stride * y, src + bitmap.rowBytes() * y, stride);
+      }
+    }
+  }
+  base::TimeTicks end = base::TimeTicks::Now();
+
+  base::AutoLock locker(lock_);
+  Slot& slot = slots_[index];
+  slot.info.sequence = next_sequence_++;
+  slot.info.width = bitmap.width();
+  slot.info.height = bitmap.height();
+  slot.info.stride = static_cast<int>(stride);
+  slot.info.dirtyX = dirty_rect.x();
+  slot.info.dirtyY = dirty_rect.y();
+  slot.info.dirtyWidth = dirty_rect.width();
+  slot.info.dirtyHeight = dirty_rect.height();
+  slot.state = SLOT_READY;
+
+  written_++;
+  total_copy_time_ += end - start;
+  if (first_frame_time_.is_null()) {
+    first_frame_time_ = end;
+  }
+  last_frame_time_ = end;
+  *sequence = slot.info.sequence;
+  return true;
+}
+
+void FrameRingBuffer::AddSkipped(void) {
+  base::AutoLock locker(lock_);
+  skipped_++;
+}
+
+bool FrameRingBuffer::Lock(unsigned int sequence, const void** data, MesonFrameInfo* info) {
+  base::AutoLock locker(lock_);
+  for (size_t i = 0; i < slots_.size(); i++) {
+    Slot& slot = slots_[i];
+    if (slot.state == SLOT_READY && slot.info.sequence == sequence) {
+      slot.state = SLOT_LOCKED;
+      *data = static_cast<const uint8_t*>(memory_->memory()) + slot_size_ * i;
+      *info = slot.info;
+      return true;
+    }
+  }
+  // already overwritten.
+  return false;
+}
+
+bool FrameRingBuffer::Unlock(unsigned int sequence) {
+  base::AutoLock locker(lock_);
+  for (auto& slot : slots_) {
+    if (slot.state == SLOT_LOCKED && slot.info.sequence == sequence) {
+      slot.state = SLOT_FREE;
+      return true;
+    }
+  }
+  return false;
+}
+
+void FrameRingBuffer::GetStatistics(MesonFrameStatistics* stats) const {
+  base::AutoLock locker(lock_);
+  stats->written = written_;
+  stats->dropped = dropped_;
+  stats->skipped = skipped_;
+  stats->fps = 0.0;
+  stats->averageCopyMicroseconds = 0.0;
+  if (written_ > 1) {
+    double seconds = (last_frame_time_ - first_frame_time_).InSecondsF();
+    if (seconds > 0.0) {
+      stats->fps = (written_ - 1) / seconds;
+    }
+  }
+  if (written_ > 0) {
+    stats->averageCopyMicroseconds = total_copy_time_.InMicrosecondsF() / written_;
+  }
+}
+}
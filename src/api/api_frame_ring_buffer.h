@@ -0,0 +1,73 @@
+//-*-c++-*-
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/shared_memory.h"
+#include "base/synchronization/lock.h"
+#include "base/time/time.h"
+#include "ui/gfx/geometry/rect.h"
+#include "api/meson.h"
+
+class SkBitmap;
+
+namespace meson {
+// Fixed-size slots of frames shared with the host.
+// The UI thread writes frames, the host locks/unlocks them via the C API.
+// Frames are never queued: an unread frame is overwritten by a newer one,
+// and a frame is dropped when every slot is locked by the host.
+class FrameRingBuffer : public base::RefCountedThreadSafe<FrameRingBuffer> {
+ public:
+  static scoped_refptr<FrameRingBuffer> Create(int slot_count, size_t slot_size);
+  static scoped_refptr<FrameRingBuffer> FromID(unsigned int id);
+
+ public:
+  unsigned int GetID(void) const { return id_; }
+  size_t GetSlotSize(void) const { return slot_size_; }
+  void Close(void);
+
+  // producer (UI thread)
+  bool Write(const SkBitmap& bitmap, const gfx::Rect& dirty_rect, unsigned int* sequence);
+  void AddSkipped(void);
+
+  // consumer (host)
+  bool Lock(unsigned int sequence, const void** data, MesonFrameInfo* info);
+  bool Unlock(unsigned int sequence);
+  void GetStatistics(MesonFrameStatistics* stats) const;
+
+ private:
+  friend class base::RefCountedThreadSafe<FrameRingBuffer>;
+  FrameRingBuffer(unsigned int id, int slot_count, size_t slot_size, std::unique_ptr<base::SharedMemory> memory);
+  ~FrameRingBuffer(void);
+
+  int FindWritableSlot(void);
+
+ private:
+  enum SlotState {
+    SLOT_FREE,
+    SLOT_WRITING,
+    SLOT_READY,
+    SLOT_LOCKED,
+  };
+  struct Slot {
+    SlotState state;
+    MesonFrameInfo info;
+  };
+  const unsigned int id_;
+  const size_t slot_size_;
+  std::unique_ptr<base::SharedMemory> memory_;
+
+  mutable base::Lock lock_;
+  std::vector<Slot> slots_;
+  unsigned int next_sequence_;
+  unsigned int written_;
+  unsigned int dropped_;
+  unsigned int skipped_;
+  base::TimeTicks first_frame_time_;
+  base::TimeTicks last_frame_time_;
+  base::TimeDelta total_copy_time_;
+  DISALLOW_COPY_AND_ASSIGN(FrameRingBuffer);
+};
+}
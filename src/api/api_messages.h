@@ -3,6 +3,7 @@
 // Multiply-included file, no traditional include guard.
 
 #include "common/draggable_region.h"
+#include "base/memory/shared_memory.h"
 #include "base/strings/string16.h"
 #include "base/values.h"
 #include "content/public/common/common_param_traits.h"
@@ -19,6 +20,11 @@ IPC_STRUCT_TRAITS_BEGIN(meson::DraggableRegion)
   IPC_STRUCT_TRAITS_MEMBER(bounds)
 IPC_STRUCT_TRAITS_END()
 
+IPC_STRUCT_TRAITS_BEGIN(meson::DraggableRegionChange)
+  IPC_STRUCT_TRAITS_MEMBER(index)
+  IPC_STRUCT_TRAITS_MEMBER(region)
+IPC_STRUCT_TRAITS_END()
+
 IPC_MESSAGE_ROUTED2(MesonViewHostMsg_Message,
                     base::string16 /* channel */,
                     base::ListValue /* arguments */)
@@ -33,16 +39,62 @@ IPC_MESSAGE_ROUTED3(MesonViewMsg_Message,
                     base::string16 /* channel */,
                     base::ListValue /* arguments */)
 
+// Suspends (or resumes) the timers and loading of a hidden page.
+IPC_MESSAGE_ROUTED1(MesonViewMsg_SetFrozen,
+                    bool /* frozen */)
+
 // Sent by the renderer when the draggable regions are updated.
-IPC_MESSAGE_ROUTED1(MesonViewHostMsg_UpdateDraggableRegions,
+// |generation| is counted up on each update (whole list or changes).
+IPC_MESSAGE_ROUTED2(MesonViewHostMsg_UpdateDraggableRegions,
+                    uint32_t /* generation */,
                     std::vector<meson::DraggableRegion> /* regions */)
 
+// Sent by the renderer instead of the whole list, once the browser has one.
+// The list is cut (or extended) to |count| regions and |changes| applied.
+// Only applied on top of |generation| - 1, the whole list is asked for again
+// otherwise.
+IPC_MESSAGE_ROUTED3(MesonViewHostMsg_UpdateDraggableRegionChanges,
+                    uint32_t /* generation */,
+                    uint32_t /* count */,
+                    std::vector<meson::DraggableRegionChange> /* changes */)
+
+// Asks the renderer to send the whole list of draggable regions again.
+IPC_MESSAGE_ROUTED0(MesonViewMsg_ResendDraggableRegions)
+
+// Answered on the main thread of the renderer, see UnresponsiveWatchdog.
+IPC_MESSAGE_ROUTED1(MesonViewMsg_Ping,
+                    int /* seq */)
+
+IPC_MESSAGE_ROUTED1(MesonViewHostMsg_Pong,
+                    int /* seq */)
+
+// Handled on the IO thread of the renderer, the stack is taken when the JS
+// running on the main thread is interrupted. Nothing is sent if no JS runs
+// within |timeout| (milliseconds), a later stack is not the one of the hang.
+IPC_MESSAGE_ROUTED2(MesonViewMsg_CaptureHangStack,
+                    int /* request_id */,
+                    int /* timeout */)
+
+IPC_MESSAGE_ROUTED2(MesonViewHostMsg_HangStack,
+                    int /* request_id */,
+                    std::string /* stack */)
+
 ///
 // CreateWebViewGuest
 IPC_SYNC_MESSAGE_ROUTED1_1(MesonFrameHostMsg_CreateWebViewGuest,
                            base::DictionaryValue, /* params */
                            int /* guest_instance_id */)
 
+// CreateWebViewGuestAsync
+IPC_MESSAGE_ROUTED2(MesonFrameHostMsg_CreateWebViewGuestAsync,
+                    int, /* request_id */
+                    base::DictionaryValue /* params */)
+
+// WebViewGuestCreated
+IPC_MESSAGE_ROUTED2(MesonFrameMsg_WebViewGuestCreated,
+                    int, /* request_id */
+                    int /* guest_instance_id */)
+
 // AttachWindowGuest
 IPC_MESSAGE_ROUTED3(MesonFrameHostMsg_AttachWindowGuest,
                     int, /*internal_instance_id*/
@@ -117,6 +169,10 @@ IPC_MESSAGE_ROUTED3(MesonFrameHostMsg_WebViewGuestJavaScriptDialogClosed,
                     bool, /* succces */
                     std::string /* response */)
 
+// WebViewGuestBatch
+IPC_MESSAGE_ROUTED1(MesonFrameHostMsg_WebViewGuestBatch,
+                    base::ListValue /* commands */)
+
 // WebViewEmit
 IPC_MESSAGE_ROUTED3(MesonFrameMsg_WebViewEmit,
                     int,         /* guest_instance_id */
@@ -126,6 +182,11 @@ IPC_MESSAGE_ROUTED3(MesonFrameMsg_WebViewEmit,
 // RemoteSendMessage
 IPC_MESSAGE_ROUTED1(MesonFrameHostMsg_RemoteSend,
                     base::DictionaryValue /* message */)
+// RemoteSendBuffer
+IPC_MESSAGE_ROUTED3(MesonFrameHostMsg_RemoteSendBuffer,
+                    base::SharedMemoryHandle, /* buffer */
+                    uint32_t,                 /* size */
+                    base::DictionaryValue /* message */)
 // RemoteDispatchMessage
 IPC_MESSAGE_ROUTED1(MesonFrameMsg_RemoteDispatch,
                     base::DictionaryValue /* message */)
@@ -0,0 +1,82 @@
+#include "api/api_shared_buffer.h"
+
+#include <vector>
+#include "base/logging.h"
+
+namespace meson {
+namespace {
+base::LazyInstance<SharedBufferRegistry>::Leaky g_shared_buffer_registry = LAZY_INSTANCE_INITIALIZER;
+}
+
+SharedBufferRegistry* SharedBufferRegistry::Get(void) {
+  return g_shared_buffer_registry.Pointer();
+}
+
+SharedBufferRegistry::SharedBufferRegistry(void)
+    : next_id_(1) {
+}
+
+SharedBufferRegistry::~SharedBufferRegistry(void) {
+}
+
+unsigned int SharedBufferRegistry::Add(std::unique_ptr<base::SharedMemory> memory, size_t size, int owner) {
+  DCHECK(memory && memory->memory());
+  base::AutoLock locker(lock_);
+  unsigned int id = next_id_++;
+  if (next_id_ == 0) {
+    // 0 is never a valid buffer id.
+    next_id_ = 1;
+  }
+  Entry& entry = buffers_[id];
+  entry.memory = std::move(memory);
+  entry.size = size;
+  entry.owner = owner;
+  return id;
+}
+
+bool SharedBufferRegistry::Lookup(unsigned int id, const void** data, size_t* size) const {
+  base::AutoLock locker(lock_);
+  auto fiter = buffers_.find(id);
+  if (fiter == buffers_.end()) {
+    return false;
+  }
+  *data = (*fiter).second.memory->memory();
+  *size = (*fiter).second.size;
+  return true;
+}
+
+bool SharedBufferRegistry::Release(unsigned int id) {
+  std::unique_ptr<base::SharedMemory> memory;
+  {
+    base::AutoLock locker(lock_);
+    auto fiter = buffers_.find(id);
+    if (fiter == buffers_.end()) {
+      return false;
+    }
+    memory = std::move((*fiter).second.memory);
+    buffers_.erase(fiter);
+  }
+  // unmap outside of the lock.
+  memory.reset();
+  return true;
+}
+
+void SharedBufferRegistry::ReleaseOwner(int owner) {
+  std::vector<std::unique_ptr<base::SharedMemory>> memories;
+  {
+    base::AutoLock locker(lock_);
+    for (auto iter = buffers_.begin(); iter != buffers_.end();) {
+      if ((*iter).second.owner == owner) {
+        memories.push_back(std::move((*iter).second.memory));
+        iter = buffers_.erase(iter);
+      } else {
+        ++iter;
+      }
+    }
+  }
+  if (!memories.empty()) {
+    LOG(INFO) << __PRETTY_FUNCTION__ << " : " << owner << " " << memories.size() << " buffers";
+  }
+  // unmapped outside of the lock.
+}
+}
@@ -0,0 +1,42 @@
+//-*-c++-*-
+#pragma once
+
+#include <map>
+#include <memory>
+#include "base/lazy_instance.h"
+#include "base/macros.h"
+#include "base/memory/shared_memory.h"
+#include "base/synchronization/lock.h"
+
+namespace meson {
+// Keeps the shared memory regions received from renderers mapped until the
+// host releases them through MesonApiReleaseSharedBuffer(), or until their
+// owner (a web contents binding id) goes away.
+class SharedBufferRegistry {
+ public:
+  static SharedBufferRegistry* Get(void);
+
+ public:
+  unsigned int Add(std::unique_ptr<base::SharedMemory> memory, size_t size, int owner);
+  bool Lookup(unsigned int id, const void** data, size_t* size) const;
+  bool Release(unsigned int id);
+  // releases the buffers the host has not released yet.
+  void ReleaseOwner(int owner);
+
+ private:
+  friend struct base::DefaultLazyInstanceTraits<SharedBufferRegistry>;
+  SharedBufferRegistry(void);
+  ~SharedBufferRegistry(void);
+
+ private:
+  struct Entry {
+    std::unique_ptr<base::SharedMemory> memory;
+    size_t size;
+    int owner;
+  };
+  mutable base::Lock lock_;
+  unsigned int next_id_;
+  std::map<unsigned int, Entry> buffers_;
+  DISALLOW_COPY_AND_ASSIGN(SharedBufferRegistry);
+};
+}
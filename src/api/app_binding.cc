@@ -1,6 +1,7 @@
 #include "api/app_binding.h"
 #include "browser/browser_main_parts.h"
 #include "browser/browser_client.h"
+#include "browser/window_list.h"
 #include "api/web_contents_binding.h"
 #include "api/api.h"
 #include "content/public/browser/browser_accessibility_state.h"
@@ -12,6 +13,8 @@ const APIBindingT<AppClassBinding, AppClassBinding>::MethodTable APIBindingT<App
 template <>
 const APIClassBindingT<AppClassBinding, AppClassBinding>::MethodTable APIClassBindingT<AppClassBinding, AppClassBinding>::staticMethodTable = {
     {"exit", std::mem_fn(&AppClassBinding::Exit)},
+    {"quit", std::mem_fn(&AppClassBinding::Quit)},
+    {"getWindowCloseStatistics", std::mem_fn(&AppClassBinding::GetWindowCloseStatistics)},
 };
 
 MESON_IMPLEMENT_API_CLASS(AppClassBinding, AppClassBinding);
@@ -37,6 +40,30 @@ api::MethodResult AppClassBinding::Exit(const api::APIArgs& args) {
   return api::MethodResult();
 }
 
+// args: ({timeout, force})
+// timeout in milliseconds for all the windows, force destroys the windows
+// which cancel the close or are still open at the timeout.
+api::MethodResult AppClassBinding::Quit(const api::APIArgs& args) {
+  WindowList::CloseOptions options;
+  const base::DictionaryValue* opt = nullptr;
+  if (args.GetDictionary(0, &opt)) {
+    int timeout = 0;
+    opt->GetInteger("timeout", &timeout);
+    opt->GetBoolean("force", &options.force);
+    if (timeout < 0) {
+      return api::MethodResult("invalid argument");
+    }
+    options.timeout = base::TimeDelta::FromMilliseconds(timeout);
+  }
+  Browser::Get()->Quit(options);
+  return api::MethodResult();
+}
+
+// of the last quit(), see WindowList::GetCloseStatistics().
+api::MethodResult AppClassBinding::GetWindowCloseStatistics(const api::APIArgs& args) {
+  return api::MethodResult(WindowList::GetCloseStatistics());
+}
+
 
 void AppClassBinding::OnBeforeQuit(bool* prevent_default) {
   bool prevent = EmitPreventEvent("before-quit");
@@ -14,6 +14,8 @@ class AppClassBinding : public APIClassBindingT<AppClassBinding, AppClassBinding
 
  public:  // Local Methods
   api::MethodResult Exit(const api::APIArgs& args);
+  api::MethodResult Quit(const api::APIArgs& args);
+  api::MethodResult GetWindowCloseStatistics(const api::APIArgs& args);
 
  public:  // BrowserObserver
   void OnBeforeQuit(bool* prevent_default) override;
@@ -1,5 +1,7 @@
 #include "meson.h"
 #include "app/library_main.h"
+#include "api/api_frame_ring_buffer.h"
+#include "api/api_shared_buffer.h"
 #include <string>
 #include <vector>
 
@@ -27,6 +29,39 @@ void MesonApiSetHandler(MesonInitHandler pfnInitHandler,
   s_pfnPostServerResponseHandler = pfnPostHandler;
 }
 
+int MesonApiGetSharedBuffer(unsigned int bufferId, const void** ppData, size_t* pLength) {
+  if (!ppData || !pLength) {
+    return 0;
+  }
+  return meson::SharedBufferRegistry::Get()->Lookup(bufferId, ppData, pLength) ? 1 : 0;
+}
+int MesonApiReleaseSharedBuffer(unsigned int bufferId) {
+  return meson::SharedBufferRegistry::Get()->Release(bufferId) ? 1 : 0;
+}
+
+int MesonApiLockFrame(unsigned int subscriptionId, unsigned int sequence, const void** ppData, MesonFrameInfo* pInfo) {
+  if (!ppData || !pInfo) {
+    return 0;
+  }
+  auto ring = meson::FrameRingBuffer::FromID(subscriptionId);
+  return (ring && ring->Lock(sequence, ppData, pInfo)) ? 1 : 0;
+}
+int MesonApiUnlockFrame(unsigned int subscriptionId, unsigned int sequence) {
+  auto ring = meson::FrameRingBuffer::FromID(subscriptionId);
+  return (ring && ring->Unlock(sequence)) ? 1 : 0;
+}
+int MesonApiGetFrameStatistics(unsigned int subscriptionId, MesonFrameStatistics* pStatistics) {
+  if (!pStatistics) {
+    return 0;
+  }
+  auto ring = meson::FrameRingBuffer::FromID(subscriptionId);
+  if (!ring) {
+    return 0;
+  }
+  ring->GetStatistics(pStatistics);
+  return 1;
+}
+
 bool mesonApiCheckInitHandler(void) {
   return s_pfnInitHandler != nullptr;
 }
@@ -2,6 +2,8 @@
 #ifndef __INC_MESON_API__
 #define __INC_MESON_API__
 
+#include <stddef.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -77,6 +79,50 @@ MESON_EXPORT void MesonApiSetHandler(MesonInitHandler pfnInitHandler,
                                      MesonWaitServerRequestHandler pfnWaitHandler,
                                      MesonPostServerResponseHandler pfnPostHandler);
 
+/*------------------------------------------------------------------------
+ * shared buffer functions
+ *  buffers sent by `THRUST.remote.sendBuffer()` are notified with the
+ *  "remote-buffer" event, and images of `webContents.capturePage()` with
+ *  the "capture-page" event. the mapping stays valid until released, or
+ *  until the webContents which produced it is destroyed.
+ */
+MESON_EXPORT int MesonApiGetSharedBuffer(unsigned int bufferId, const void** ppData, size_t* pLength);
+MESON_EXPORT int MesonApiReleaseSharedBuffer(unsigned int bufferId);
+
+/*------------------------------------------------------------------------
+ * frame subscription functions
+ *  `webContents.beginFrameSubscription()` writes BGRA frames into a ring of
+ *  fixed-size slots, and notifies each of them with the "frame" event.
+ *  a frame must be locked before it is read, and unlocked after that.
+ *  frames which are not locked in time are overwritten (dropped).
+ *  locked data is invalid after `webContents.endFrameSubscription()`.
+ */
+typedef struct MesonFrameInfo {
+  unsigned int sequence;
+  int width;
+  int height;
+  int stride;
+  // damaged region in view coordinates.
+  int dirtyX;
+  int dirtyY;
+  int dirtyWidth;
+  int dirtyHeight;
+} MesonFrameInfo;
+
+typedef struct MesonFrameStatistics {
+  unsigned int written;
+  // overwritten before locked, or no unlocked slot.
+  unsigned int dropped;
+  // not captured because the previous readback was still in flight.
+  unsigned int skipped;
+  double fps;
+  double averageCopyMicroseconds;
+} MesonFrameStatistics;
+
+MESON_EXPORT int MesonApiLockFrame(unsigned int subscriptionId, unsigned int sequence, const void** ppData, MesonFrameInfo* pInfo);
+MESON_EXPORT int MesonApiUnlockFrame(unsigned int subscriptionId, unsigned int sequence);
+MESON_EXPORT int MesonApiGetFrameStatistics(unsigned int subscriptionId, MesonFrameStatistics* pStatistics);
+
 /*------------------------------------------------------------------------
  * internal functions
  */
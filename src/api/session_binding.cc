@@ -1,7 +1,16 @@
 #include "api/session_binding.h"
 
+#include "base/command_line.h"
+#include "base/memory/memory_pressure_listener.h"
 #include "base/strings/string_util.h"
 #include "api/api.h"
+#include "browser/background_throttling_policy.h"
+#include "browser/browser.h"
+#include "browser/contents_discarder.h"
+#include "browser/guest_process_policy.h"
+#include "browser/web_view_guest_index.h"
+#include "browser/web_view_manager.h"
+#include "common/options_switches.h"
 
 namespace {
 const char kPersistPrefix[] = "persist:";
@@ -9,7 +18,22 @@ const char kPersistPrefix[] = "persist:";
 
 namespace meson {
 template <>
-const APIBindingT<SessionBinding, SessionClassBinding>::MethodTable APIBindingT<SessionBinding, SessionClassBinding>::methodTable = {};
+const APIBindingT<SessionBinding, SessionClassBinding>::MethodTable APIBindingT<SessionBinding, SessionClassBinding>::methodTable = {
+    {"setWebViewPoolSize", std::mem_fn(&SessionBinding::SetWebViewPoolSize)},
+    {"getWebViewPoolStatistics", std::mem_fn(&SessionBinding::GetWebViewPoolStatistics)},
+    {"setWebViewEventFiltering", std::mem_fn(&SessionBinding::SetWebViewEventFiltering)},
+    {"getWebViewEventStatistics", std::mem_fn(&SessionBinding::GetWebViewEventStatistics)},
+    {"getWebViewCreationStatistics", std::mem_fn(&SessionBinding::GetWebViewCreationStatistics)},
+    {"getWebViewIndexStatistics", std::mem_fn(&SessionBinding::GetWebViewIndexStatistics)},
+    {"runWebViewIndexBenchmark", std::mem_fn(&SessionBinding::RunWebViewIndexBenchmark)},
+    {"setWebViewProcessPolicy", std::mem_fn(&SessionBinding::SetWebViewProcessPolicy)},
+    {"getWebViewProcessStatistics", std::mem_fn(&SessionBinding::GetWebViewProcessStatistics)},
+    {"setBackgroundThrottlingPolicy", std::mem_fn(&SessionBinding::SetBackgroundThrottlingPolicy)},
+    {"getBackgroundThrottlingStatistics", std::mem_fn(&SessionBinding::GetBackgroundThrottlingStatistics)},
+    {"setDiscardPolicy", std::mem_fn(&SessionBinding::SetDiscardPolicy)},
+    {"getDiscardStatistics", std::mem_fn(&SessionBinding::GetDiscardStatistics)},
+    {"simulateMemoryPressure", std::mem_fn(&SessionBinding::SimulateMemoryPressure)},
+};
 
 template <>
 const APIClassBindingT<SessionBinding, SessionClassBinding>::MethodTable APIClassBindingT<SessionBinding, SessionClassBinding>::staticMethodTable = {
@@ -48,9 +72,139 @@ scoped_refptr<MesonBrowserContext> SessionBinding::GetSession() const {
   return browser_context_;
 }
 
+// args: (partition, size)
+// guests created by <webview> in this session's windows are taken from the pool.
+api::MethodResult SessionBinding::SetWebViewPoolSize(const api::APIArgs& args) {
+  std::string partition;
+  int size = 0;
+  if (!args.GetString(0, &partition) || !args.GetInteger(1, &size)) {
+    return api::MethodResult("invalid argument");
+  }
+  auto manager = static_cast<WebViewManager*>(browser_context_->GetGuestManager());
+  manager->SetGuestPoolSize(partition, size);
+  return api::MethodResult();
+}
+
+api::MethodResult SessionBinding::GetWebViewPoolStatistics(const api::APIArgs& args) {
+  auto manager = static_cast<WebViewManager*>(browser_context_->GetGuestManager());
+  return api::MethodResult(manager->GetGuestPoolStatistics());
+}
+
+// args: (enabled)
+// guest events without a listener in the embedder are not sent to it (default).
+api::MethodResult SessionBinding::SetWebViewEventFiltering(const api::APIArgs& args) {
+  bool enabled = true;
+  if (!args.GetBoolean(0, &enabled)) {
+    return api::MethodResult("invalid argument");
+  }
+  auto manager = static_cast<WebViewManager*>(browser_context_->GetGuestManager());
+  manager->SetGuestEventFiltering(enabled);
+  return api::MethodResult();
+}
+
+api::MethodResult SessionBinding::GetWebViewEventStatistics(const api::APIArgs& args) {
+  auto manager = static_cast<WebViewManager*>(browser_context_->GetGuestManager());
+  return api::MethodResult(manager->GetGuestEventStatistics());
+}
+
+api::MethodResult SessionBinding::GetWebViewCreationStatistics(const api::APIArgs& args) {
+  auto manager = static_cast<WebViewManager*>(browser_context_->GetGuestManager());
+  return api::MethodResult(manager->GetGuestCreationStatistics());
+}
+
+api::MethodResult SessionBinding::GetWebViewIndexStatistics(const api::APIArgs& args) {
+  auto manager = static_cast<WebViewManager*>(browser_context_->GetGuestManager());
+  return api::MethodResult(manager->GetGuestIndexStatistics());
+}
+
+// args: ({guests, embedders})
+// stress test of the guest lookups with synthetic guests, no web contents is created.
+api::MethodResult SessionBinding::RunWebViewIndexBenchmark(const api::APIArgs& args) {
+  int guests = 5000;
+  int embedders = 50;
+  const base::DictionaryValue* opt = nullptr;
+  if (args.GetDictionary(0, &opt)) {
+    opt->GetInteger("guests", &guests);
+    opt->GetInteger("embedders", &embedders);
+  }
+  if (guests < 0 || embedders <= 0) {
+    return api::MethodResult("invalid argument");
+  }
+  return api::MethodResult(WebViewGuestIndex::RunBenchmark(guests, embedders));
+}
+
+// args: ({mode: "per-guest" | "per-origin" | "capped", maxProcesses})
+// decides the renderer process of the <webview> guests created afterwards in
+// this session. pooled guests keep their own process.
+api::MethodResult SessionBinding::SetWebViewProcessPolicy(const api::APIArgs& args) {
+  const base::DictionaryValue* opt = nullptr;
+  if (!args.GetDictionary(0, &opt) || !browser_context_->GetGuestProcessPolicy()->Configure(*opt)) {
+    return api::MethodResult("invalid argument");
+  }
+  return api::MethodResult();
+}
+
+api::MethodResult SessionBinding::GetWebViewProcessStatistics(const api::APIArgs& args) {
+  return api::MethodResult(browser_context_->GetGuestProcessPolicy()->GetStatistics());
+}
+
+// args: ({enabled, timerTier: "none" | "standard", frameRateCap, freezeAfter, thawOnActivate})
+// applies to all the web contents of this session, see "throttling-state-changed".
+api::MethodResult SessionBinding::SetBackgroundThrottlingPolicy(const api::APIArgs& args) {
+  const base::DictionaryValue* opt = nullptr;
+  if (!args.GetDictionary(0, &opt) || !browser_context_->GetBackgroundThrottlingPolicy()->Configure(*opt)) {
+    return api::MethodResult("invalid argument");
+  }
+  return api::MethodResult();
+}
+
+api::MethodResult SessionBinding::GetBackgroundThrottlingStatistics(const api::APIArgs& args) {
+  return api::MethodResult(browser_context_->GetBackgroundThrottlingPolicy()->GetStatistics());
+}
+
+// args: ({enabled, maxLiveContents, minHiddenTime})
+// hidden web contents of this session are discarded under memory pressure, or
+// when more than maxLiveContents are alive. see "discarded" and "undiscarded".
+api::MethodResult SessionBinding::SetDiscardPolicy(const api::APIArgs& args) {
+  const base::DictionaryValue* opt = nullptr;
+  if (!args.GetDictionary(0, &opt) || !browser_context_->GetContentsDiscarder()->Configure(*opt)) {
+    return api::MethodResult("invalid argument");
+  }
+  return api::MethodResult();
+}
+
+api::MethodResult SessionBinding::GetDiscardStatistics(const api::APIArgs& args) {
+  return api::MethodResult(browser_context_->GetContentsDiscarder()->GetStatistics());
+}
+
+// args: ("moderate" | "critical")
+// the notification reaches every session, as a real one would.
+// only for tests, it needs --enable-test-hooks.
+api::MethodResult SessionBinding::SimulateMemoryPressure(const api::APIArgs& args) {
+  if (!base::CommandLine::ForCurrentProcess()->HasSwitch(switches::kEnableTestHooks)) {
+    return api::MethodResult("not enabled");
+  }
+  std::string level;
+  if (!args.GetString(0, &level)) {
+    return api::MethodResult("invalid argument");
+  }
+  if (level == "moderate") {
+    base::MemoryPressureListener::SimulatePressureNotification(base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_MODERATE);
+  } else if (level == "critical") {
+    base::MemoryPressureListener::SimulatePressureNotification(base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_CRITICAL);
+  } else {
+    return api::MethodResult("invalid argument");
+  }
+  return api::MethodResult();
+}
+
 SessionClassBinding::SessionClassBinding(void)
-    : APIClassBindingT(MESON_OBJECT_TYPE_SESSION) {}
-SessionClassBinding::~SessionClassBinding(void) {}
+    : APIClassBindingT(MESON_OBJECT_TYPE_SESSION) {
+  Browser::Get()->AddObserver(this);
+}
+SessionClassBinding::~SessionClassBinding(void) {
+  Browser::Get()->RemoveObserver(this);
+}
 
 scoped_refptr<SessionBinding> SessionClassBinding::NewInstance(const base::DictionaryValue& opt) {
   auto id = GetNextBindingID();
@@ -64,4 +218,14 @@ api::MethodResult SessionClassBinding::CreateInstance(const api::APIArgs& args)
   args.GetDictionary(0, &opt);
   return api::MethodResult(NewInstance(*opt));
 }
+
+void SessionClassBinding::OnQuit() {
+  LOG(INFO) << __PRETTY_FUNCTION__;
+  EnumBinding([](SessionBinding* binding) {
+    // the last pooled guest may be the last holder of the session.
+    scoped_refptr<MesonBrowserContext> browser_context = binding->GetSession();
+    static_cast<WebViewManager*>(browser_context->GetGuestManager())->CloseGuestPools();
+    return true;
+  });
+}
 }
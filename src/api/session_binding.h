@@ -3,6 +3,7 @@
 #include "base/memory/ref_counted.h"
 #include "base/memory/weak_ptr.h"
 #include "api/api_binding.h"
+#include "browser/browser_observer.h"
 #include "browser/session/meson_browser_context.h"
 
 namespace meson {
@@ -16,12 +17,29 @@ class SessionBinding : public APIBindingT<SessionBinding, SessionClassBinding> {
  public:
   scoped_refptr<MesonBrowserContext> GetSession() const;
 
+ public:  // methods
+  api::MethodResult SetWebViewPoolSize(const api::APIArgs& args);
+  api::MethodResult GetWebViewPoolStatistics(const api::APIArgs& args);
+  api::MethodResult SetWebViewEventFiltering(const api::APIArgs& args);
+  api::MethodResult GetWebViewEventStatistics(const api::APIArgs& args);
+  api::MethodResult GetWebViewCreationStatistics(const api::APIArgs& args);
+  api::MethodResult GetWebViewIndexStatistics(const api::APIArgs& args);
+  api::MethodResult RunWebViewIndexBenchmark(const api::APIArgs& args);
+  api::MethodResult SetWebViewProcessPolicy(const api::APIArgs& args);
+  api::MethodResult GetWebViewProcessStatistics(const api::APIArgs& args);
+  api::MethodResult SetBackgroundThrottlingPolicy(const api::APIArgs& args);
+  api::MethodResult GetBackgroundThrottlingStatistics(const api::APIArgs& args);
+  api::MethodResult SetDiscardPolicy(const api::APIArgs& args);
+  api::MethodResult GetDiscardStatistics(const api::APIArgs& args);
+  api::MethodResult SimulateMemoryPressure(const api::APIArgs& args);
+
  private:
   scoped_refptr<MesonBrowserContext> browser_context_;
   DISALLOW_COPY_AND_ASSIGN(SessionBinding);
 };
 
-class SessionClassBinding : public APIClassBindingT<SessionBinding, SessionClassBinding> {
+class SessionClassBinding : public APIClassBindingT<SessionBinding, SessionClassBinding>,
+                            public BrowserObserver {
  public:
   SessionClassBinding(void);
   ~SessionClassBinding(void) override;
@@ -32,6 +50,11 @@ class SessionClassBinding : public APIClassBindingT<SessionBinding, SessionClass
  public:  // static methods
   api::MethodResult CreateInstance(const api::APIArgs& args);
 
+ public:  // BrowserObserver
+  // the pooled guests of every session are released before the browser
+  // contexts are torn down.
+  void OnQuit() override;
+
  private:
   DISALLOW_COPY_AND_ASSIGN(SessionClassBinding);
 };
@@ -1,10 +1,14 @@
 #include "api/web_contents_binding.h"
 
+#include <limits>
+
 #include "brightray/browser/inspectable_web_contents_view.h"
 
 #include "api/session_binding.h"
 #include "api/api.h"
 #include "api/api_messages.h"
+#include "api/api_frame_ring_buffer.h"
+#include "api/api_shared_buffer.h"
 #include "browser/web_contents_permission_helper.h"
 #include "browser/web_contents_preferences.h"
 #include "browser/native_window.h"
@@ -25,18 +29,36 @@
 #include "content/public/browser/navigation_entry.h"
 #include "content/public/browser/navigation_handle.h"
 #include "content/public/browser/favicon_status.h"
+#include "content/public/browser/browser_thread.h"
 #include "content/public/browser/web_contents.h"
 #include "content/public/browser/download_manager.h"
 #include "content/common/view_messages.h"
 #include "base/strings/utf_string_conversions.h"
+#include "base/task_runner_util.h"
 #include "base/threading/thread_task_runner_handle.h"
 #include "chrome/browser/ssl/security_state_tab_helper.h"
 #include "third_party/WebKit/public/web/WebFindOptions.h"
-
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "ui/display/screen.h"
+#include "ui/gfx/geometry/size_conversions.h"
+
+#include "browser/capture_encoder.h"
+#include "browser/console_message_buffer.h"
+#include "browser/find_result_stream.h"
+#include "browser/frame_subscriber.h"
+#include "browser/guest_process_policy.h"
+#include "browser/navigation_predictor.h"
+#include "browser/network_activity_stream.h"
 #include "browser/web_view_manager.h"
 #include "browser/web_view_guest_delegate.h"
 
 namespace {
+const int kDefaultOffscreenWidth = 800;
+const int kDefaultOffscreenHeight = 600;
+const int kDefaultOffscreenFrameRate = 60;
+const int kDefaultFindBatchInterval = 50;
+const int kDefaultPreconnectSockets = 1;
+
 std::string WindowOpenDispositionToString(WindowOpenDisposition disposition) {
   std::string str_disposition = "other";
   switch (disposition) {
@@ -64,10 +86,36 @@ std::string WindowOpenDispositionToString(WindowOpenDisposition disposition) {
 }
 namespace meson {
 template <>
-const APIBindingT<WebContentsBinding, WebContentsClassBinding>::MethodTable APIBindingT<WebContentsBinding, WebContentsClassBinding>::methodTable = {};
+const APIBindingT<WebContentsBinding, WebContentsClassBinding>::MethodTable APIBindingT<WebContentsBinding, WebContentsClassBinding>::methodTable = {
+    {"beginFrameSubscription", std::mem_fn(&WebContentsBinding::BeginFrameSubscription)},
+    {"endFrameSubscription", std::mem_fn(&WebContentsBinding::EndFrameSubscription)},
+    {"startPainting", std::mem_fn(&WebContentsBinding::StartPainting)},
+    {"stopPainting", std::mem_fn(&WebContentsBinding::StopPainting)},
+    {"isPainting", std::mem_fn(&WebContentsBinding::IsPainting)},
+    {"setFrameRate", std::mem_fn(&WebContentsBinding::SetFrameRate)},
+    {"getFrameRate", std::mem_fn(&WebContentsBinding::GetFrameRate)},
+    {"invalidate", std::mem_fn(&WebContentsBinding::Invalidate)},
+    {"capturePage", std::mem_fn(&WebContentsBinding::CapturePage)},
+    {"setNetworkActivityOptions", std::mem_fn(&WebContentsBinding::SetNetworkActivityOptions)},
+    {"getNetworkActivityStatistics", std::mem_fn(&WebContentsBinding::GetNetworkActivityStatistics)},
+    {"getConsoleMessages", std::mem_fn(&WebContentsBinding::GetConsoleMessages)},
+    {"setConsoleCaptureOptions", std::mem_fn(&WebContentsBinding::SetConsoleCaptureOptions)},
+    {"getState", std::mem_fn(&WebContentsBinding::GetState)},
+    {"discard", std::mem_fn(&WebContentsBinding::Discard)},
+    {"undiscard", std::mem_fn(&WebContentsBinding::Undiscard)},
+    {"findInPage", std::mem_fn(&WebContentsBinding::FindInPage)},
+    {"stopFindInPage", std::mem_fn(&WebContentsBinding::StopFinding)},
+    {"getFindStatistics", std::mem_fn(&WebContentsBinding::GetFindStatistics)},
+    {"prefetch", std::mem_fn(&WebContentsBinding::Prefetch)},
+    {"preconnect", std::mem_fn(&WebContentsBinding::Preconnect)},
+    {"prerender", std::mem_fn(&WebContentsBinding::Prerender)},
+    {"cancelPrerender", std::mem_fn(&WebContentsBinding::CancelPrerender)},
+    {"getNavigationPredictorStatistics", std::mem_fn(&WebContentsBinding::GetNavigationPredictorStatistics)},
+};
 template <>
 const APIClassBindingT<WebContentsBinding, WebContentsClassBinding>::MethodTable APIClassBindingT<WebContentsBinding, WebContentsClassBinding>::staticMethodTable = {
     {"_create", std::mem_fn(&WebContentsClassBinding::CreateInstance)},
+    {"getStates", std::mem_fn(&WebContentsClassBinding::GetStates)},
 };
 
 MESON_IMPLEMENT_API_CLASS(WebContentsBinding, WebContentsClassBinding);
@@ -78,7 +126,19 @@ WebContentsBinding::WebContentsBinding(api::ObjID id, const base::DictionaryValu
       type_(BROWSER_WINDOW),
       /*request_id_(0),*/ background_throttling_(true),
       enable_devtools_(true),
-      guest_instance_id_(-1) {
+      guest_instance_id_(-1),
+      frame_only_dirty_(false),
+      state_change_scheduled_(false),
+      find_request_id_(0),
+      load_finished_(false),
+      swapped_in_(false),
+      prefetched_navigation_(false),
+      preconnected_navigation_(false),
+      painting_(false),
+      frame_rate_(0),
+      throttling_frozen_(false),
+      discarded_(false),
+      pooled_(false) {
   if (id == MESON_OBJID_STATIC) {
     return;
   }
@@ -89,10 +149,17 @@ WebContentsBinding::WebContentsBinding(api::ObjID id, const base::DictionaryValu
     type_ = WEB_VIEW;
   } else if (args.GetBoolean("isBackgroundPage", &b) && b) {
     type_ = BACKGROUND_PAGE;
-  } else if (args.GetBoolean("option", &b) && b) {
+  } else if ((args.GetBoolean("offscreen", &b) && b) ||
+             // the key used before, still accepted.
+             (args.GetBoolean("option", &b) && b)) {
     type_ = OFF_SCREEN;
   }
   args.GetBoolean("devTools", &enable_devtools_);
+  args.GetBoolean("_pooled_", &pooled_);
+
+  console_messages_.reset(new ConsoleMessageBuffer);
+  // guests have always pushed their console messages.
+  console_messages_->set_push(!(type_ == BROWSER_WINDOW || type_ == OFF_SCREEN));
 
   int session_id;
   if (args.GetInteger("_session_id_", &session_id)) {
@@ -108,25 +175,21 @@ WebContentsBinding::WebContentsBinding(api::ObjID id, const base::DictionaryValu
   content::WebContents* web_contents;
   if (IsGuest()) {
     auto ctx = session_->GetSession();
-    auto site_instance = content::SiteInstance::CreateForURL(ctx.get(), GURL("chrome-guest::/fake-host"));
+    CHECK(args.GetInteger("guest_instance_id", &guest_instance_id_));
+    scoped_refptr<content::SiteInstance> site_instance;
+    int embedder_id = 0;
+    if (args.GetInteger("embedder", &embedder_id)) {
+      std::string src;
+      args.GetString("src", &src);
+      site_instance = ctx->GetGuestProcessPolicy()->AcquireSiteInstance(ctx.get(), guest_instance_id_, embedder_id, GURL(src));
+    } else {
+      // pooled guests have their own process.
+      site_instance = content::SiteInstance::CreateForURL(ctx.get(), GURL("chrome-guest::/fake-host"));
+    }
     content::WebContents::CreateParams params(ctx.get(), site_instance);
     guest_delegate_.reset(new WebViewGuestDelegate);
     params.guest_delegate = guest_delegate_.get();
     web_contents = content::WebContents::Create(params);
-    CHECK(args.GetInteger("guest_instance_id", &guest_instance_id_));
-#if 0
-  } else if (IsOffscreen()) {
-    bool transparent = false;
-    args->GetBoolean("transparent", &transparent);
-    content::WebContents::CreateParams params(session_->GetSession().get());
-    assert(false);
-    auto* view = new OffScreenWebContentsView(transparent, base::Bind(&WebContents::OnPaint, base::Unretained(this)));
-    params.view = view;
-    params.delegate_view = view;
-
-    web_contents = content::WebContents::Create(params);
-    view->SetWebContents(web_contents);
-#endif
   } else {
     content::WebContents::CreateParams params(session_->GetSession().get());
     web_contents = content::WebContents::Create(params);
@@ -151,26 +214,39 @@ WebContentsBinding::WebContentsBinding(api::ObjID id, const base::DictionaryValu
   if (IsGuest()) {
     guest_delegate_->Initialize(this);
 
-    NativeWindow* owner_window = nullptr;
     int embed_id;
     if (args.GetInteger("embedder", &embed_id) && (embed_id != 0)) {
       //TODO: do embedder_ to WeakPtr?
       auto e = WebContentsBinding::Class().GetBinding(embed_id);
-      embedder_ = base::AsWeakPtr(e.get());
-      CHECK(embedder_) << "Embedder not found";
-      // New WebContents's owner_window is the embedder's owner_window.
-      auto relay = NativeWindowRelay::FromWebContents(embedder_->web_contents());
-      if (relay)
-        owner_window = relay->window.get();
+      CHECK(e) << "Embedder not found";
+      AttachToEmbedder(e.get());
     }
-    if (owner_window)
-      SetOwnerWindow(owner_window);
+    // pooled guests are created without embedder, and attached later.
+  }
+  if (IsOffscreen()) {
+    int w = kDefaultOffscreenWidth;
+    int h = kDefaultOffscreenHeight;
+    args.GetInteger("width", &w);
+    args.GetInteger("height", &h);
+    offscreen_size_.SetSize(std::max(w, 1), std::max(h, 1));
+    frame_rate_ = kDefaultOffscreenFrameRate;
+    args.GetInteger("frameRate", &frame_rate_);
+    painting_ = true;
+    // there is no window which shows the contents.
+    web_contents->WasShown();
+  }
+  // a pooled contents is added when it is claimed, see Unpool().
+  if (!pooled_) {
+    GetBackgroundThrottlingPolicy()->AddClient(this);
+    GetContentsDiscarder()->AddClient(this);
   }
   //AttachAsUserData(web_contents);
 }
 
 WebContentsBinding::~WebContentsBinding(void) {
   LOG(INFO) << __PRETTY_FUNCTION__ << " : " << managed_web_contents();
+  if (frame_ring_)
+    frame_ring_->Close();
   if (managed_web_contents()) {
     if (type_ == WEB_VIEW)
       guest_delegate_->Destroy();
@@ -188,16 +264,41 @@ bool WebContentsBinding::DidAddMessageToConsole(content::WebContents* source,
                                                 const base::string16& message,
                                                 int32_t line_no,
                                                 const base::string16& source_id) {
-  if (type_ == BROWSER_WINDOW || type_ == OFF_SCREEN) {
-    return false;
-  } else {
+  bool push = false;
+  int suppressed = 0;
+  uint64_t seq = console_messages_->Add(level, message, line_no, source_id, &push, &suppressed);
+  if (push) {
     EmitEvent("console-message",
+              "seq", static_cast<double>(seq),
               "level", level,
               "message", message,
               "lineNO", line_no,
-              "sourceID", source_id);
-    return true;
+              "sourceID", source_id,
+              "suppressed", suppressed);
   }
+  // window contents also go to the default log.
+  return !(type_ == BROWSER_WINDOW || type_ == OFF_SCREEN);
+}
+
+// args: (sinceSeq, maxCount)
+api::MethodResult WebContentsBinding::GetConsoleMessages(const api::APIArgs& args) {
+  double since_seq = 0;
+  int max_count = 0;
+  args.GetDouble(0, &since_seq);
+  size_t count = std::numeric_limits<size_t>::max();
+  if (args.GetInteger(1, &max_count) && max_count > 0)
+    count = static_cast<size_t>(max_count);
+  if (since_seq < 0)
+    return api::MethodResult("invalid argument");
+  return api::MethodResult(console_messages_->Get(static_cast<uint64_t>(since_seq), count));
+}
+
+// args: ({capacity, level, push, maxPushPerSecond})
+api::MethodResult WebContentsBinding::SetConsoleCaptureOptions(const api::APIArgs& args) {
+  const base::DictionaryValue* opt = nullptr;
+  if (!args.GetDictionary(0, &opt) || !console_messages_->Configure(*opt))
+    return api::MethodResult("invalid argument");
+  return api::MethodResult();
 }
 
 void WebContentsBinding::OnCreateWindow(const GURL& target_url,
@@ -219,6 +320,11 @@ void WebContentsBinding::OnCreateWindow(const GURL& target_url,
               "features", features);
 }
 
+void WebContentsBinding::NavigationStateChanged(content::WebContents* source, content::InvalidateTypes changed_flags) {
+  // url, title, load state and audio are all reported here.
+  ScheduleStateChanged();
+}
+
 void WebContentsBinding::WebContentsCreated(content::WebContents* source_contents,
                                             int opener_render_process_id,
                                             int opener_render_frame_id,
@@ -313,6 +419,8 @@ void WebContentsBinding::CloseContents(content::WebContents* source) {
 
 void WebContentsBinding::ActivateContents(content::WebContents* source) {
   LOG(INFO) << __PRETTY_FUNCTION__;
+  GetBackgroundThrottlingPolicy()->Activated(this);
+  GetContentsDiscarder()->Undiscard(this, "activated", true);
   EmitEvent("activate");
 }
 
@@ -507,6 +615,9 @@ void WebContentsBinding::FindReply(content::WebContents* web_contents,
                                    int active_match_ordinal,
                                    bool final_update) {
   LOG(INFO) << __PRETTY_FUNCTION__;
+  if (find_results_) {
+    find_results_->AddUpdate(request_id, number_of_matches, selection_rect, active_match_ordinal, final_update);
+  }
   if (!final_update)
     return;
 
@@ -558,6 +669,48 @@ void WebContentsBinding::BeforeUnloadFired(const base::TimeTicks& proceed_time)
   // there are two virtual functions named BeforeUnloadFired.
 }
 
+void WebContentsBinding::RenderViewCreated(content::RenderViewHost* render_view_host) {
+  LOG(INFO) << __PRETTY_FUNCTION__;
+  if (render_view_host == web_contents()->GetRenderViewHost()) {
+    // e.g. the renderer is created again after a crash.
+    GetBackgroundThrottlingPolicy()->RendererChanged(this);
+    if (IsGuest()) {
+      WebViewManager::GetWebViewManager(web_contents())->GuestProcessChanged(guest_instance_id_, render_view_host->GetProcess()->GetID());
+    }
+  }
+  if (!IsOffscreen())
+    return;
+  auto view = render_view_host->GetWidget()->GetView();
+  if (view && view == web_contents()->GetRenderWidgetHostView())
+    SetupOffscreenView(view);
+}
+
+void WebContentsBinding::RenderViewHostChanged(content::RenderViewHost* old_host, content::RenderViewHost* new_host) {
+  LOG(INFO) << __PRETTY_FUNCTION__;
+  // the frames are subscribed on the new view (before the throttling caps
+  // their rate), the offscreen painting is subscribed again below.
+  if (new_host && frame_ring_ && !(IsOffscreen() && painting_)) {
+    if (frame_subscriber_)
+      frame_subscriber_->view()->EndFrameSubscription();
+    frame_subscriber_.reset();
+    auto new_view = new_host->GetWidget()->GetView();
+    if (new_view)
+      AttachFrameSubscriber(new_view);
+  }
+  // the new renderer is not suspended yet.
+  throttling_frozen_ = false;
+  GetBackgroundThrottlingPolicy()->RendererChanged(this);
+  if (IsGuest() && new_host) {
+    session_->GetSession()->GetGuestProcessPolicy()->GuestSiteInstanceChanged(guest_instance_id_, new_host->GetSiteInstance());
+    WebViewManager::GetWebViewManager(web_contents())->GuestProcessChanged(guest_instance_id_, new_host->GetProcess()->GetID());
+  }
+  if (!IsOffscreen() || !new_host)
+    return;
+  auto view = new_host->GetWidget()->GetView();
+  if (view)
+    SetupOffscreenView(view);
+}
+
 void WebContentsBinding::RenderViewDeleted(content::RenderViewHost* render_view_host) {
   LOG(INFO) << __PRETTY_FUNCTION__;
   EmitEvent("render-view-deleted", "id", render_view_host->GetProcess()->GetID());
@@ -565,7 +718,16 @@ void WebContentsBinding::RenderViewDeleted(content::RenderViewHost* render_view_
 
 void WebContentsBinding::RenderProcessGone(base::TerminationStatus status) {
   LOG(INFO) << __PRETTY_FUNCTION__;
-  EmitEvent("crashed", "killed", status == base::TERMINATION_STATUS_PROCESS_WAS_KILLED);
+  // a new renderer is not suspended.
+  throttling_frozen_ = false;
+  if (IsGuest()) {
+    WebViewManager::GetWebViewManager(web_contents())->GuestProcessGone(web_contents()->GetRenderProcessHost()->GetID());
+  }
+  // a discarded contents did not crash, see "discarded".
+  if (!discarded_) {
+    EmitEvent("crashed", "killed", status == base::TERMINATION_STATUS_PROCESS_WAS_KILLED);
+  }
+  ScheduleStateChanged();
 }
 
 void WebContentsBinding::PluginCrashed(const base::FilePath& plugin_path, base::ProcessId plugin_pid) {
@@ -603,8 +765,24 @@ void WebContentsBinding::DidFinishLoad(content::RenderFrameHost* render_frame_ho
   bool is_main_frame = !render_frame_host->GetParent();
   EmitEvent("did-frame-finish-load", "isMainFrame", is_main_frame);
 
-  if (is_main_frame)
-    EmitEvent("did-finish-load");
+  if (is_main_frame) {
+    if (!load_start_time_.is_null()) {
+      last_load_time_ = base::TimeTicks::Now() - load_start_time_;
+    }
+    load_start_time_ = base::TimeTicks();
+    load_finished_ = true;
+    EmitEvent("did-finish-load",
+              "loadTime", last_load_time_.InMillisecondsF(),
+              "timeSaved", time_saved_.InMillisecondsF(),
+              "prerendered", swapped_in_,
+              "prefetched", prefetched_navigation_,
+              "preconnected", preconnected_navigation_);
+    // only the first load of a prerendered contents saved time.
+    swapped_in_ = false;
+    time_saved_ = base::TimeDelta();
+    prefetched_navigation_ = false;
+    preconnected_navigation_ = false;
+  }
 }
 
 void WebContentsBinding::DidFailLoad(content::RenderFrameHost* render_frame_host,
@@ -621,14 +799,117 @@ void WebContentsBinding::DidFailLoad(content::RenderFrameHost* render_frame_host
             "isMainFrame", is_main_frame);
 }
 
+void WebContentsBinding::WasShown() {
+  GetBackgroundThrottlingPolicy()->WasShown(this);
+  GetContentsDiscarder()->WasShown(this);
+}
+
+void WebContentsBinding::WasHidden() {
+  GetBackgroundThrottlingPolicy()->WasHidden(this);
+  GetContentsDiscarder()->WasHidden(this);
+}
+
+BackgroundThrottlingPolicy* WebContentsBinding::GetBackgroundThrottlingPolicy() const {
+  return session_->GetSession()->GetBackgroundThrottlingPolicy();
+}
+
+int WebContentsBinding::GetThrottlingClientID(void) const {
+  return static_cast<int>(GetID());
+}
+
+content::RenderProcessHost* WebContentsBinding::GetThrottlingProcess(void) const {
+  return web_contents() ? web_contents()->GetRenderProcessHost() : nullptr;
+}
+
+bool WebContentsBinding::AllowsThrottling(void) const {
+  return background_throttling_;
+}
+
+bool WebContentsBinding::IsThrottlingHidden(void) const {
+  const auto view = web_contents() ? web_contents()->GetRenderWidgetHostView() : nullptr;
+  return !view || !view->IsShowing();
+}
+
+void WebContentsBinding::UpdateDisableHidden(const BackgroundThrottlingPolicy::Options& options) {
+  const auto view = web_contents()->GetRenderWidgetHostView();
+  if (!view) {
+    return;
+  }
+  const auto host = static_cast<content::RenderWidgetHostImpl*>(view->GetRenderWidgetHost());
+  host->disable_hidden_ = !background_throttling_ || !options.enabled || options.timer_tier == BackgroundThrottlingPolicy::TIMER_NONE;
+}
+
+void WebContentsBinding::ApplyThrottling(BackgroundThrottlingPolicy::State state, const BackgroundThrottlingPolicy::Options& options) {
+  if (!web_contents()) {
+    return;
+  }
+  UpdateDisableHidden(options);
+  if (frame_subscriber_) {
+    frame_subscriber_->SetFrameRateCap(state == BackgroundThrottlingPolicy::ACTIVE ? 0 : options.frame_rate_cap);
+  }
+  bool frozen = state == BackgroundThrottlingPolicy::FROZEN;
+  auto rvh = web_contents()->GetRenderViewHost();
+  if (rvh && frozen != throttling_frozen_) {
+    throttling_frozen_ = frozen;
+    rvh->Send(new MesonViewMsg_SetFrozen(rvh->GetRoutingID(), frozen));
+  }
+}
+
+void WebContentsBinding::OnThrottlingStateChanged(BackgroundThrottlingPolicy::State from, BackgroundThrottlingPolicy::State to, const std::string& reason) {
+  EmitEvent("throttling-state-changed",
+            "from", std::string(BackgroundThrottlingPolicy::StateToString(from)),
+            "to", std::string(BackgroundThrottlingPolicy::StateToString(to)),
+            "reason", reason);
+}
+
+ContentsDiscarder* WebContentsBinding::GetContentsDiscarder() const {
+  return session_->GetSession()->GetContentsDiscarder();
+}
+
+int WebContentsBinding::GetDiscardClientID(void) const {
+  return static_cast<int>(GetID());
+}
+
+content::WebContents* WebContentsBinding::GetDiscardWebContents(void) const {
+  return web_contents();
+}
+
+bool WebContentsBinding::CanDiscard(void) const {
+  if (pooled_ || !web_contents() || type_ == OFF_SCREEN || web_contents()->IsCrashed()) {
+    return false;
+  }
+  // the user would notice the audio stopping.
+  if (web_contents()->WasRecentlyAudible()) {
+    return false;
+  }
+  return type_ == REMOTE || !managed_web_contents()->IsDevToolsViewShowing();
+}
+
+void WebContentsBinding::OnDiscardStateChanged(bool discarded, const std::string& reason) {
+  discarded_ = discarded;
+  EmitEvent(discarded ? "discarded" : "undiscarded", "reason", reason);
+  ScheduleStateChanged();
+}
+
 void WebContentsBinding::DidStartLoading() {
   LOG(INFO) << __PRETTY_FUNCTION__;
+  // navigations started by the page are timed from here, LoadURL() from the call.
+  if (load_start_time_.is_null()) {
+    load_start_time_ = base::TimeTicks::Now();
+  }
+  load_finished_ = false;
   EmitEvent("did-start-loading");
+  ScheduleStateChanged();
 }
 
 void WebContentsBinding::DidStopLoading() {
   LOG(INFO) << __PRETTY_FUNCTION__;
   EmitEvent("did-stop-loading");
+  ScheduleStateChanged();
+}
+
+void WebContentsBinding::DidFirstVisuallyNonEmptyPaint() {
+  EmitEvent("did-first-visually-non-empty-paint");
 }
 
 namespace {
@@ -646,6 +927,11 @@ inline base::DictionaryValue* ToDict(scoped_refptr<net::HttpResponseHeaders> hea
 }
 
 void WebContentsBinding::DidGetResourceResponseStart(const content::ResourceRequestDetails& details) {
+  if (network_activity_) {
+    network_activity_->AddResponse(details.url, details.original_url, details.http_response_code,
+                                   details.method, details.referrer, details.resource_type, details.headers.get());
+    return;
+  }
   std::unique_ptr<base::DictionaryValue> h(ToDict(details.headers));
   EmitEvent("did-get-response-details",
             "status", details.socket_address.IsEmpty(),
@@ -659,6 +945,11 @@ void WebContentsBinding::DidGetResourceResponseStart(const content::ResourceRequ
 }
 
 void WebContentsBinding::DidGetRedirectForResourceRequest(const content::ResourceRedirectDetails& details) {
+  if (network_activity_) {
+    network_activity_->AddRedirect(details.url, details.new_url, details.http_response_code,
+                                   details.method, details.referrer, details.resource_type, details.headers.get());
+    return;
+  }
   std::unique_ptr<base::DictionaryValue> h(ToDict(details.headers));
   EmitEvent("did-get-redirect-request",
             "oldURL", details.url,
@@ -670,6 +961,47 @@ void WebContentsBinding::DidGetRedirectForResourceRequest(const content::Resourc
             "headers", h.get());
 }
 
+// args: (options)
+// null or {enabled: false} goes back to the per-resource events.
+api::MethodResult WebContentsBinding::SetNetworkActivityOptions(const api::APIArgs& args) {
+  const base::DictionaryValue* opt = nullptr;
+  bool enabled = args.GetDictionary(0, &opt);
+  if (enabled)
+    opt->GetBoolean("enabled", &enabled);
+  if (!enabled) {
+    if (network_activity_) {
+      network_activity_->Flush();
+      network_activity_.reset();
+    }
+    return api::MethodResult();
+  }
+  if (network_activity_) {
+    // statistics are kept across reconfiguration.
+    if (!network_activity_->Configure(*opt))
+      return api::MethodResult("invalid argument");
+    return api::MethodResult();
+  }
+  std::unique_ptr<NetworkActivityStream> stream(
+      new NetworkActivityStream(base::Bind(&WebContentsBinding::OnNetworkActivityFlush, base::Unretained(this))));
+  if (!stream->Configure(*opt))
+    return api::MethodResult("invalid argument");
+  network_activity_ = std::move(stream);
+  return api::MethodResult();
+}
+
+api::MethodResult WebContentsBinding::GetNetworkActivityStatistics(const api::APIArgs& args) {
+  if (!network_activity_)
+    return api::MethodResult(std::unique_ptr<base::Value>(base::Value::CreateNullValue()));
+  return api::MethodResult(network_activity_->GetStatistics());
+}
+
+void WebContentsBinding::OnNetworkActivityFlush(std::unique_ptr<base::ListValue> schema, std::unique_ptr<base::ListValue> records) {
+  std::unique_ptr<base::DictionaryValue> event(new base::DictionaryValue());
+  event->Set("schema", std::move(schema));
+  event->Set("records", std::move(records));
+  EmitEvent("network-activity", std::move(event));
+}
+
 void WebContentsBinding::DidFinishNavigation(content::NavigationHandle* navigation_handle) {
   LOG(INFO) << __PRETTY_FUNCTION__;
   bool is_main_frame = navigation_handle->IsInMainFrame();
@@ -774,6 +1106,7 @@ bool WebContentsBinding::OnMessageReceived(const IPC::Message& message) {
   IPC_BEGIN_MESSAGE_MAP(WebContentsBinding, message)
     IPC_MESSAGE_HANDLER(MesonViewHostMsg_Message, OnRendererMessage)
     IPC_MESSAGE_HANDLER_DELAY_REPLY(MesonViewHostMsg_Message_Sync, OnRendererMessageSync)
+    IPC_MESSAGE_HANDLER(MesonFrameHostMsg_RemoteSendBuffer, OnRemoteSendBuffer)
 
     IPC_MESSAGE_HANDLER_CODE(ViewHostMsg_SetCursor, OnCursorChange, handled = false)
     IPC_MESSAGE_UNHANDLED(handled = false)
@@ -801,11 +1134,27 @@ void WebContentsBinding::WebContentsDestroyed() {
 
 void WebContentsBinding::WebContentsDestroyedCore(bool destructor) {
   LOG(INFO) << __PRETTY_FUNCTION__ << " : " << destructor;
+  // the standby contents is of no use without this one.
+  CancelPrerender(api::APIArgs());
+  // the records of the last batch are sent before the contents goes.
+  if (network_activity_) {
+    network_activity_->Flush();
+    network_activity_.reset();
+  }
   // This event is only for internal use, which is emitted when WebContents is
   // being destroyed.
   EmitEvent("will-destroy");
 
   // Cleanup relationships with other parts.
+  if (session_) {
+    GetBackgroundThrottlingPolicy()->RemoveClient(this);
+    GetContentsDiscarder()->RemoveClient(this);
+    if (IsGuest()) {
+      session_->GetSession()->GetGuestProcessPolicy()->ReleaseGuest(guest_instance_id_);
+    }
+  }
+  // the buffers the host has not released go with the contents.
+  SharedBufferRegistry::Get()->ReleaseOwner(static_cast<int>(GetID()));
   if (!destructor) {
     auto self = WebContentsBinding::Class().GetBinding(GetID());
     if (self) {
@@ -855,6 +1204,14 @@ void WebContentsBinding::LoadURL(const GURL& url, const base::DictionaryValue& o
     return;
   }
 
+  // the new navigation replaces the discarded one.
+  GetContentsDiscarder()->Undiscard(this, "navigated", false);
+
+  load_start_time_ = base::TimeTicks::Now();
+  auto predictor = GetBrowserContext()->GetNavigationPredictor();
+  prefetched_navigation_ = predictor->TakePrefetched(url);
+  preconnected_navigation_ = predictor->TakePreconnected(url);
+
   content::NavigationController::LoadURLParams params(url);
 
   std::string http_referrer_str;
@@ -889,8 +1246,7 @@ void WebContentsBinding::LoadURL(const GURL& url, const base::DictionaryValue& o
   }
 
   // For the same reason we can only disable hidden here.
-  const auto host = static_cast<content::RenderWidgetHostImpl*>(view->GetRenderWidgetHost());
-  host->disable_hidden_ = !background_throttling_;
+  UpdateDisableHidden(GetBackgroundThrottlingPolicy()->options());
 }
 
 void WebContentsBinding::DownloadURL(const GURL& url) {
@@ -922,6 +1278,239 @@ bool WebContentsBinding::IsWaitingForResponse() const {
   return web_contents()->IsWaitingForResponse();
 }
 
+std::unique_ptr<base::DictionaryValue> WebContentsBinding::CreateStateValue() {
+  std::unique_ptr<base::DictionaryValue> state(new base::DictionaryValue());
+  state->SetString("url", GetURL().spec());
+  state->SetString("title", GetTitle());
+  state->SetBoolean("loading", IsLoading());
+  state->SetBoolean("loadingMainFrame", IsLoadingMainFrame());
+  state->SetBoolean("waitingForResponse", IsWaitingForResponse());
+  state->SetBoolean("crashed", IsCrashed() && !discarded_);
+  state->SetBoolean("audioMuted", IsAudioMuted());
+  state->SetBoolean("discarded", discarded_);
+  return state;
+}
+
+void WebContentsBinding::ScheduleStateChanged(void) {
+  // several changes of one task are sent as a single event.
+  if (state_change_scheduled_ || !web_contents()) {
+    return;
+  }
+  state_change_scheduled_ = true;
+  base::ThreadTaskRunnerHandle::Get()->PostTask(FROM_HERE, base::Bind(&WebContentsBinding::EmitStateChanged, base::AsWeakPtr(this)));
+}
+
+void WebContentsBinding::EmitStateChanged(void) {
+  state_change_scheduled_ = false;
+  if (!web_contents()) {
+    return;
+  }
+  std::unique_ptr<base::DictionaryValue> state = CreateStateValue();
+  std::unique_ptr<base::DictionaryValue> changed(new base::DictionaryValue());
+  for (base::DictionaryValue::Iterator it(*state); !it.IsAtEnd(); it.Advance()) {
+    const base::Value* last = nullptr;
+    if (!notified_state_ || !notified_state_->GetWithoutPathExpansion(it.key(), &last) || !last->Equals(&it.value())) {
+      changed->SetWithoutPathExpansion(it.key(), it.value().CreateDeepCopy());
+    }
+  }
+  notified_state_ = std::move(state);
+  if (changed->empty()) {
+    return;
+  }
+  std::unique_ptr<base::DictionaryValue> event(new base::DictionaryValue());
+  event->Set("changed", std::move(changed));
+  EmitEvent("state-changed", std::move(event));
+}
+
+scoped_refptr<WebContentsBinding> WebContentsBinding::TakePrerendered(const GURL& url) {
+  if (!prerendered_ || prerendered_url_ != url || !prerendered_->web_contents() || prerendered_->IsCrashed()) {
+    return nullptr;
+  }
+  prerendered_url_ = GURL();
+  return std::move(prerendered_);
+}
+
+void WebContentsBinding::DidSwapIn(void) {
+  web_contents()->WasShown();
+  if (load_finished_) {
+    // the whole load happened before the navigation.
+    EmitEvent("did-finish-load",
+              "loadTime", 0.0,
+              "timeSaved", last_load_time_.InMillisecondsF(),
+              "prerendered", true,
+              "prefetched", false,
+              "preconnected", false);
+    return;
+  }
+  // reported when the load finishes.
+  swapped_in_ = true;
+  time_saved_ = base::TimeTicks::Now() - load_start_time_;
+}
+
+void WebContentsBinding::Unpool(void) {
+  if (!pooled_) {
+    return;
+  }
+  pooled_ = false;
+  GetBackgroundThrottlingPolicy()->AddClient(this);
+  GetContentsDiscarder()->AddClient(this);
+}
+
+// args: (url)
+api::MethodResult WebContentsBinding::Prefetch(const api::APIArgs& args) {
+  std::string url;
+  if (!args.GetString(0, &url) || !GURL(url).is_valid()) {
+    return api::MethodResult("invalid argument");
+  }
+  if (!GetBrowserContext()->GetNavigationPredictor()->Prefetch(GURL(url))) {
+    return api::MethodResult("too many prefetches");
+  }
+  return api::MethodResult();
+}
+
+// args: (url, {sockets, resolveOnly})
+api::MethodResult WebContentsBinding::Preconnect(const api::APIArgs& args) {
+  std::string url;
+  if (!args.GetString(0, &url) || !GURL(url).is_valid()) {
+    return api::MethodResult("invalid argument");
+  }
+  int sockets = kDefaultPreconnectSockets;
+  bool resolve_only = false;
+  const base::DictionaryValue* opt = nullptr;
+  if (args.GetDictionary(1, &opt)) {
+    opt->GetInteger("sockets", &sockets);
+    opt->GetBoolean("resolveOnly", &resolve_only);
+  }
+  auto predictor = GetBrowserContext()->GetNavigationPredictor();
+  if (resolve_only) {
+    predictor->Preresolve(GURL(url));
+  } else {
+    predictor->Preconnect(GURL(url), std::max(sockets, 1));
+  }
+  return api::MethodResult();
+}
+
+// args: (url, options)
+// Loads |url| into a hidden standby contents. The window shows it instead of
+// loading, when it navigates to the same url.
+api::MethodResult WebContentsBinding::Prerender(const api::APIArgs& args) {
+#if defined(OS_MACOSX)
+  std::string url;
+  if (!args.GetString(0, &url) || !GURL(url).is_valid()) {
+    return api::MethodResult("invalid argument");
+  }
+  if (type_ != BROWSER_WINDOW) {
+    return api::MethodResult("prerender is only supported for window contents");
+  }
+  const base::DictionaryValue* opt = nullptr;
+  base::DictionaryValue empty;
+  if (!args.GetDictionary(1, &opt)) {
+    opt = &empty;
+  }
+  CancelPrerender(api::APIArgs());
+
+  std::unique_ptr<base::DictionaryValue> prefs(WebContentsPreferences::FromWebContents(web_contents())->web_preferences()->DeepCopy());
+  prefs->SetInteger("_session_id_", session_->GetID());
+  prerendered_ = static_cast<WebContentsClassBinding&>(WebContentsBinding::Class()).NewInstance(*prefs);
+  prerendered_->web_contents()->WasHidden();
+  prerendered_->LoadURL(GURL(url), *opt);
+  prerendered_url_ = GURL(url);
+  return api::MethodResult(std::unique_ptr<base::Value>(new base::FundamentalValue(static_cast<int>(prerendered_->GetID()))));
+#else
+  // only the mac window can swap the view of its contents.
+  return api::MethodResult("prerender is not supported on this platform");
+#endif
+}
+
+api::MethodResult WebContentsBinding::CancelPrerender(const api::APIArgs& args) {
+  if (prerendered_) {
+    prerendered_->DestroyWebContents();
+    prerendered_ = nullptr;
+    prerendered_url_ = GURL();
+  }
+  return api::MethodResult();
+}
+
+api::MethodResult WebContentsBinding::GetNavigationPredictorStatistics(const api::APIArgs& args) {
+  std::unique_ptr<base::DictionaryValue> stats = GetBrowserContext()->GetNavigationPredictor()->GetStatistics();
+  stats->SetString("prerenderedURL", prerendered_url_.spec());
+  return api::MethodResult(std::move(stats));
+}
+
+// args: (text, {forward, matchCase, findNext, wordStart, medialCapitalAsWordStart, stream, batchInterval})
+api::MethodResult WebContentsBinding::FindInPage(const api::APIArgs& args) {
+  base::string16 search_text;
+  if (!args.GetString(0, &search_text) || search_text.empty()) {
+    return api::MethodResult("Must provide a non-empty search content");
+  }
+  blink::WebFindOptions options;
+  bool stream = false;
+  int batch_interval = kDefaultFindBatchInterval;
+  const base::DictionaryValue* opt = nullptr;
+  if (args.GetDictionary(1, &opt)) {
+    opt->GetBoolean("forward", &options.forward);
+    opt->GetBoolean("matchCase", &options.matchCase);
+    opt->GetBoolean("findNext", &options.findNext);
+    opt->GetBoolean("wordStart", &options.wordStart);
+    opt->GetBoolean("medialCapitalAsWordStart", &options.medialCapitalAsWordStart);
+    opt->GetBoolean("stream", &stream);
+    opt->GetInteger("batchInterval", &batch_interval);
+  }
+  if (batch_interval < 0) {
+    return api::MethodResult("invalid argument");
+  }
+  int request_id = ++find_request_id_;
+  Find(request_id, search_text, options, stream, batch_interval);
+  return api::MethodResult(std::unique_ptr<base::Value>(new base::FundamentalValue(request_id)));
+}
+
+// args: ("clear" | "keep" | "activate")
+api::MethodResult WebContentsBinding::StopFinding(const api::APIArgs& args) {
+  std::string action;
+  content::StopFindAction action_value = content::STOP_FIND_ACTION_CLEAR_SELECTION;
+  if (args.GetString(0, &action)) {
+    if (action == "keep") {
+      action_value = content::STOP_FIND_ACTION_KEEP_SELECTION;
+    } else if (action == "activate") {
+      action_value = content::STOP_FIND_ACTION_ACTIVATE_SELECTION;
+    } else if (action != "clear") {
+      return api::MethodResult("invalid argument");
+    }
+  }
+  StopFindInPage(action_value);
+  return api::MethodResult();
+}
+
+api::MethodResult WebContentsBinding::GetFindStatistics(const api::APIArgs& args) {
+  if (!find_results_) {
+    return api::MethodResult(std::unique_ptr<base::Value>(new base::DictionaryValue()));
+  }
+  return api::MethodResult(find_results_->GetStatistics());
+}
+
+api::MethodResult WebContentsBinding::GetState(const api::APIArgs& args) {
+  if (!web_contents()) {
+    return api::MethodResult("web contents destroyed");
+  }
+  return api::MethodResult(CreateStateValue());
+}
+
+api::MethodResult WebContentsBinding::Discard(const api::APIArgs& args) {
+  if (!web_contents()) {
+    return api::MethodResult("web contents destroyed");
+  }
+  bool discarded = !discarded_ && CanDiscard() && GetContentsDiscarder()->Discard(this, "api");
+  return api::MethodResult(std::unique_ptr<base::Value>(new base::FundamentalValue(discarded)));
+}
+
+api::MethodResult WebContentsBinding::Undiscard(const api::APIArgs& args) {
+  if (!web_contents()) {
+    return api::MethodResult("web contents destroyed");
+  }
+  bool undiscarded = GetContentsDiscarder()->Undiscard(this, "api", true);
+  return api::MethodResult(std::unique_ptr<base::Value>(new base::FundamentalValue(undiscarded)));
+}
+
 void WebContentsBinding::Stop() {
   web_contents()->Stop();
 }
@@ -1086,6 +1675,7 @@ void WebContentsBinding::UnregisterServiceWorker(const base::Callback<void(bool)
 
 void WebContentsBinding::SetAudioMuted(bool muted) {
   web_contents()->SetAudioMuted(muted);
+  ScheduleStateChanged();
 }
 
 bool WebContentsBinding::IsAudioMuted() {
@@ -1179,30 +1769,29 @@ void WebContentsBinding::ReplaceMisspelling(const base::string16& word) {
   web_contents()->ReplaceMisspelling(word);
 }
 
-size_t WebContentsBinding::FindInPage(base::ListValue* args) {
-#if 0
-  //TODO:
-  uint32_t request_id = GetNextRequestId();
-  base::string16 search_text;
-  blink::WebFindOptions options;
-  if (!args->GetNext(&search_text) || search_text.empty()) {
-    args->ThrowError("Must provide a non-empty search content");
-    return 0;
+void WebContentsBinding::Find(int request_id, const base::string16& search_text, const blink::WebFindOptions& options, bool stream, int batch_interval) {
+  if (stream) {
+    if (!find_results_) {
+      find_results_.reset(new FindResultStream(base::Bind(&WebContentsBinding::OnFindResults, base::Unretained(this))));
+    }
+    find_results_->Start(request_id, base::TimeDelta::FromMilliseconds(batch_interval));
+  } else if (find_results_) {
+    find_results_->Cancel();
   }
-
-  args->GetNext(&options);
-
   web_contents()->Find(request_id, search_text, options);
-  return request_id;
-#else
-  return 0;
-#endif
 }
 
 void WebContentsBinding::StopFindInPage(content::StopFindAction action) {
+  if (find_results_) {
+    find_results_->Cancel();
+  }
   web_contents()->StopFinding(action);
 }
 
+void WebContentsBinding::OnFindResults(std::unique_ptr<base::DictionaryValue> batch) {
+  EmitEvent("find-in-page-update", std::move(batch));
+}
+
 void WebContentsBinding::ShowDefinitionForSelection() {
 #if defined(OS_MACOSX)
   const auto view = web_contents()->GetRenderWidgetHostView();
@@ -1218,6 +1807,8 @@ void WebContentsBinding::CopyImageAt(int x, int y) {
 }
 
 void WebContentsBinding::Focus() {
+  GetBackgroundThrottlingPolicy()->Activated(this);
+  GetContentsDiscarder()->Undiscard(this, "activated", true);
   web_contents()->Focus();
 }
 
@@ -1280,35 +1871,96 @@ void WebContentsBinding::SendInputEvent(v8::Isolate* isolate, v8::Local<v8::Valu
 }
 #endif
 
-void WebContentsBinding::BeginFrameSubscription(base::ListValue* args) {
-#if 0
-  //TODO:
+namespace {
+const int kDefaultFrameSlots = 3;
+const int kMaxFrameSlots = 16;
+const int kOffscreenFrameSlots = 4;
+}
+
+// args: ({onlyDirty, slots, width, height})
+// slots are sized for width x height BGRA (default: the current view size),
+// larger frames are downscaled during readback.
+api::MethodResult WebContentsBinding::BeginFrameSubscription(const api::APIArgs& args) {
+  const auto view = web_contents()->GetRenderWidgetHostView();
+  if (!view) {
+    return api::MethodResult("no view");
+  }
+  const base::DictionaryValue* opt = nullptr;
+  base::DictionaryValue dummy;
+  if (!args.GetDictionary(0, &opt)) {
+    opt = &dummy;
+  }
   bool only_dirty = false;
-  FrameSubscriber::FrameCaptureCallback callback;
-  int args_idx = 0;
+  int slots = kDefaultFrameSlots;
+  gfx::Size size = view->GetVisibleViewportSize();
+  int w = 0;
+  int h = 0;
+  opt->GetBoolean("onlyDirty", &only_dirty);
+  opt->GetInteger("slots", &slots);
+  if (opt->GetInteger("width", &w) && opt->GetInteger("height", &h)) {
+    size.SetSize(w, h);
+  }
+  if (slots < 1 || slots > kMaxFrameSlots || size.IsEmpty()) {
+    return api::MethodResult("invalid argument");
+  }
 
-  args->GetBoolean(args_idx++, &only_dirty);
-  if (!args->Get(args_idx++, &callback)) {
-    args->ThrowError();
-    return;
+  if (!SubscribeFrames(view, only_dirty, slots, size, "frame")) {
+    return api::MethodResult("failed to allocate frame buffer");
   }
+  // frame subscription takes over the offscreen painting.
+  painting_ = false;
+  int subscription_id = static_cast<int>(frame_ring_->GetID());
+  return api::MethodResult(std::unique_ptr<base::Value>(new base::FundamentalValue(subscription_id)));
+}
 
-  const auto view = web_contents()->GetRenderWidgetHostView();
-  if (view) {
-    std::unique_ptr<FrameSubscriber> frame_subscriber(
-        new FrameSubscriber(isolate(), view, callback, only_dirty));
-    view->BeginFrameSubscription(std::move(frame_subscriber));
+api::MethodResult WebContentsBinding::EndFrameSubscription(const api::APIArgs& args) {
+  UnsubscribeFrames();
+  return api::MethodResult();
+}
+
+bool WebContentsBinding::SubscribeFrames(content::RenderWidgetHostView* view, bool only_dirty, int slots, const gfx::Size& size, const std::string& event_name) {
+  UnsubscribeFrames();
+  frame_ring_ = FrameRingBuffer::Create(slots, static_cast<size_t>(size.GetArea()) * 4);
+  if (!frame_ring_) {
+    return false;
   }
-#endif
+  frame_only_dirty_ = only_dirty;
+  frame_event_name_ = event_name;
+  AttachFrameSubscriber(view);
+  return true;
 }
 
-void WebContentsBinding::EndFrameSubscription() {
-#if 0
-  //TODO:
-  const auto view = web_contents()->GetRenderWidgetHostView();
-  if (view)
-    view->EndFrameSubscription();
-#endif
+void WebContentsBinding::AttachFrameSubscriber(content::RenderWidgetHostView* view) {
+  // the same ring is kept, so the subscription id and the sequence go on.
+  std::unique_ptr<FrameSubscriber> frame_subscriber(
+      new FrameSubscriber(view, frame_ring_, frame_only_dirty_, base::Bind(&WebContentsBinding::OnFrameWritten, base::AsWeakPtr(this), frame_ring_->GetID(), frame_event_name_)));
+  if (IsOffscreen()) {
+    frame_subscriber->SetFrameRate(frame_rate_);
+  }
+  frame_subscriber_ = frame_subscriber->GetWeakPtr();
+  view->BeginFrameSubscription(std::move(frame_subscriber));
+}
+
+void WebContentsBinding::UnsubscribeFrames(void) {
+  // ended on the view it was started on, which may not be the current one.
+  if (frame_subscriber_)
+    frame_subscriber_->view()->EndFrameSubscription();
+  frame_subscriber_.reset();
+  if (frame_ring_) {
+    frame_ring_->Close();
+    frame_ring_ = nullptr;
+  }
+}
+
+void WebContentsBinding::OnFrameWritten(unsigned int ring_id, const std::string& event_name, unsigned int sequence, const gfx::Rect& dirty_rect, const gfx::Size& frame_size) {
+  // a frame of a subscription ended since.
+  if (!frame_ring_ || frame_ring_->GetID() != ring_id)
+    return;
+  EmitEvent(event_name,
+            "subscriptionId", static_cast<int>(frame_ring_->GetID()),
+            "sequence", static_cast<double>(sequence),
+            "dirtyRect", dirty_rect,
+            "size", frame_size);
 }
 
 void WebContentsBinding::StartDrag(const base::DictionaryValue& item, base::ListValue* args) {
@@ -1342,43 +1994,106 @@ void WebContentsBinding::StartDrag(const base::DictionaryValue& item, base::List
 #endif
 }
 
-void WebContentsBinding::CapturePage(base::ListValue* args) {
-#if 0
-  //TODO:
-  gfx::Rect rect;
-  base::Callback<void(const gfx::Image&)> callback;
-
-  if (!(args->Length() == 1 && args->GetNext(&callback)) &&
-      !(args->Length() == 2 && args->GetNext(&rect) && args->GetNext(&callback))) {
-    args->ThrowError();
+namespace {
+const int kDefaultCaptureQuality = 90;
+int g_next_capture_request_id = 0;
+
+void OnCapturePageEncoded(base::WeakPtr<WebContentsBinding> binding, int request_id, const CaptureResult& result) {
+  if (!binding || !binding->web_contents()) {
+    // nobody will receive the buffer (ReleaseOwner already ran).
+    if (result.buffer_id)
+      SharedBufferRegistry::Get()->Release(result.buffer_id);
+    return;
+  }
+  if (!result.buffer_id) {
+    binding->EmitEvent("capture-page", "requestId", request_id, "error", std::string("failed to encode"));
     return;
   }
+  binding->EmitEvent("capture-page",
+                     "requestId", request_id,
+                     "bufferId", static_cast<int>(result.buffer_id),
+                     "size", static_cast<double>(result.size),
+                     "width", result.width,
+                     "height", result.height,
+                     "format", result.format);
+}
+}
+
+// args: ({x, y, width, height, targetWidth, targetHeight, format, quality})
+// returns the request id, the result is emitted with the "capture-page" event.
+// the image is scaled to the target size during readback (default: region at
+// device scale), and encoded on the blocking pool into a shared buffer.
+api::MethodResult WebContentsBinding::CapturePage(const api::APIArgs& args) {
+  const base::DictionaryValue* opt = nullptr;
+  base::DictionaryValue dummy;
+  if (!args.GetDictionary(0, &opt)) {
+    opt = &dummy;
+  }
+  std::string format_name = "png";
+  CaptureFormat format;
+  int quality = kDefaultCaptureQuality;
+  opt->GetString("format", &format_name);
+  opt->GetInteger("quality", &quality);
+  if (!ParseCaptureFormat(format_name, &format) || quality < 0 || quality > 100) {
+    return api::MethodResult("invalid argument");
+  }
 
   const auto view = web_contents()->GetRenderWidgetHostView();
   const auto host = view ? view->GetRenderWidgetHost() : nullptr;
   if (!view || !host) {
-    callback.Run(gfx::Image());
-    return;
+    return api::MethodResult("no view");
   }
 
-  // Capture full page if user doesn't specify a |rect|.
+  // Capture full page if user doesn't specify a region.
+  gfx::Rect rect;
+  int x = 0, y = 0, w = 0, h = 0;
+  if (opt->GetInteger("width", &w) && opt->GetInteger("height", &h)) {
+    opt->GetInteger("x", &x);
+    opt->GetInteger("y", &y);
+    rect.SetRect(x, y, w, h);
+  }
   const gfx::Size view_size = rect.IsEmpty() ? view->GetViewBounds().size() : rect.size();
+  if (view_size.IsEmpty()) {
+    return api::MethodResult("empty region");
+  }
 
-  // By default, the requested bitmap size is the view size in screen
-  // coordinates.  However, if there's more pixel detail available on the
-  // current system, increase the requested bitmap size to capture it all.
   gfx::Size bitmap_size = view_size;
-  const gfx::NativeView native_view = view->GetNativeView();
-  const float scale = display::Screen::GetScreen()
-                          ->GetDisplayNearestWindow(native_view)
-                          .device_scale_factor();
-  if (scale > 1.0f)
-    bitmap_size = gfx::ScaleToCeiledSize(view_size, scale);
+  int tw = 0, th = 0;
+  bool has_tw = opt->GetInteger("targetWidth", &tw) && tw > 0;
+  bool has_th = opt->GetInteger("targetHeight", &th) && th > 0;
+  if (has_tw || has_th) {
+    // keep the aspect ratio when only one side is given.
+    if (!has_th)
+      th = std::max(1, view_size.height() * tw / view_size.width());
+    if (!has_tw)
+      tw = std::max(1, view_size.width() * th / view_size.height());
+    bitmap_size.SetSize(tw, th);
+  } else {
+    // By default, the requested bitmap size is the view size in screen
+    // coordinates.  However, if there's more pixel detail available on the
+    // current system, increase the requested bitmap size to capture it all.
+    const gfx::NativeView native_view = view->GetNativeView();
+    const float scale = display::Screen::GetScreen()->GetDisplayNearestWindow(native_view).device_scale_factor();
+    if (scale > 1.0f)
+      bitmap_size = gfx::ScaleToCeiledSize(view_size, scale);
+  }
 
+  int request_id = ++g_next_capture_request_id;
   host->CopyFromBackingStore(gfx::Rect(rect.origin(), view_size), bitmap_size,
-                             base::Bind(&OnCapturePageDone, callback),
-                             kBGRA_8888_SkColorType);
-#endif
+                             base::Bind(&WebContentsBinding::OnCapturePageReadback, base::AsWeakPtr(this), request_id, format, quality),
+                             kN32_SkColorType);
+  return api::MethodResult(std::unique_ptr<base::Value>(new base::FundamentalValue(request_id)));
+}
+
+void WebContentsBinding::OnCapturePageReadback(int request_id, CaptureFormat format, int quality, const SkBitmap& bitmap, content::ReadbackResponse response) {
+  if (response != content::ReadbackResponse::READBACK_SUCCESS) {
+    EmitEvent("capture-page", "requestId", request_id, "error", std::string("failed to read back"));
+    return;
+  }
+  // readback of the next capture can start while this one is encoded.
+  base::PostTaskAndReplyWithResult(content::BrowserThread::GetBlockingPool(), FROM_HERE,
+                                   base::Bind(&EncodeCapture, bitmap, format, quality, static_cast<int>(GetID())),
+                                   base::Bind(&OnCapturePageEncoded, base::AsWeakPtr(this), request_id));
 }
 
 void WebContentsBinding::OnCursorChange(const content::WebCursor& cursor) {
@@ -1401,85 +2116,64 @@ void WebContentsBinding::SetSize(const SetSizeParams& params) {
     guest_delegate_->SetSize(params);
 }
 
-void WebContentsBinding::OnPaint(const gfx::Rect& dirty_rect, const SkBitmap& bitmap) {
-#if 0
-  //TODO: nativeImage
-  mate::Handle<NativeImage> image =      NativeImage::Create(isolate(), gfx::Image::CreateFrom1xBitmap(bitmap));
-  Emit("paint", dirty_rect, image);
-#endif
+void WebContentsBinding::SetupOffscreenView(content::RenderWidgetHostView* view) {
+  view->SetSize(offscreen_size_);
+  view->Show();
+  if (painting_) {
+    SubscribeFrames(view, true, kOffscreenFrameSlots, offscreen_size_, "paint");
+  }
 }
 
-void WebContentsBinding::StartPainting() {
+api::MethodResult WebContentsBinding::StartPainting(const api::APIArgs& args) {
   if (!IsOffscreen())
-    return;
-#if 0
-  //TODO: offscreen support
-
-  auto* osr_rwhv = static_cast<OffScreenRenderWidgetHostView*>(
-      web_contents()->GetRenderWidgetHostView());
-  if (osr_rwhv)
-    osr_rwhv->SetPainting(true);
-#endif
+    return api::MethodResult("not offscreen");
+  if (painting_)
+    return api::MethodResult();
+  painting_ = true;
+  const auto view = web_contents()->GetRenderWidgetHostView();
+  if (view)
+    SubscribeFrames(view, true, kOffscreenFrameSlots, offscreen_size_, "paint");
+  return api::MethodResult();
 }
 
-void WebContentsBinding::StopPainting() {
+api::MethodResult WebContentsBinding::StopPainting(const api::APIArgs& args) {
   if (!IsOffscreen())
-    return;
-#if 0
-  //TODO: offscreen support
-  auto* osr_rwhv = static_cast<OffScreenRenderWidgetHostView*>(
-      web_contents()->GetRenderWidgetHostView());
-  if (osr_rwhv)
-    osr_rwhv->SetPainting(false);
-#endif
+    return api::MethodResult("not offscreen");
+  if (painting_) {
+    painting_ = false;
+    UnsubscribeFrames();
+  }
+  return api::MethodResult();
 }
 
-bool WebContentsBinding::IsPainting() const {
-  if (!IsOffscreen())
-    return false;
-#if 0
-  //TODO: offscreen support
-  const auto* osr_rwhv = static_cast<OffScreenRenderWidgetHostView*>(
-      web_contents()->GetRenderWidgetHostView());
-  return osr_rwhv && osr_rwhv->IsPainting();
-#endif
-  return false;
+api::MethodResult WebContentsBinding::IsPainting(const api::APIArgs& args) {
+  bool painting = IsOffscreen() && painting_;
+  return api::MethodResult(std::unique_ptr<base::Value>(new base::FundamentalValue(painting)));
 }
 
-void WebContentsBinding::SetFrameRate(int frame_rate) {
+api::MethodResult WebContentsBinding::SetFrameRate(const api::APIArgs& args) {
   if (!IsOffscreen())
-    return;
-#if 0
-  //TODO: offscreen support
-  auto* osr_rwhv = static_cast<OffScreenRenderWidgetHostView*>(
-      web_contents()->GetRenderWidgetHostView());
-  if (osr_rwhv)
-    osr_rwhv->SetFrameRate(frame_rate);
-#endif
+    return api::MethodResult("not offscreen");
+  int frame_rate = 0;
+  if (!args.GetInteger(0, &frame_rate) || frame_rate < 0)
+    return api::MethodResult("invalid argument");
+  frame_rate_ = frame_rate;
+  if (painting_ && frame_subscriber_)
+    frame_subscriber_->SetFrameRate(frame_rate_);
+  return api::MethodResult();
 }
 
-int WebContentsBinding::GetFrameRate() const {
-  if (!IsOffscreen())
-    return 0;
-#if 0
-  //TODO: offscreen support
-  const auto* osr_rwhv = static_cast<OffScreenRenderWidgetHostView*>(
-      web_contents()->GetRenderWidgetHostView());
-  return osr_rwhv ? osr_rwhv->GetFrameRate() : 0;
-#endif
-  return 0;
+api::MethodResult WebContentsBinding::GetFrameRate(const api::APIArgs& args) {
+  int frame_rate = IsOffscreen() ? frame_rate_ : 0;
+  return api::MethodResult(std::unique_ptr<base::Value>(new base::FundamentalValue(frame_rate)));
 }
 
-void WebContentsBinding::Invalidate() {
+api::MethodResult WebContentsBinding::Invalidate(const api::APIArgs& args) {
   if (!IsOffscreen())
-    return;
-#if 0
-  //TODO: offscreen support
-  auto* osr_rwhv = static_cast<OffScreenRenderWidgetHostView*>(
-      web_contents()->GetRenderWidgetHostView());
-  if (osr_rwhv)
-    osr_rwhv->Invalidate();
-#endif
+    return api::MethodResult("not offscreen");
+  if (painting_ && frame_subscriber_)
+    frame_subscriber_->Invalidate();
+  return api::MethodResult();
 }
 
 content::WebContents* WebContentsBinding::HostWebContents() {
@@ -1488,13 +2182,26 @@ content::WebContents* WebContentsBinding::HostWebContents() {
   return embedder_->web_contents();
 }
 
-void WebContentsBinding::WebViewEmit(const std::string& type, const base::DictionaryValue& params) {
-  if (embedder_) {
-    auto frame = embedder_->web_contents()->GetMainFrame();
-    //auto frame = web_contents()->GetMainFrame();
-    LOG(INFO) << __PRETTY_FUNCTION__ << "(" << type << ",?)" << frame->GetRoutingID() << " : " << guest_instance_id_;
-    frame->Send(new MesonFrameMsg_WebViewEmit(frame->GetRoutingID(), guest_instance_id_, type, params));
+size_t WebContentsBinding::WebViewEmit(const std::string& type, const base::DictionaryValue& params) {
+  if (!embedder_) {
+    return 0;
   }
+  auto frame = embedder_->web_contents()->GetMainFrame();
+  //auto frame = web_contents()->GetMainFrame();
+  LOG(INFO) << __PRETTY_FUNCTION__ << "(" << type << ",?)" << frame->GetRoutingID() << " : " << guest_instance_id_;
+  auto message = new MesonFrameMsg_WebViewEmit(frame->GetRoutingID(), guest_instance_id_, type, params);
+  size_t size = message->size();
+  frame->Send(message);
+  return size;
+}
+
+void WebContentsBinding::AttachToEmbedder(WebContentsBinding* embedder) {
+  CHECK(IsGuest());
+  embedder_ = base::AsWeakPtr(embedder);
+  // New WebContents's owner_window is the embedder's owner_window.
+  auto relay = NativeWindowRelay::FromWebContents(embedder_->web_contents());
+  if (relay)
+    SetOwnerWindow(relay->window.get());
 }
 
 void WebContentsBinding::SetEmbedder(void) {
@@ -1634,6 +2341,33 @@ void WebContentsBinding::OnRendererMessageSync(const base::string16& channel, co
   EmitEvent(base::UTF16ToUTF8(channel), "message", /*web_contents(), */ message /*, args*/);
 }
 
+void WebContentsBinding::OnRemoteSendBuffer(const base::SharedMemoryHandle& handle, uint32_t size, const base::DictionaryValue& message) {
+  LOG(INFO) << __PRETTY_FUNCTION__ << "(" << size << ")";
+  if (!base::SharedMemory::IsHandleValid(handle)) {
+    LOG(ERROR) << __PRETTY_FUNCTION__ << " : invalid handle";
+    return;
+  }
+  // the size is the renderer's word, a map past the end of the region
+  // succeeds and the first read there crashes the browser.
+  size_t region_size = 0;
+  if (!base::SharedMemory::GetSizeFromSharedMemoryHandle(handle, &region_size) || size == 0 || size > region_size) {
+    LOG(ERROR) << __PRETTY_FUNCTION__ << " : invalid size " << size << " (" << region_size << ")";
+    base::SharedMemory::CloseHandle(handle);
+    return;
+  }
+  // map read only. the host reads the renderer's pages directly, no copy.
+  std::unique_ptr<base::SharedMemory> memory(new base::SharedMemory(handle, true));
+  if (!memory->Map(size)) {
+    LOG(ERROR) << __PRETTY_FUNCTION__ << " : failed to map " << size << " bytes";
+    return;
+  }
+  unsigned int buffer_id = SharedBufferRegistry::Get()->Add(std::move(memory), size, static_cast<int>(GetID()));
+  EmitEvent("remote-buffer",
+            "bufferId", static_cast<int>(buffer_id),
+            "size", static_cast<double>(size),
+            "message", &message);
+}
+
 WebContentsClassBinding::WebContentsClassBinding(void)
     : APIClassBindingT(MESON_OBJECT_TYPE_WEB_CONTENTS) {}
 WebContentsClassBinding::~WebContentsClassBinding() {
@@ -1648,6 +2382,27 @@ api::MethodResult WebContentsClassBinding::CreateInstance(const api::APIArgs& ar
   return api::MethodResult(ret);
 }
 
+api::MethodResult WebContentsClassBinding::GetStates(const api::APIArgs& args) {
+  const base::ListValue* ids = nullptr;
+  if (!args.GetList(0, &ids)) {
+    return api::MethodResult("invalid argument");
+  }
+  std::unique_ptr<base::ListValue> states(new base::ListValue());
+  for (size_t i = 0; i < ids->GetSize(); i++) {
+    int id = 0;
+    scoped_refptr<WebContentsBinding> binding;
+    if (ids->GetInteger(i, &id)) {
+      binding = GetBinding(id);
+    }
+    if (binding && binding->web_contents()) {
+      states->Append(binding->CreateStateValue());
+    } else {
+      states->Append(base::Value::CreateNullValue());
+    }
+  }
+  return api::MethodResult(std::move(states));
+}
+
 scoped_refptr<WebContentsBinding> WebContentsClassBinding::NewInstance(const base::DictionaryValue& args) {
   auto id = GetNextBindingID();
   scoped_refptr<WebContentsBinding> binding = new WebContentsBinding(id, args);
@@ -5,26 +5,44 @@
 #include <map>
 #include "base/callback.h"
 #include "base/memory/ref_counted.h"
+#include "base/memory/shared_memory.h"
+#include "content/public/browser/invalidate_type.h"
+#include "content/public/browser/readback_types.h"
 #include "content/public/browser/web_contents_observer.h"
 
 #include "api/api_binding.h"
+#include "browser/background_throttling_policy.h"
+#include "browser/capture_encoder.h"
 #include "browser/common_web_contents_delegate.h"
+#include "browser/contents_discarder.h"
 #include "content/public/common/favicon_url.h"
 #include "content/common/cursors/webcursor.h"
 
-namespace contents {
+namespace content {
+class RenderProcessHost;
+class RenderWidgetHostView;
 class WebContents;
 }
+namespace blink {
+struct WebFindOptions;
+}
 namespace meson {
 struct SetSizeParams;
 class WebViewGuestDelegate;
 class MesonWindow;
 class SessionBinding;
 class MesonBrowserContext;
+class FrameRingBuffer;
+class FrameSubscriber;
+class NetworkActivityStream;
+class ConsoleMessageBuffer;
+class FindResultStream;
 class WebContentsClassBinding;
 class WebContentsBinding : public APIBindingT<WebContentsBinding, WebContentsClassBinding>,
                            public CommonWebContentsDelegate,
-                           public content::WebContentsObserver {
+                           public content::WebContentsObserver,
+                           public BackgroundThrottlingPolicy::Client,
+                           public ContentsDiscarder::Client {
  public:
   enum Type {
     BACKGROUND_PAGE,  // A DevTools extension background page.
@@ -47,12 +65,20 @@ class WebContentsBinding : public APIBindingT<WebContentsBinding, WebContentsCla
   Type GetType() const;
   bool Equal(const WebContentsBinding* web_contents) const;
   void LoadURL(const GURL& url, const base::DictionaryValue& options);
+  // The standby contents prerendering |url|, to be shown instead of loading it.
+  scoped_refptr<WebContentsBinding> TakePrerendered(const GURL& url);
+  // Called when the prerendered contents is shown in the window.
+  void DidSwapIn(void);
+  // Called when the pooled contents is claimed by a window.
+  void Unpool(void);
   void DownloadURL(const GURL& url);
   GURL GetURL() const;
   base::string16 GetTitle() const;
   bool IsLoading() const;
   bool IsLoadingMainFrame() const;
   bool IsWaitingForResponse() const;
+  // {url, title, loading, loadingMainFrame, waitingForResponse, crashed, audioMuted, discarded}
+  std::unique_ptr<base::DictionaryValue> CreateStateValue();
   void Stop();
   void GoBack();
   void GoForward();
@@ -90,7 +116,8 @@ class WebContentsBinding : public APIBindingT<WebContentsBinding, WebContentsCla
   void Unselect();
   void Replace(const base::string16& word);
   void ReplaceMisspelling(const base::string16& word);
-  size_t FindInPage(base::ListValue* args);
+  // |stream| sends the intermediate replies as "find-in-page-update" batches.
+  void Find(int request_id, const base::string16& search_text, const blink::WebFindOptions& options, bool stream, int batch_interval);
   void StopFindInPage(content::StopFindAction action);
   void ShowDefinitionForSelection();
   void CopyImageAt(int x, int y);
@@ -104,23 +131,12 @@ class WebContentsBinding : public APIBindingT<WebContentsBinding, WebContentsCla
   // Send WebInputEvent to the page.
   void SendInputEvent(v8::Isolate* isolate, v8::Local<v8::Value> input_event);
 #endif
-  // Subscribe to the frame updates.
-  void BeginFrameSubscription(base::ListValue* args);
-  void EndFrameSubscription();
   // Dragging native items.
   void StartDrag(const base::DictionaryValue& item, base::ListValue* args);
-  // Captures the page with |rect|, |callback| would be called when capturing is done.
-  void CapturePage(base::ListValue* args);
   bool IsGuest(void) const { return type_ == WEB_VIEW; }
+  int GetGuestInstanceID(void) const { return guest_instance_id_; }
   void SetSize(const SetSizeParams& params);
   bool IsOffscreen(void) const { return type_ == OFF_SCREEN; }
-  void OnPaint(const gfx::Rect& dirty_rect, const SkBitmap& bitmap);
-  void StartPainting();
-  void StopPainting();
-  bool IsPainting() const;
-  void SetFrameRate(int frame_rate);
-  int GetFrameRate() const;
-  void Invalidate();
 
   content::WebContents* HostWebContents();
 
@@ -128,10 +144,12 @@ class WebContentsBinding : public APIBindingT<WebContentsBinding, WebContentsCla
     return embedder_.get();
   }
   void SetEmbedder(void);
+  void AttachToEmbedder(WebContentsBinding* embedder);
   WebViewGuestDelegate* GetGuestDelegate() { return guest_delegate_.get(); };
 
  public:
-  void WebViewEmit(const std::string& type, const base::DictionaryValue& params);
+  // Returns the size of the message sent to the embedder, 0 if none.
+  size_t WebViewEmit(const std::string& type, const base::DictionaryValue& params);
 
  protected:
   // Create window with the given disposition.
@@ -142,6 +160,7 @@ class WebContentsBinding : public APIBindingT<WebContentsBinding, WebContentsCla
  protected:
   // content::WebContentsDelegate:
   bool DidAddMessageToConsole(content::WebContents* source, int32_t level, const base::string16& message, int32_t line_no, const base::string16& source_id) override;
+  void NavigationStateChanged(content::WebContents* source, content::InvalidateTypes changed_flags) override;
   void WebContentsCreated(content::WebContents* source_contents, int opener_process_id, int opener_render_frame_id, const std::string& frame_name, const GURL& target_url, content::WebContents* new_contents) override;
   void AddNewContents(content::WebContents* source, content::WebContents* new_contents, WindowOpenDisposition disposition, const gfx::Rect& initial_rect, bool user_gesture, bool* was_blocked) override;
   content::WebContents* OpenURLFromTab(content::WebContents* source, const content::OpenURLParams& params) override;
@@ -166,13 +185,16 @@ class WebContentsBinding : public APIBindingT<WebContentsBinding, WebContentsCla
 
   // content::WebContentsObserver:
   void BeforeUnloadFired(const base::TimeTicks& proceed_time) override;
+  void RenderViewCreated(content::RenderViewHost*) override;
   void RenderViewDeleted(content::RenderViewHost*) override;
+  void RenderViewHostChanged(content::RenderViewHost* old_host, content::RenderViewHost* new_host) override;
   void RenderProcessGone(base::TerminationStatus status) override;
   void DocumentLoadedInFrame(content::RenderFrameHost* render_frame_host) override;
   void DidFinishLoad(content::RenderFrameHost* render_frame_host, const GURL& validated_url) override;
   void DidFailLoad(content::RenderFrameHost* render_frame_host, const GURL& validated_url, int error_code, const base::string16& error_description, bool was_ignored_by_handler) override;
   void DidStartLoading() override;
   void DidStopLoading() override;
+  void DidFirstVisuallyNonEmptyPaint() override;
   void DidGetResourceResponseStart(const content::ResourceRequestDetails& details) override;
   void DidGetRedirectForResourceRequest(const content::ResourceRedirectDetails& details) override;
   void DidFinishNavigation(content::NavigationHandle* navigation_handle) override;
@@ -185,6 +207,22 @@ class WebContentsBinding : public APIBindingT<WebContentsBinding, WebContentsCla
   void MediaStartedPlaying(const MediaPlayerInfo& video_type, const MediaPlayerId& id) override;
   void MediaStoppedPlaying(const MediaPlayerInfo& video_type, const MediaPlayerId& id) override;
   void DidChangeThemeColor(SkColor theme_color) override;
+  void WasShown() override;
+  void WasHidden() override;
+
+  // BackgroundThrottlingPolicy::Client:
+  int GetThrottlingClientID(void) const override;
+  content::RenderProcessHost* GetThrottlingProcess(void) const override;
+  bool AllowsThrottling(void) const override;
+  bool IsThrottlingHidden(void) const override;
+  void ApplyThrottling(BackgroundThrottlingPolicy::State state, const BackgroundThrottlingPolicy::Options& options) override;
+  void OnThrottlingStateChanged(BackgroundThrottlingPolicy::State from, BackgroundThrottlingPolicy::State to, const std::string& reason) override;
+
+  // ContentsDiscarder::Client:
+  int GetDiscardClientID(void) const override;
+  content::WebContents* GetDiscardWebContents(void) const override;
+  bool CanDiscard(void) const override;
+  void OnDiscardStateChanged(bool discarded, const std::string& reason) override;
 
   // brightray::InspectableWebContentsDelegate:
   void DevToolsReloadPage() override;
@@ -203,9 +241,68 @@ class WebContentsBinding : public APIBindingT<WebContentsBinding, WebContentsCla
   void OnRendererMessage(const base::string16& channel, const base::ListValue& args);
   // Called when received a synchronous message from renderer.
   void OnRendererMessageSync(const base::string16& channel, const base::ListValue& args, IPC::Message* message);
+  // Called when received a shared memory buffer from renderer.
+  void OnRemoteSendBuffer(const base::SharedMemoryHandle& handle, uint32_t size, const base::DictionaryValue& message);
   void WebContentsDestroyedCore(bool destuctor);
+  // Routes the frames of the view to a new ring buffer, and |event_name| events.
+  bool SubscribeFrames(content::RenderWidgetHostView* view, bool only_dirty, int slots, const gfx::Size& size, const std::string& event_name);
+  void UnsubscribeFrames(void);
+  // Subscribes |view| to the current ring buffer.
+  void AttachFrameSubscriber(content::RenderWidgetHostView* view);
+  // Called when a subscribed frame is written to the ring buffer |ring_id|.
+  void OnFrameWritten(unsigned int ring_id, const std::string& event_name, unsigned int sequence, const gfx::Rect& dirty_rect, const gfx::Size& frame_size);
+  // Called when the backing store of CapturePage() is read back.
+  void OnCapturePageReadback(int request_id, CaptureFormat format, int quality, const SkBitmap& bitmap, content::ReadbackResponse response);
+  void OnFindResults(std::unique_ptr<base::DictionaryValue> batch);
+  void OnNetworkActivityFlush(std::unique_ptr<base::ListValue> schema, std::unique_ptr<base::ListValue> records);
+  // Emits the fields of the state changed since the last "state-changed".
+  void ScheduleStateChanged(void);
+  void EmitStateChanged(void);
+  BackgroundThrottlingPolicy* GetBackgroundThrottlingPolicy() const;
+  ContentsDiscarder* GetContentsDiscarder() const;
+  // Hidden widgets of throttled contents tell the renderer they are hidden.
+  void UpdateDisableHidden(const BackgroundThrottlingPolicy::Options& options);
+  // Offscreen contents have no window to size and show their view.
+  void SetupOffscreenView(content::RenderWidgetHostView* view);
 
  public:  // Local Methods
+  // Subscribe to the frame updates.
+  api::MethodResult BeginFrameSubscription(const api::APIArgs& args);
+  api::MethodResult EndFrameSubscription(const api::APIArgs& args);
+  // Offscreen rendering, the dirty rects are emitted with "paint" events.
+  // This is not a windowless renderer: the contents still composites through
+  // the platform view (detached from any window), and the frames are read
+  // back from it.
+  api::MethodResult StartPainting(const api::APIArgs& args);
+  api::MethodResult StopPainting(const api::APIArgs& args);
+  api::MethodResult IsPainting(const api::APIArgs& args);
+  api::MethodResult SetFrameRate(const api::APIArgs& args);
+  api::MethodResult GetFrameRate(const api::APIArgs& args);
+  api::MethodResult Invalidate(const api::APIArgs& args);
+  // Batched "network-activity" events instead of one event per resource.
+  api::MethodResult SetNetworkActivityOptions(const api::APIArgs& args);
+  api::MethodResult GetNetworkActivityStatistics(const api::APIArgs& args);
+  // Console messages kept in a ring buffer.
+  api::MethodResult GetConsoleMessages(const api::APIArgs& args);
+  api::MethodResult SetConsoleCaptureOptions(const api::APIArgs& args);
+  // Navigation state in one call, see also the "state-changed" event.
+  api::MethodResult GetState(const api::APIArgs& args);
+  // Kills the renderer of a hidden contents, it is reloaded when shown again.
+  api::MethodResult Discard(const api::APIArgs& args);
+  api::MethodResult Undiscard(const api::APIArgs& args);
+  // Warms up likely navigations, see the "did-finish-load" event.
+  api::MethodResult Prefetch(const api::APIArgs& args);
+  api::MethodResult Preconnect(const api::APIArgs& args);
+  api::MethodResult Prerender(const api::APIArgs& args);
+  api::MethodResult CancelPrerender(const api::APIArgs& args);
+  api::MethodResult GetNavigationPredictorStatistics(const api::APIArgs& args);
+  // Find in page, returns the request id.
+  api::MethodResult FindInPage(const api::APIArgs& args);
+  api::MethodResult StopFinding(const api::APIArgs& args);
+  api::MethodResult GetFindStatistics(const api::APIArgs& args);
+  // Captures the page asynchronously, see the "capture-page" event.
+  api::MethodResult CapturePage(const api::APIArgs& args);
+
  private:
   scoped_refptr<WebContentsBinding> devtools_web_contents_;
   base::WeakPtr<WebContentsBinding> embedder_;
@@ -216,6 +313,37 @@ class WebContentsBinding : public APIBindingT<WebContentsBinding, WebContentsCla
   scoped_refptr<SessionBinding> session_;
   std::unique_ptr<WebViewGuestDelegate> guest_delegate_;
   int guest_instance_id_;
+  scoped_refptr<FrameRingBuffer> frame_ring_;
+  base::WeakPtr<FrameSubscriber> frame_subscriber_;
+  // moved to the new view with the ring buffer on a cross-process navigation.
+  bool frame_only_dirty_;
+  std::string frame_event_name_;
+  std::unique_ptr<NetworkActivityStream> network_activity_;
+  std::unique_ptr<ConsoleMessageBuffer> console_messages_;
+  std::unique_ptr<FindResultStream> find_results_;
+  int find_request_id_;
+  // navigation warm up
+  scoped_refptr<WebContentsBinding> prerendered_;
+  GURL prerendered_url_;
+  base::TimeTicks load_start_time_;
+  base::TimeDelta last_load_time_;
+  bool load_finished_;
+  bool swapped_in_;
+  base::TimeDelta time_saved_;
+  bool prefetched_navigation_;
+  bool preconnected_navigation_;
+  std::unique_ptr<base::DictionaryValue> notified_state_;
+  bool state_change_scheduled_;
+  // offscreen rendering
+  gfx::Size offscreen_size_;
+  bool painting_;
+  int frame_rate_;
+  // the renderer is suspended by the background throttling policy.
+  bool throttling_frozen_;
+  // the renderer was killed by the contents discarder.
+  bool discarded_;
+  // waiting in the window pool, neither throttled nor discarded until claimed.
+  bool pooled_;
   DISALLOW_COPY_AND_ASSIGN(WebContentsBinding);
 };
 
@@ -229,6 +357,8 @@ class WebContentsClassBinding : public APIClassBindingT<WebContentsBinding, WebC
 
  public:  // static methods
   api::MethodResult CreateInstance(const api::APIArgs& args);
+  // args: ([id]), the states in the same order, null for unknown ids.
+  api::MethodResult GetStates(const api::APIArgs& args);
 
  private:
   DISALLOW_COPY_AND_ASSIGN(WebContentsClassBinding);
@@ -1,13 +1,19 @@
 #include "api/window_binding.h"
 #include "api/web_contents_binding.h"
 #include "browser/session/meson_browser_context.h"
+#include "browser/browser.h"
 #include "browser/browser_client.h"
 #include "browser/native_window.h"
 #include "common/options_switches.h"
 #include "base/threading/thread_task_runner_handle.h"
+#include "content/public/browser/render_process_host.h"
+#include "content/public/browser/web_contents.h"
 #include "api/session_binding.h"
 #include "api/web_contents_binding.h"
 #include "api/api.h"
+#if defined(OS_MACOSX)
+#include "ui/gfx/mac/scoped_ns_disable_screen_updates.h"
+#endif
 
 namespace meson {
 template <>
@@ -18,42 +24,74 @@ const APIBindingT<WindowBinding, WindowClassBinding>::MethodTable APIBindingT<Wi
     {"openDevTools", std::mem_fn(&WindowBinding::OpenDevTools)},
     {"closeDevTools", std::mem_fn(&WindowBinding::CloseDevTools)},
     {"isDevToolsOpened", std::mem_fn(&WindowBinding::IsDevToolsOpened)},
+    {"isDraggableAt", std::mem_fn(&WindowBinding::IsDraggableAt)},
+    {"getDraggableRegionStatistics", std::mem_fn(&WindowBinding::GetDraggableRegionStatistics)},
+    {"getBounds", std::mem_fn(&WindowBinding::GetBounds)},
+    {"setBounds", std::mem_fn(&WindowBinding::SetBounds)},
+    {"getState", std::mem_fn(&WindowBinding::GetState)},
+    {"setEventCoalescing", std::mem_fn(&WindowBinding::SetEventCoalescing)},
+    {"setUnresponsiveWatchdog", std::mem_fn(&WindowBinding::SetUnresponsiveWatchdog)},
+    {"getUnresponsiveStatistics", std::mem_fn(&WindowBinding::GetUnresponsiveStatistics)},
 };
 
 template <>
 const APIClassBindingT<WindowBinding, WindowClassBinding>::MethodTable APIClassBindingT<WindowBinding, WindowClassBinding>::staticMethodTable = {
     {"_create", std::mem_fn(&WindowClassBinding::CreateInstance)},
+    {"getBounds", std::mem_fn(&WindowClassBinding::GetBounds)},
+    {"setBounds", std::mem_fn(&WindowClassBinding::SetBounds)},
+    {"getStates", std::mem_fn(&WindowClassBinding::GetStates)},
+    {"setPool", std::mem_fn(&WindowClassBinding::SetPool)},
+    {"getPoolStatistics", std::mem_fn(&WindowClassBinding::GetPoolStatistics)},
 };
 
 MESON_IMPLEMENT_API_CLASS(WindowBinding, WindowClassBinding);
 
+namespace {
+// a frame at 60Hz.
+const int kDefaultEventInterval = 16;
+
+// the preferences of the web contents of a window created with |args|.
+std::unique_ptr<base::DictionaryValue> CreateWebPreferences(const base::DictionaryValue& args) {
+  std::unique_ptr<base::DictionaryValue> newWebPreference;
+  const base::DictionaryValue* pPreference;
+  if (args.GetDictionary(options::kWebPreferences, &pPreference)) {
+    newWebPreference.reset(pPreference->DeepCopy());
+  } else {
+    newWebPreference.reset(new base::DictionaryValue());
+  }
+
+  std::string backgroundColor;
+  if (args.GetString(options::kBackgroundColor, &backgroundColor)) {
+    newWebPreference->SetString(switches::kBackgroundColor, backgroundColor);
+  }
+  bool transparent = false;
+  if (args.GetBoolean(options::kTransparent, &transparent)) {
+    newWebPreference->SetBoolean("transparent", transparent);
+  }
+  return newWebPreference;
+}
+}
+
 // TODO: インスタンス生成と初期化を分割するか、エラー時に例外をスローする
 WindowBinding::WindowBinding(unsigned int id, const base::DictionaryValue& args)
-    : APIBindingT(MESON_OBJECT_TYPE_WINDOW, id) {
+    : APIBindingT(MESON_OBJECT_TYPE_WINDOW, id),
+      coalesce_events_(true),
+      event_interval_(base::TimeDelta::FromMilliseconds(kDefaultEventInterval)),
+      created_(base::TimeTicks::Now()),
+      pooled_(false),
+      ready_to_show_(false) {
   DLOG(INFO) << "Meson Window construct [" << this << "] " << id_;
 
   int web_contents_id = -1;
   if (args.GetInteger("web_contents_id", &web_contents_id)) {
     web_contents_ = WebContentsBinding::Class().GetBinding(web_contents_id);
   } else {
-    std::unique_ptr<base::DictionaryValue> newWebPreference;
-    const base::DictionaryValue* pPreference;
-    if (args.GetDictionary(options::kWebPreferences, &pPreference)) {
-      newWebPreference.reset(pPreference->DeepCopy());
-    } else {
-      newWebPreference.reset(new base::DictionaryValue());
-    }
-
-    std::string backgroundColor;
-    if (args.GetString(options::kBackgroundColor, &backgroundColor)) {
-      newWebPreference->SetString(switches::kBackgroundColor, backgroundColor);
+    std::unique_ptr<base::DictionaryValue> newWebPreference = CreateWebPreferences(args);
+    web_contents_ = static_cast<WindowClassBinding&>(Class()).TakePooledWebContents(*newWebPreference);
+    pooled_ = !!web_contents_;
+    if (!web_contents_) {
+      web_contents_ = static_cast<WebContentsClassBinding&>(WebContentsBinding::Class()).NewInstance(*newWebPreference);
     }
-    bool transparent = false;
-    if (args.GetBoolean(options::kTransparent, &transparent)) {
-      newWebPreference->SetBoolean("transparent", transparent);
-    }
-
-    web_contents_ = static_cast<WebContentsClassBinding&>(WebContentsBinding::Class()).NewInstance(*newWebPreference);
   }
 
   // Keep a copy of the options for later use.
@@ -121,6 +159,8 @@ void windowFinalizer(scoped_refptr<WindowBinding> self) {
 
 void WindowBinding::OnWindowClosed() {
   LOG(INFO) << __PRETTY_FUNCTION__;
+  resize_event_.timer.Stop();
+  move_event_.timer.Stop();
   web_contents_->DestroyWebContents();
 
   //RemoveFromWeakMap();
@@ -159,6 +199,10 @@ void WindowBinding::OnWindowHide() {
 }
 
 void WindowBinding::OnReadyToShow() {
+  if (!ready_to_show_) {
+    ready_to_show_ = true;
+    static_cast<WindowClassBinding&>(Class()).RecordReadyToShow(pooled_, base::TimeTicks::Now() - created_);
+  }
   EmitEvent("ready-to-show");
 }
 
@@ -179,15 +223,54 @@ void WindowBinding::OnWindowRestore() {
 }
 
 void WindowBinding::OnWindowResize() {
-  EmitEvent("resize");
+  NotifyBoundsEvent("resize", &resize_event_);
 }
 
 void WindowBinding::OnWindowMove() {
-  EmitEvent("move");
+  NotifyBoundsEvent("move", &move_event_);
 }
 
 void WindowBinding::OnWindowMoved() {
-  EmitEvent("moved");
+  // the last "move" comes first.
+  if (move_event_.pending > 0) {
+    move_event_.timer.Stop();
+    FlushBoundsEvent("move", &move_event_);
+  }
+  EmitEvent("moved", "bounds", window_->GetBounds());
+}
+
+void WindowBinding::NotifyBoundsEvent(const std::string& name, CoalescedEvent* event) {
+  if (!coalesce_events_) {
+    EmitBoundsEvent(name, 0);
+    return;
+  }
+  if (event->timer.IsRunning()) {
+    event->pending++;
+    return;
+  }
+  // the first one of a drag is not delayed.
+  EmitBoundsEvent(name, 0);
+  event->timer.Start(FROM_HERE, event_interval_, base::Bind(&WindowBinding::FlushBoundsEvent, base::Unretained(this), name, event));
+}
+
+void WindowBinding::FlushBoundsEvent(const std::string& name, CoalescedEvent* event) {
+  if (event->pending == 0) {
+    return;
+  }
+  // all the pending ones are reported by this event.
+  int coalesced = event->pending;
+  event->pending = 0;
+  EmitBoundsEvent(name, coalesced);
+  // still moving, the next ones wait for the next interval.
+  event->timer.Start(FROM_HERE, event_interval_, base::Bind(&WindowBinding::FlushBoundsEvent, base::Unretained(this), name, event));
+}
+
+void WindowBinding::EmitBoundsEvent(const std::string& name, int coalesced) {
+  // the bounds are sent with the event, there is no need to ask for them.
+  EmitEvent(name,
+            "bounds", window_->GetBounds(),
+            "contentBounds", window_->GetContentBounds(),
+            "coalesced", coalesced);
 }
 
 void WindowBinding::OnWindowEnterFullScreen() {
@@ -222,8 +305,17 @@ void WindowBinding::OnWindowLeaveHtmlFullScreen() {
   EmitEvent("leave-html-full-screen");
 }
 
-void WindowBinding::OnRendererUnresponsive() {
-  EmitEvent("unresponsive");
+// details: {stage, source, elapsed, baseline, deviation, threshold, stack}
+void WindowBinding::OnRendererHangWarning(const base::DictionaryValue& details) {
+  EmitEvent("unresponsive-warning", details.CreateDeepCopy());
+}
+
+void WindowBinding::OnRendererUnresponsive(const base::DictionaryValue& details) {
+  EmitEvent("unresponsive", details.CreateDeepCopy());
+}
+
+void WindowBinding::OnRendererKilled(const base::DictionaryValue& details) {
+  EmitEvent("renderer-killed", details.CreateDeepCopy());
 }
 
 void WindowBinding::OnRendererResponsive() {
@@ -254,10 +346,32 @@ api::MethodResult WindowBinding::LoadURL(const api::APIArgs& args) {
   if (!args.GetDictionary(1, &opt)) {
     opt = &dummy;
   }
+#if defined(OS_MACOSX)
+  // NativeWindowMac::SetInspectableWebContents moves the view to the window.
+  auto prerendered = web_contents_->TakePrerendered(GURL(url));
+  if (prerendered) {
+    SwapWebContents(prerendered);
+    return api::MethodResult();
+  }
+#endif
   web_contents_->LoadURL(GURL(url), *opt);
   return api::MethodResult();
 }
 
+void WindowBinding::SwapWebContents(scoped_refptr<WebContentsBinding> web_contents) {
+  LOG(INFO) << __PRETTY_FUNCTION__ << " : " << web_contents_->GetID() << " -> " << web_contents->GetID();
+  scoped_refptr<WebContentsBinding> previous = web_contents_;
+  web_contents_ = web_contents;
+  window_->SetInspectableWebContents(web_contents_->managed_web_contents());
+  web_contents_->SetOwnerWindow(window_.get());
+  EmitEvent("web-contents-swapped",
+            "webContentsId", static_cast<int>(web_contents_->GetID()),
+            "previousWebContentsId", static_cast<int>(previous->GetID()));
+  web_contents_->DidSwapIn();
+  // the window does not show the previous page any more.
+  previous->DestroyWebContents();
+}
+
 api::MethodResult WindowBinding::Close(const api::APIArgs& args) {
   DCHECK(0 == args.GetSize());
   window_->Close();
@@ -289,14 +403,184 @@ api::MethodResult WindowBinding::IsDevToolsOpened(const api::APIArgs& args) {
   return api::MethodResult(std::move(ret));
 }
 
+// args: (x, y) in the content view.
+api::MethodResult WindowBinding::IsDraggableAt(const api::APIArgs& args) {
+  int x, y;
+  if (!args.GetInteger(0, &x) || !args.GetInteger(1, &y)) {
+    return api::MethodResult("invalid argument");
+  }
+  bool f = window_->IsDraggableAt(gfx::Point(x, y));
+  std::unique_ptr<base::Value> ret(new base::FundamentalValue(f));
+  return api::MethodResult(std::move(ret));
+}
+
+api::MethodResult WindowBinding::GetDraggableRegionStatistics(const api::APIArgs& args) {
+  return api::MethodResult(window_->draggable_region_index().GetStatistics());
+}
+
 bool WindowBinding::IsFocused() const {
   return window_->IsFocused();
 }
 
+std::unique_ptr<base::DictionaryValue> WindowBinding::CreateBoundsValue(bool content) {
+  gfx::Rect bounds = content ? window_->GetContentBounds() : window_->GetBounds();
+  std::unique_ptr<base::DictionaryValue> value(new base::DictionaryValue());
+  value->SetInteger("x", bounds.x());
+  value->SetInteger("y", bounds.y());
+  value->SetInteger("width", bounds.width());
+  value->SetInteger("height", bounds.height());
+  return value;
+}
+
+std::unique_ptr<base::DictionaryValue> WindowBinding::CreateStateValue() {
+  std::unique_ptr<base::DictionaryValue> state(new base::DictionaryValue());
+  state->SetInteger("id", GetID());
+  state->Set("bounds", CreateBoundsValue(false));
+  state->Set("contentBounds", CreateBoundsValue(true));
+  internal::ToArg(*state, "minimumSize", window_->GetMinimumSize());
+  internal::ToArg(*state, "maximumSize", window_->GetMaximumSize());
+  state->SetString("title", window_->GetTitle());
+  state->SetBoolean("visible", window_->IsVisible());
+  state->SetBoolean("focused", window_->IsFocused());
+  state->SetBoolean("minimized", window_->IsMinimized());
+  state->SetBoolean("maximized", window_->IsMaximized());
+  state->SetBoolean("fullscreen", window_->IsFullscreen());
+  state->SetBoolean("kiosk", window_->IsKiosk());
+  state->SetBoolean("resizable", window_->IsResizable());
+  state->SetBoolean("movable", window_->IsMovable());
+  state->SetBoolean("minimizable", window_->IsMinimizable());
+  state->SetBoolean("maximizable", window_->IsMaximizable());
+  state->SetBoolean("closable", window_->IsClosable());
+  state->SetBoolean("alwaysOnTop", window_->IsAlwaysOnTop());
+  state->SetBoolean("visibleOnAllWorkspaces", window_->IsVisibleOnAllWorkspaces());
+  if (web_contents_) {
+    state->SetInteger("webContentsId", web_contents_->GetID());
+  }
+  return state;
+}
+
+bool WindowBinding::ApplyBounds(const base::DictionaryValue& options) {
+  bool content = false;
+  bool animate = false;
+  options.GetBoolean("content", &content);
+  options.GetBoolean("animate", &animate);
+  gfx::Rect bounds = content ? window_->GetContentBounds() : window_->GetBounds();
+  int v;
+  if (options.GetInteger("x", &v))
+    bounds.set_x(v);
+  if (options.GetInteger("y", &v))
+    bounds.set_y(v);
+  if (options.GetInteger("width", &v))
+    bounds.set_width(v);
+  if (options.GetInteger("height", &v))
+    bounds.set_height(v);
+  if (bounds.width() <= 0 || bounds.height() <= 0) {
+    return false;
+  }
+  // size and position together, the contents are laid out once.
+  if (content) {
+    window_->SetContentBounds(bounds, animate);
+  } else {
+    window_->SetBounds(bounds, animate);
+  }
+  return true;
+}
+
+// args: ({content})
+api::MethodResult WindowBinding::GetBounds(const api::APIArgs& args) {
+  if (window_->IsClosed()) {
+    return api::MethodResult("window closed");
+  }
+  bool content = false;
+  const base::DictionaryValue* opt = nullptr;
+  if (args.GetDictionary(0, &opt)) {
+    opt->GetBoolean("content", &content);
+  }
+  return api::MethodResult(CreateBoundsValue(content));
+}
+
+// args: ({x, y, width, height, content, animate})
+api::MethodResult WindowBinding::SetBounds(const api::APIArgs& args) {
+  if (window_->IsClosed()) {
+    return api::MethodResult("window closed");
+  }
+  const base::DictionaryValue* opt = nullptr;
+  if (!args.GetDictionary(0, &opt) || !ApplyBounds(*opt)) {
+    return api::MethodResult("invalid argument");
+  }
+  return api::MethodResult();
+}
+
+api::MethodResult WindowBinding::GetState(const api::APIArgs& args) {
+  if (window_->IsClosed()) {
+    return api::MethodResult("window closed");
+  }
+  return api::MethodResult(CreateStateValue());
+}
+
+// args: ({enabled, interval})
+// interval in milliseconds, "coalesced" of the events tells how many were merged.
+api::MethodResult WindowBinding::SetEventCoalescing(const api::APIArgs& args) {
+  const base::DictionaryValue* opt = nullptr;
+  if (!args.GetDictionary(0, &opt)) {
+    return api::MethodResult("invalid argument");
+  }
+  bool enabled = coalesce_events_;
+  int interval = static_cast<int>(event_interval_.InMilliseconds());
+  opt->GetBoolean("enabled", &enabled);
+  opt->GetInteger("interval", &interval);
+  if (interval <= 0) {
+    return api::MethodResult("invalid argument");
+  }
+  coalesce_events_ = enabled;
+  event_interval_ = base::TimeDelta::FromMilliseconds(interval);
+  if (!coalesce_events_) {
+    // the pending events are sent now.
+    FlushBoundsEvent("resize", &resize_event_);
+    FlushBoundsEvent("move", &move_event_);
+    resize_event_.timer.Stop();
+    move_event_.timer.Stop();
+  }
+  return api::MethodResult();
+}
+
+// args: ({enabled, interval, warnAfter, unresponsiveAfter, killAfter, deviations, stackTimeout})
+// in milliseconds, killAfter: 0 never kills.
+api::MethodResult WindowBinding::SetUnresponsiveWatchdog(const api::APIArgs& args) {
+  const base::DictionaryValue* opt = nullptr;
+  if (!args.GetDictionary(0, &opt)) {
+    return api::MethodResult("invalid argument");
+  }
+  if (!window_->unresponsive_watchdog()->Configure(*opt)) {
+    return api::MethodResult("invalid argument");
+  }
+  return api::MethodResult();
+}
+
+api::MethodResult WindowBinding::GetUnresponsiveStatistics(const api::APIArgs& args) {
+  return api::MethodResult(window_->unresponsive_watchdog()->GetStatistics());
+}
+
+WindowClassBinding::Pool::Pool()
+    : size(0),
+      fill_scheduled(false),
+      hits(0),
+      misses(0) {
+}
+
+WindowClassBinding::Pool::~Pool() {
+}
+
 WindowClassBinding::WindowClassBinding(void)
-    : APIClassBindingT(MESON_OBJECT_TYPE_WINDOW) {}
+    : APIClassBindingT(MESON_OBJECT_TYPE_WINDOW),
+      quitting_(false),
+      unpooled_(0),
+      weak_factory_(this) {
+  Browser::Get()->AddObserver(this);
+}
 
 WindowClassBinding::~WindowClassBinding(void) {
+  Browser::Get()->RemoveObserver(this);
 }
 
 api::MethodResult WindowClassBinding::CreateInstance(const api::APIArgs& args) {
@@ -309,4 +593,240 @@ api::MethodResult WindowClassBinding::CreateInstance(const api::APIArgs& args) {
   SetBinding(id, ret);
   return api::MethodResult(ret);
 }
+
+// args: ([id...], {content})
+// null for the windows which are not found.
+api::MethodResult WindowClassBinding::GetBounds(const api::APIArgs& args) {
+  const base::ListValue* ids = nullptr;
+  if (!args.GetList(0, &ids)) {
+    return api::MethodResult("invalid argument");
+  }
+  bool content = false;
+  const base::DictionaryValue* opt = nullptr;
+  if (args.GetDictionary(1, &opt)) {
+    opt->GetBoolean("content", &content);
+  }
+  std::unique_ptr<base::ListValue> list(new base::ListValue());
+  for (size_t i = 0; i < ids->GetSize(); i++) {
+    int id = 0;
+    scoped_refptr<WindowBinding> binding;
+    if (ids->GetInteger(i, &id)) {
+      binding = GetBinding(id);
+    }
+    if (binding && !binding->window()->IsClosed()) {
+      list->Append(binding->CreateBoundsValue(content));
+    } else {
+      list->Append(base::Value::CreateNullValue());
+    }
+  }
+  return api::MethodResult(std::move(list));
+}
+
+// args: ([{id, x, y, width, height, content, animate}...])
+// all the windows are moved in this task, and drawn once at their new bounds.
+// returns whether each entry was applied.
+api::MethodResult WindowClassBinding::SetBounds(const api::APIArgs& args) {
+  const base::ListValue* entries = nullptr;
+  if (!args.GetList(0, &entries)) {
+    return api::MethodResult("invalid argument");
+  }
+  std::unique_ptr<base::ListValue> applied(new base::ListValue());
+#if defined(OS_MACOSX)
+  gfx::ScopedNSDisableScreenUpdates disable_screen_updates;
+#endif
+  for (size_t i = 0; i < entries->GetSize(); i++) {
+    const base::DictionaryValue* entry = nullptr;
+    int id = 0;
+    scoped_refptr<WindowBinding> binding;
+    if (entries->GetDictionary(i, &entry) && entry->GetInteger("id", &id)) {
+      binding = GetBinding(id);
+    }
+    bool ok = binding && !binding->window()->IsClosed() && binding->ApplyBounds(*entry);
+    applied->AppendBoolean(ok);
+  }
+  return api::MethodResult(std::move(applied));
+}
+
+// args: ([id...])
+api::MethodResult WindowClassBinding::GetStates(const api::APIArgs& args) {
+  const base::ListValue* ids = nullptr;
+  if (!args.GetList(0, &ids)) {
+    return api::MethodResult("invalid argument");
+  }
+  std::unique_ptr<base::ListValue> states(new base::ListValue());
+  for (size_t i = 0; i < ids->GetSize(); i++) {
+    int id = 0;
+    scoped_refptr<WindowBinding> binding;
+    if (ids->GetInteger(i, &id)) {
+      binding = GetBinding(id);
+    }
+    if (binding && !binding->window()->IsClosed()) {
+      states->Append(binding->CreateStateValue());
+    } else {
+      states->Append(base::Value::CreateNullValue());
+    }
+  }
+  return api::MethodResult(std::move(states));
+}
+
+// args: ({size, webPreferences, backgroundColor, transparent})
+// keeps |size| web contents for the windows created with the same web
+// preferences (as _create takes them), 0 empties the pool.
+api::MethodResult WindowClassBinding::SetPool(const api::APIArgs& args) {
+  const base::DictionaryValue* opt = nullptr;
+  int size = 0;
+  if (!args.GetDictionary(0, &opt) || !opt->GetInteger("size", &size) || size < 0) {
+    return api::MethodResult("invalid argument");
+  }
+  if (quitting_ && size > 0) {
+    return api::MethodResult("quitting");
+  }
+  std::unique_ptr<base::DictionaryValue> web_preferences = CreateWebPreferences(*opt);
+  Pool* pool = FindPool(*web_preferences);
+  if (!pool) {
+    pools_.push_back(std::unique_ptr<Pool>(new Pool()));
+    pool = pools_.back().get();
+    pool->web_preferences = std::move(web_preferences);
+  }
+  pool->size = size;
+  if (size == 0) {
+    // the statistics are kept.
+    ClearPool(pool);
+    return api::MethodResult();
+  }
+  while (static_cast<int>(pool->web_contents.size()) > pool->size) {
+    auto web_contents = pool->web_contents.back();
+    pool->web_contents.pop_back();
+    WebContentsBinding::Class().RemoveBinding(web_contents.get());
+  }
+  SchedulePoolFill(pool);
+  return api::MethodResult();
+}
+
+api::MethodResult WindowClassBinding::GetPoolStatistics(const api::APIArgs& args) {
+  std::unique_ptr<base::DictionaryValue> result(new base::DictionaryValue());
+  int hits = 0;
+  int misses = 0;
+  std::unique_ptr<base::ListValue> pools(new base::ListValue());
+  for (const auto& pool : pools_) {
+    std::unique_ptr<base::DictionaryValue> stat(new base::DictionaryValue());
+    stat->Set("webPreferences", pool->web_preferences->CreateDeepCopy());
+    stat->SetInteger("size", pool->size);
+    stat->SetInteger("ready", static_cast<int>(pool->web_contents.size()));
+    stat->SetInteger("hits", pool->hits);
+    stat->SetInteger("misses", pool->misses);
+    pools->Append(std::move(stat));
+    hits += pool->hits;
+    misses += pool->misses;
+  }
+  result->SetInteger("hits", hits);
+  result->SetInteger("misses", misses);
+  // created with web preferences no pool has.
+  result->SetInteger("unpooled", unpooled_);
+  result->SetDouble("hitRate", hits + misses ? static_cast<double>(hits) / (hits + misses) : 0.0);
+  result->Set("pools", std::move(pools));
+  // average milliseconds from _create to "ready-to-show".
+  std::unique_ptr<base::DictionaryValue> ready_to_show(new base::DictionaryValue());
+  const char* const kKinds[] = {"unpooled", "pooled"};
+  for (int i = 0; i < 2; ++i) {
+    std::unique_ptr<base::DictionaryValue> stat(new base::DictionaryValue());
+    const ReadyToShow& ready = ready_to_show_[i];
+    stat->SetInteger("count", ready.count);
+    stat->SetDouble("average", ready.count ? ready.total.InMillisecondsF() / ready.count : 0.0);
+    ready_to_show->Set(kKinds[i], std::move(stat));
+  }
+  result->Set("readyToShow", std::move(ready_to_show));
+  return api::MethodResult(std::move(result));
+}
+
+scoped_refptr<WebContentsBinding> WindowClassBinding::TakePooledWebContents(const base::DictionaryValue& web_preferences) {
+  Pool* pool = FindPool(web_preferences);
+  if (!pool) {
+    unpooled_++;
+    return nullptr;
+  }
+  scoped_refptr<WebContentsBinding> web_contents;
+  while (!pool->web_contents.empty() && !web_contents) {
+    web_contents = pool->web_contents.front();
+    pool->web_contents.pop_front();
+    // drop the ones whose renderer died while waiting in the pool.
+    if (!WebContentsBinding::Class().GetBinding(web_contents->GetID()) || web_contents->web_contents()->IsCrashed()) {
+      WebContentsBinding::Class().RemoveBinding(web_contents.get());
+      web_contents = nullptr;
+    }
+  }
+  if (web_contents) {
+    pool->hits++;
+    web_contents->Unpool();
+  } else {
+    pool->misses++;
+  }
+  SchedulePoolFill(pool);
+  return web_contents;
+}
+
+void WindowClassBinding::RecordReadyToShow(bool pooled, base::TimeDelta elapsed) {
+  ReadyToShow& ready = ready_to_show_[pooled ? 1 : 0];
+  ready.count++;
+  ready.total += elapsed;
+}
+
+WindowClassBinding::Pool* WindowClassBinding::FindPool(const base::DictionaryValue& web_preferences) {
+  for (auto& pool : pools_) {
+    if (pool->web_preferences->Equals(&web_preferences)) {
+      return pool.get();
+    }
+  }
+  return nullptr;
+}
+
+void WindowClassBinding::SchedulePoolFill(Pool* pool) {
+  if (pool->fill_scheduled || static_cast<int>(pool->web_contents.size()) >= pool->size) {
+    return;
+  }
+  pool->fill_scheduled = true;
+  base::ThreadTaskRunnerHandle::Get()->PostTask(FROM_HERE, base::Bind(&WindowClassBinding::FillPool, weak_factory_.GetWeakPtr(), base::Passed(pool->web_preferences->CreateDeepCopy())));
+}
+
+void WindowClassBinding::FillPool(std::unique_ptr<base::DictionaryValue> web_preferences) {
+  Pool* pool = FindPool(*web_preferences);
+  if (!pool) {
+    return;
+  }
+  pool->fill_scheduled = false;
+  if (static_cast<int>(pool->web_contents.size()) >= pool->size) {
+    return;
+  }
+  LOG(INFO) << __PRETTY_FUNCTION__ << " : " << pool->web_contents.size() << "/" << pool->size;
+  // kept out of the throttling policy and of the discarder until claimed.
+  std::unique_ptr<base::DictionaryValue> args = pool->web_preferences->CreateDeepCopy();
+  args->SetBoolean("_pooled_", true);
+  auto api = static_cast<WebContentsClassBinding&>(WebContentsBinding::Class()).NewInstance(*args);
+  api->web_contents()->WasHidden();
+  // spawn the renderer process now, so _create does not wait for it.
+  api->web_contents()->GetRenderProcessHost()->Init();
+  pool->web_contents.push_back(api);
+
+  // one per task, to keep the UI thread responsive.
+  SchedulePoolFill(pool);
+}
+
+void WindowClassBinding::OnQuit() {
+  LOG(INFO) << __PRETTY_FUNCTION__;
+  quitting_ = true;
+  // the fills already posted do nothing.
+  weak_factory_.InvalidateWeakPtrs();
+  for (auto& pool : pools_) {
+    pool->size = 0;
+    pool->fill_scheduled = false;
+    ClearPool(pool.get());
+  }
+}
+
+void WindowClassBinding::ClearPool(Pool* pool) {
+  auto web_contents = std::move(pool->web_contents);
+  for (auto& api : web_contents) {
+    WebContentsBinding::Class().RemoveBinding(api.get());
+  }
+}
 }
@@ -1,10 +1,16 @@
 //-*-c++-*-
 #pragma once
 
+#include <deque>
 #include <memory>
+#include <vector>
 #include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
 #include "base/callback.h"
+#include "base/time/time.h"
+#include "base/timer/timer.h"
 #include "api/api_binding.h"
+#include "browser/browser_observer.h"
 #include "browser/meson_window.h"
 #include "browser/native_window_observer.h"
 
@@ -27,6 +33,14 @@ class WindowBinding : public APIBindingT<WindowBinding, WindowClassBinding>, pub
   api::MethodResult OpenDevTools(const api::APIArgs& args);
   api::MethodResult CloseDevTools(const api::APIArgs& args);
   api::MethodResult IsDevToolsOpened(const api::APIArgs& args);
+  api::MethodResult IsDraggableAt(const api::APIArgs& args);
+  api::MethodResult GetDraggableRegionStatistics(const api::APIArgs& args);
+  api::MethodResult GetBounds(const api::APIArgs& args);
+  api::MethodResult SetBounds(const api::APIArgs& args);
+  api::MethodResult GetState(const api::APIArgs& args);
+  api::MethodResult SetEventCoalescing(const api::APIArgs& args);
+  api::MethodResult SetUnresponsiveWatchdog(const api::APIArgs& args);
+  api::MethodResult GetUnresponsiveStatistics(const api::APIArgs& args);
 
  public:  // static metods
  public:  // NativeWindowObserver:
@@ -53,7 +67,9 @@ class WindowBinding : public APIBindingT<WindowBinding, WindowClassBinding>, pub
   void OnWindowLeaveFullScreen() override;
   void OnWindowEnterHtmlFullScreen() override;
   void OnWindowLeaveHtmlFullScreen() override;
-  void OnRendererUnresponsive() override;
+  void OnRendererHangWarning(const base::DictionaryValue& details) override;
+  void OnRendererUnresponsive(const base::DictionaryValue& details) override;
+  void OnRendererKilled(const base::DictionaryValue& details) override;
   void OnRendererResponsive() override;
   void OnExecuteWindowsCommand(const std::string& command_name) override;
 
@@ -63,20 +79,95 @@ class WindowBinding : public APIBindingT<WindowBinding, WindowClassBinding>, pub
  public:
   NativeWindow* window() const { return window_.get(); }
   bool IsFocused() const;
+  // {x, y, width, height} of the window, or of its content view.
+  std::unique_ptr<base::DictionaryValue> CreateBoundsValue(bool content);
+  std::unique_ptr<base::DictionaryValue> CreateStateValue();
+  // options: {x, y, width, height, content, animate}, missing ones are kept.
+  bool ApplyBounds(const base::DictionaryValue& options);
+
+ private:
+  // Shows |web_contents| (a prerendered one) instead of the current contents.
+  void SwapWebContents(scoped_refptr<WebContentsBinding> web_contents);
+
+  // "resize" and "move" are emitted at most once per interval, the ones in
+  // between are merged into a trailing event with the final bounds.
+  struct CoalescedEvent {
+    base::OneShotTimer timer;
+    int pending = 0;
+  };
+  void NotifyBoundsEvent(const std::string& name, CoalescedEvent* event);
+  void FlushBoundsEvent(const std::string& name, CoalescedEvent* event);
+  void EmitBoundsEvent(const std::string& name, int coalesced);
 
  protected:
   std::unique_ptr<NativeWindow> window_;
   scoped_refptr<WebContentsBinding> web_contents_;
   scoped_refptr<WindowBinding> parent_window_;
   std::map<unsigned int, base::WeakPtr<WindowBinding>> child_windows_;
+  bool coalesce_events_;
+  base::TimeDelta event_interval_;
+  CoalescedEvent resize_event_;
+  CoalescedEvent move_event_;
+  // for the time to "ready-to-show".
+  base::TimeTicks created_;
+  bool pooled_;
+  bool ready_to_show_;
 };
 
-class WindowClassBinding : public APIClassBindingT<WindowBinding, WindowClassBinding> {
+class WindowClassBinding : public APIClassBindingT<WindowBinding, WindowClassBinding>,
+                           public BrowserObserver {
  public:
   WindowClassBinding(void);
   ~WindowClassBinding(void) override;
 
  public:
   api::MethodResult CreateInstance(const api::APIArgs& args);
+  api::MethodResult GetBounds(const api::APIArgs& args);
+  api::MethodResult SetBounds(const api::APIArgs& args);
+  api::MethodResult GetStates(const api::APIArgs& args);
+  api::MethodResult SetPool(const api::APIArgs& args);
+  api::MethodResult GetPoolStatistics(const api::APIArgs& args);
+
+ public:
+  // a web contents with its renderer spawned, null if the pool for
+  // |web_preferences| is empty (or there is none).
+  scoped_refptr<WebContentsBinding> TakePooledWebContents(const base::DictionaryValue& web_preferences);
+  void RecordReadyToShow(bool pooled, base::TimeDelta elapsed);
+
+ public:  // BrowserObserver
+  // the pooled web contents (and the sessions they hold) are released
+  // before the browser contexts are torn down.
+  void OnQuit() override;
+
+ private:
+  // Hidden web contents kept ready for the windows created with the same
+  // web preferences, so that _create does not wait for a renderer.
+  struct Pool {
+    Pool();
+    ~Pool();
+    std::unique_ptr<base::DictionaryValue> web_preferences;
+    int size;
+    bool fill_scheduled;
+    int hits;
+    int misses;
+    std::deque<scoped_refptr<WebContentsBinding>> web_contents;
+  };
+  struct ReadyToShow {
+    int count = 0;
+    base::TimeDelta total;
+  };
+  Pool* FindPool(const base::DictionaryValue& web_preferences);
+  void SchedulePoolFill(Pool* pool);
+  void FillPool(std::unique_ptr<base::DictionaryValue> web_preferences);
+  void ClearPool(Pool* pool);
+
+ private:
+  std::vector<std::unique_ptr<Pool>> pools_;
+  // no pool is filled once the browser quits.
+  bool quitting_;
+  int unpooled_;
+  // [unpooled, pooled]
+  ReadyToShow ready_to_show_[2];
+  base::WeakPtrFactory<WindowClassBinding> weak_factory_;
 };
 }
@@ -0,0 +1,278 @@
+#include "browser/background_throttling_policy.h"
+
+#include <algorithm>
+#include "base/bind.h"
+#include "base/logging.h"
+#include "base/process/process_metrics.h"
+#include "content/public/browser/browser_child_process_host.h"
+#include "content/public/browser/render_process_host.h"
+
+namespace meson {
+BackgroundThrottlingPolicy::Options::Options()
+    : enabled(true),
+      timer_tier(TIMER_STANDARD),
+      frame_rate_cap(0),
+      freeze_after(0),
+      thaw_on_activate(true) {
+}
+
+BackgroundThrottlingPolicy::Entry::Entry()
+    : state(ACTIVE),
+      hidden(false),
+      state_since(base::TimeTicks::Now()),
+      throttled_cpu_usage(0.0),
+      transitions(0),
+      freezes_skipped(0) {
+}
+
+BackgroundThrottlingPolicy::Entry::~Entry() {
+}
+
+BackgroundThrottlingPolicy::BackgroundThrottlingPolicy(void) {
+}
+
+BackgroundThrottlingPolicy::~BackgroundThrottlingPolicy(void) {
+}
+
+bool BackgroundThrottlingPolicy::Configure(const base::DictionaryValue& options) {
+  Options opt = options_;
+  std::string timer_tier;
+  options.GetBoolean("enabled", &opt.enabled);
+  if (options.GetString("timerTier", &timer_tier)) {
+    if (timer_tier == "none") {
+      opt.timer_tier = TIMER_NONE;
+    } else if (timer_tier == "standard") {
+      opt.timer_tier = TIMER_STANDARD;
+    } else {
+      return false;
+    }
+  }
+  options.GetInteger("frameRateCap", &opt.frame_rate_cap);
+  options.GetInteger("freezeAfter", &opt.freeze_after);
+  options.GetBoolean("thawOnActivate", &opt.thaw_on_activate);
+  if (opt.frame_rate_cap < 0 || opt.freeze_after < 0) {
+    return false;
+  }
+  options_ = opt;
+
+  for (auto& iter : entries_) {
+    Entry* entry = iter.second.get();
+    // a changed delay starts over.
+    entry->freeze_timer.Stop();
+    if (entry->state == FROZEN && (!options_.enabled || options_.freeze_after == 0)) {
+      SetState(iter.first, entry, entry->hidden ? THROTTLED : ACTIVE, "policy-changed");
+    }
+    UpdateClient(iter.first, entry, "policy-changed");
+  }
+  return true;
+}
+
+void BackgroundThrottlingPolicy::AddClient(Client* client) {
+  Entry* entry = new Entry();
+  entries_[client].reset(entry);
+  // e.g. created in the background, or a prerender.
+  entry->hidden = client->IsThrottlingHidden();
+  if (entry->hidden) {
+    UpdateClient(client, entry, "hidden");
+  }
+  ThawProcess(client);
+}
+
+void BackgroundThrottlingPolicy::RemoveClient(Client* client) {
+  entries_.erase(client);
+}
+
+void BackgroundThrottlingPolicy::WasShown(Client* client) {
+  auto fiter = entries_.find(client);
+  if (fiter == entries_.end()) {
+    return;
+  }
+  fiter->second->hidden = false;
+  UpdateClient(client, fiter->second.get(), "shown");
+}
+
+void BackgroundThrottlingPolicy::WasHidden(Client* client) {
+  auto fiter = entries_.find(client);
+  if (fiter == entries_.end()) {
+    return;
+  }
+  fiter->second->hidden = true;
+  UpdateClient(client, fiter->second.get(), "hidden");
+}
+
+void BackgroundThrottlingPolicy::Activated(Client* client) {
+  auto fiter = entries_.find(client);
+  if (fiter == entries_.end() || !options_.thaw_on_activate) {
+    return;
+  }
+  Entry* entry = fiter->second.get();
+  if (entry->state == FROZEN) {
+    SetState(client, entry, entry->hidden ? THROTTLED : ACTIVE, "activated");
+    if (entry->state == THROTTLED) {
+      // still hidden contents are frozen again after the delay.
+      StartFreezeTimer(client, entry);
+    }
+  }
+}
+
+void BackgroundThrottlingPolicy::RendererChanged(Client* client) {
+  auto fiter = entries_.find(client);
+  if (fiter == entries_.end()) {
+    return;
+  }
+  client->ApplyThrottling(fiter->second->state, options_);
+  ThawProcess(client);
+}
+
+void BackgroundThrottlingPolicy::UpdateClient(Client* client, Entry* entry, const char* reason) {
+  State state = THROTTLED;
+  if (!options_.enabled || !client->AllowsThrottling() || !entry->hidden) {
+    state = ACTIVE;
+  } else if (entry->state == FROZEN) {
+    state = FROZEN;
+  }
+  SetState(client, entry, state, reason);
+  if (state == THROTTLED) {
+    StartFreezeTimer(client, entry);
+  }
+}
+
+void BackgroundThrottlingPolicy::StartFreezeTimer(Client* client, Entry* entry) {
+  if (options_.freeze_after == 0 || entry->freeze_timer.IsRunning()) {
+    return;
+  }
+  entry->freeze_timer.Start(FROM_HERE, base::TimeDelta::FromSeconds(options_.freeze_after),
+                            base::Bind(&BackgroundThrottlingPolicy::OnFreezeTimer, base::Unretained(this), client));
+}
+
+void BackgroundThrottlingPolicy::SetState(Client* client, Entry* entry, State state, const char* reason) {
+  if (state == entry->state) {
+    // the options may have changed.
+    client->ApplyThrottling(state, options_);
+    return;
+  }
+  base::TimeTicks now = base::TimeTicks::Now();
+  base::TimeDelta elapsed = now - entry->state_since;
+  State from = entry->state;
+  if (from == THROTTLED) {
+    entry->throttled_time += elapsed;
+  } else if (from == FROZEN) {
+    entry->frozen_time += elapsed;
+    // what the process would have used, had it stayed throttled.
+    double frozen_cpu_usage = SampleCPUUsage(client, entry);
+    double ratio = std::max(entry->throttled_cpu_usage - frozen_cpu_usage, 0.0) / 100.0;
+    entry->cpu_time_saved += base::TimeDelta::FromSecondsD(elapsed.InSecondsF() * ratio);
+  }
+  if (from == ACTIVE) {
+    entry->metrics.reset();
+    SampleCPUUsage(client, entry);
+  }
+  if (state == FROZEN) {
+    entry->throttled_cpu_usage = SampleCPUUsage(client, entry);
+  }
+  if (state != THROTTLED) {
+    entry->freeze_timer.Stop();
+  }
+
+  entry->state = state;
+  entry->state_since = now;
+  entry->transitions++;
+  LOG(INFO) << __PRETTY_FUNCTION__ << " : " << client->GetThrottlingClientID() << " " << StateToString(from) << " -> " << StateToString(state) << " (" << reason << ")";
+  client->ApplyThrottling(state, options_);
+  client->OnThrottlingStateChanged(from, state, reason);
+}
+
+void BackgroundThrottlingPolicy::OnFreezeTimer(Client* client) {
+  auto fiter = entries_.find(client);
+  if (fiter == entries_.end() || fiter->second->state != THROTTLED) {
+    return;
+  }
+  Entry* entry = fiter->second.get();
+  if (SharesProcess(client)) {
+    // tried again after the delay, the other pages may be gone by then.
+    entry->freezes_skipped++;
+    StartFreezeTimer(client, entry);
+    return;
+  }
+  SetState(client, entry, FROZEN, "hidden-timeout");
+}
+
+bool BackgroundThrottlingPolicy::SharesProcess(Client* client) const {
+  content::RenderProcessHost* process = client->GetThrottlingProcess();
+  // the suspension is not per page, it stops the other pages of the renderer.
+  return process && process->GetActiveViewCount() > 1;
+}
+
+void BackgroundThrottlingPolicy::ThawProcess(Client* client) {
+  content::RenderProcessHost* process = client->GetThrottlingProcess();
+  if (!process) {
+    return;
+  }
+  for (auto& iter : entries_) {
+    Entry* entry = iter.second.get();
+    if (iter.first == client || entry->state != FROZEN || iter.first->GetThrottlingProcess() != process) {
+      continue;
+    }
+    SetState(iter.first, entry, entry->hidden ? THROTTLED : ACTIVE, "process-shared");
+    if (entry->state == THROTTLED) {
+      StartFreezeTimer(iter.first, entry);
+    }
+  }
+}
+
+double BackgroundThrottlingPolicy::SampleCPUUsage(Client* client, Entry* entry) {
+  if (!entry->metrics) {
+    content::RenderProcessHost* process = client->GetThrottlingProcess();
+    if (!process || process->GetHandle() == base::kNullProcessHandle) {
+      return 0.0;
+    }
+#if defined(OS_MACOSX)
+    entry->metrics = base::ProcessMetrics::CreateProcessMetrics(process->GetHandle(), content::BrowserChildProcessHost::GetPortProvider());
+#else
+    entry->metrics = base::ProcessMetrics::CreateProcessMetrics(process->GetHandle());
+#endif
+  }
+  // the usage since the previous sample, the first one is 0.
+  return entry->metrics->GetCPUUsage();
+}
+
+std::unique_ptr<base::ListValue> BackgroundThrottlingPolicy::GetStatistics(void) const {
+  std::unique_ptr<base::ListValue> list(new base::ListValue());
+  base::TimeTicks now = base::TimeTicks::Now();
+  for (const auto& iter : entries_) {
+    const Entry* entry = iter.second.get();
+    base::TimeDelta throttled_time = entry->throttled_time;
+    base::TimeDelta frozen_time = entry->frozen_time;
+    if (entry->state == THROTTLED) {
+      throttled_time += now - entry->state_since;
+    } else if (entry->state == FROZEN) {
+      frozen_time += now - entry->state_since;
+    }
+    std::unique_ptr<base::DictionaryValue> stats(new base::DictionaryValue());
+    stats->SetInteger("id", iter.first->GetThrottlingClientID());
+    stats->SetString("state", StateToString(entry->state));
+    stats->SetBoolean("hidden", entry->hidden);
+    stats->SetDouble("throttledTime", throttled_time.InSecondsF());
+    stats->SetDouble("frozenTime", frozen_time.InSecondsF());
+    // estimated, processes can be shared by several contents.
+    stats->SetDouble("cpuTimeSaved", entry->cpu_time_saved.InSecondsF());
+    stats->SetInteger("transitions", entry->transitions);
+    stats->SetInteger("freezesSkipped", entry->freezes_skipped);
+    list->Append(std::move(stats));
+  }
+  return list;
+}
+
+// static
+const char* BackgroundThrottlingPolicy::StateToString(State state) {
+  switch (state) {
+  case ACTIVE:
+    return "active";
+  case THROTTLED:
+    return "throttled";
+  case FROZEN:
+    return "frozen";
+  }
+  return "unknown";
+}
+}
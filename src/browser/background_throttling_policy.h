@@ -0,0 +1,113 @@
+//-*-c++-*-
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include "base/macros.h"
+#include "base/time/time.h"
+#include "base/timer/timer.h"
+#include "base/values.h"
+
+namespace base {
+class ProcessMetrics;
+}
+namespace content {
+class RenderProcessHost;
+}
+
+namespace meson {
+// Throttling of the hidden web contents of a session.
+// Hidden contents are throttled (timer tier, frame rate cap), and frozen after
+// being hidden for a while. Showing or activating a contents thaws it.
+// A freeze suspends the whole renderer, so a contents whose process hosts
+// other pages is never frozen (and is thawed when one joins it).
+class BackgroundThrottlingPolicy {
+ public:
+  enum State {
+    ACTIVE,
+    THROTTLED,
+    FROZEN,
+  };
+  enum TimerTier {
+    TIMER_NONE,      // hidden contents run timers as if visible.
+    TIMER_STANDARD,  // the renderer's background timer throttling.
+  };
+  struct Options {
+    Options();
+    bool enabled;
+    TimerTier timer_tier;
+    int frame_rate_cap;   // 0 means no cap.
+    int freeze_after;     // seconds hidden, 0 means never.
+    bool thaw_on_activate;
+  };
+
+  class Client {
+   public:
+    virtual int GetThrottlingClientID(void) const = 0;
+    virtual content::RenderProcessHost* GetThrottlingProcess(void) const = 0;
+    // false if the client opted out (backgroundThrottling: false).
+    virtual bool AllowsThrottling(void) const = 0;
+    // whether the contents is hidden when it is added.
+    virtual bool IsThrottlingHidden(void) const = 0;
+    virtual void ApplyThrottling(State state, const Options& options) = 0;
+    virtual void OnThrottlingStateChanged(State from, State to, const std::string& reason) = 0;
+
+   protected:
+    virtual ~Client() {}
+  };
+
+  BackgroundThrottlingPolicy(void);
+  ~BackgroundThrottlingPolicy(void);
+
+  // options: {enabled, timerTier: "none" | "standard", frameRateCap, freezeAfter, thawOnActivate}
+  bool Configure(const base::DictionaryValue& options);
+  const Options& options(void) const { return options_; }
+
+  void AddClient(Client* client);
+  void RemoveClient(Client* client);
+  void WasShown(Client* client);
+  void WasHidden(Client* client);
+  // ActivateContents() or Focus().
+  void Activated(Client* client);
+  // a new renderer knows nothing of the state, it is applied again.
+  void RendererChanged(Client* client);
+
+  // [{id, state, hidden, throttledTime, frozenTime, cpuTimeSaved, transitions,
+  //   freezesSkipped}]
+  std::unique_ptr<base::ListValue> GetStatistics(void) const;
+  static const char* StateToString(State state);
+
+ private:
+  struct Entry {
+    Entry();
+    ~Entry();
+    State state;
+    bool hidden;
+    base::TimeTicks state_since;
+    base::TimeDelta throttled_time;
+    base::TimeDelta frozen_time;
+    base::TimeDelta cpu_time_saved;
+    // cpu usage (%) of the process while throttled, the baseline of a freeze.
+    double throttled_cpu_usage;
+    int transitions;
+    // freezes not done as the process hosted other pages.
+    int freezes_skipped;
+    std::unique_ptr<base::ProcessMetrics> metrics;
+    base::OneShotTimer freeze_timer;
+  };
+  void UpdateClient(Client* client, Entry* entry, const char* reason);
+  void SetState(Client* client, Entry* entry, State state, const char* reason);
+  void StartFreezeTimer(Client* client, Entry* entry);
+  void OnFreezeTimer(Client* client);
+  bool SharesProcess(Client* client) const;
+  // thaws the other contents frozen in the process of |client|.
+  void ThawProcess(Client* client);
+  double SampleCPUUsage(Client* client, Entry* entry);
+
+ private:
+  Options options_;
+  std::map<Client*, std::unique_ptr<Entry>> entries_;
+  DISALLOW_COPY_AND_ASSIGN(BackgroundThrottlingPolicy);
+};
+}
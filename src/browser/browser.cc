@@ -33,6 +33,10 @@ Browser* Browser::Get() {
 }
 
 void Browser::Quit() {
+  Quit(WindowList::CloseOptions());
+}
+
+void Browser::Quit(const WindowList::CloseOptions& options) {
   if (is_quiting_)
     return;
 
@@ -44,7 +48,7 @@ void Browser::Quit() {
   if (window_list->size() == 0)
     NotifyAndShutdown();
 
-  window_list->CloseAllWindows();
+  window_list->CloseAllWindows(options);
 }
 
 void Browser::Exit(int code) {
@@ -5,6 +5,7 @@
 #include <vector>
 
 #include "browser/browser_observer.h"
+#include "browser/window_list.h"
 #include "browser/window_list_observer.h"
 #include "base/compiler_specific.h"
 #include "base/macros.h"
@@ -38,6 +39,7 @@ class Browser : public WindowListObserver {
   static Browser* Get();
 
   void Quit();                                         // Try to close all windows and quit the application.
+  void Quit(const WindowList::CloseOptions& options);  // Same, with a timeout (and forced close) for the windows.
   void Exit(int code);                                 // Exit the application immediately and set exit code.
   void Shutdown();                                     // Cleanup everything and shutdown the application gracefully.
   void Focus();                                        // Focus the application.
@@ -13,6 +13,8 @@
 #include "net/ssl/ssl_cert_request_info.h"
 
 #include "browser/browser_main_parts.h"
+#include "browser/guest_process_policy.h"
+#include "browser/session/meson_browser_context.h"
 #include "browser/web_contents_preferences.h"
 
 namespace meson {
@@ -88,11 +90,17 @@ void MesonBrowserClient::OverrideSiteInstanceForNavigation(content::BrowserConte
     return;
   }
 
-  if (!ShouldCreateNewSiteInstance(browser_context, current_instance, url))
-    return;
-
-  scoped_refptr<content::SiteInstance> site_instance =
-      content::SiteInstance::CreateForURL(browser_context, url);
+  scoped_refptr<content::SiteInstance> site_instance;
+  auto policy = static_cast<MesonBrowserContext*>(browser_context)->GetGuestProcessPolicy();
+  if (policy->GetSiteInstanceForNavigation(browser_context, current_instance, url, &site_instance)) {
+    // guests sharing a process stay in it, or move to the one of the new origin.
+    if (site_instance.get() == current_instance)
+      return;
+  } else {
+    if (!ShouldCreateNewSiteInstance(browser_context, current_instance, url))
+      return;
+    site_instance = content::SiteInstance::CreateForURL(browser_context, url);
+  }
   *new_instance = site_instance.get();
 
   // Make sure the |site_instance| is not freed when this function returns.
@@ -0,0 +1,119 @@
+#include "browser/capture_encoder.h"
+
+#include <string.h>
+#include <memory>
+#include <vector>
+#include "base/logging.h"
+#include "base/memory/shared_memory.h"
+#include "third_party/libwebp/webp/encode.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "ui/gfx/codec/jpeg_codec.h"
+#include "ui/gfx/codec/png_codec.h"
+#include "api/api_shared_buffer.h"
+
+namespace meson {
+namespace {
+const int kBytesPerPixel = 4;
+
+bool IsRGBA(const SkBitmap& bitmap) {
+  return bitmap.colorType() == kRGBA_8888_SkColorType;
+}
+
+bool EncodeRaw(const SkBitmap& bitmap, std::vector<unsigned char>* output) {
+  const size_t stride = static_cast<size_t>(bitmap.width()) * kBytesPerPixel;
+  output->resize(stride * bitmap.height());
+  const unsigned char* src = static_cast<const unsigned char*>(bitmap.getPixels());
+  for (int y = 0; y < bitmap.height(); y++) {
+    memcpy(output->data() + stride * y, src + bitmap.rowBytes() * y, stride);
+  }
+  return true;
+}
+
+bool EncodeWebP(const SkBitmap& bitmap, int quality, std::vector<unsigned char>* output) {
+  uint8_t* data = nullptr;
+  auto encode = IsRGBA(bitmap) ? WebPEncodeRGBA : WebPEncodeBGRA;
+  size_t size = encode(static_cast<const uint8_t*>(bitmap.getPixels()),
+                       bitmap.width(), bitmap.height(), static_cast<int>(bitmap.rowBytes()),
+                       static_cast<float>(quality), &data);
+  if (size == 0) {
+    return false;
+  }
+  output->assign(data, data + size);
+  WebPFree(data);
+  return true;
+}
+}
+
+bool ParseCaptureFormat(const std::string& name, CaptureFormat* format) {
+  // "bgra" is the name used before, the order is the native one anyway.
+  if (name == "raw" || name == "bgra") {
+    *format = CaptureFormat::RAW;
+  } else if (name == "png") {
+    *format = CaptureFormat::PNG;
+  } else if (name == "jpeg") {
+    *format = CaptureFormat::JPEG;
+  } else if (name == "webp") {
+    *format = CaptureFormat::WEBP;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+CaptureResult EncodeCapture(const SkBitmap& bitmap, CaptureFormat format, int quality, int owner) {
+  CaptureResult result = {0, 0, bitmap.width(), bitmap.height()};
+  if (bitmap.bytesPerPixel() != kBytesPerPixel) {
+    return result;
+  }
+  switch (format) {
+  case CaptureFormat::RAW:
+    result.format = IsRGBA(bitmap) ? "rgba" : "bgra";
+    break;
+  case CaptureFormat::PNG:
+    result.format = "png";
+    break;
+  case CaptureFormat::JPEG:
+    result.format = "jpeg";
+    break;
+  case CaptureFormat::WEBP:
+    result.format = "webp";
+    break;
+  }
+
+  std::vector<unsigned char> encoded;
+  bool ok = false;
+  {
+    SkAutoLockPixels pixels_lock(bitmap);
+    switch (format) {
+    case CaptureFormat::RAW:
+      ok = EncodeRaw(bitmap, &encoded);
+      break;
+    case CaptureFormat::PNG:
+      ok = gfx::PNGCodec::EncodeBGRASkBitmap(bitmap, false, &encoded);
+      break;
+    case CaptureFormat::JPEG:
+      ok = gfx::JPEGCodec::Encode(static_cast<const unsigned char*>(bitmap.getPixels()),
+                                  gfx::JPEGCodec::FORMAT_SkBitmap,
+                                  bitmap.width(), bitmap.height(), static_cast<int>(bitmap.rowBytes()),
+                                  quality, &encoded);
+      break;
+    case CaptureFormat::WEBP:
+      ok = EncodeWebP(bitmap, quality, &encoded);
+      break;
+    }
+  }
+  if (!ok || encoded.empty()) {
+    LOG(ERROR) << __PRETTY_FUNCTION__ << " : failed to encode " << static_cast<int>(format);
+    return result;
+  }
+
+  std::unique_ptr<base::SharedMemory> memory(new base::SharedMemory);
+  if (!memory->CreateAndMapAnonymous(encoded.size())) {
+    return result;
+  }
+  memcpy(memory->memory(), encoded.data(), encoded.size());
+  result.size = encoded.size();
+  result.buffer_id = SharedBufferRegistry::Get()->Add(std::move(memory), encoded.size(), owner);
+  return result;
+}
+}
@@ -0,0 +1,34 @@
+//-*-c++-*-
+#pragma once
+
+#include <stddef.h>
+#include <string>
+
+class SkBitmap;
+
+namespace meson {
+enum class CaptureFormat {
+  // the pixels as read back, in the native order of kN32_SkColorType.
+  RAW,
+  PNG,
+  JPEG,
+  WEBP,
+};
+
+struct CaptureResult {
+  // SharedBufferRegistry id, 0 when encoding failed.
+  unsigned int buffer_id;
+  size_t size;
+  int width;
+  int height;
+  // "bgra" or "rgba" for RAW (the real pixel order), otherwise the encoding.
+  std::string format;
+};
+
+bool ParseCaptureFormat(const std::string& name, CaptureFormat* format);
+
+// Encodes |bitmap| into a shared buffer which the host releases.
+// The buffer belongs to |owner| (see SharedBufferRegistry::ReleaseOwner).
+// Runs on a worker thread; |quality| is used by JPEG and WebP.
+CaptureResult EncodeCapture(const SkBitmap& bitmap, CaptureFormat format, int quality, int owner);
+}
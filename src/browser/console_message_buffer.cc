@@ -0,0 +1,128 @@
+#include "browser/console_message_buffer.h"
+
+#include <algorithm>
+#include "base/strings/utf_string_conversions.h"
+
+namespace meson {
+namespace {
+const size_t kDefaultCapacity = 1000;
+const size_t kMaxCapacity = 100000;
+// a page logging in a loop must not flood the host with events.
+const int kDefaultMaxPushPerSecond = 100;
+}
+
+ConsoleMessageBuffer::ConsoleMessageBuffer(void)
+    : capacity_(kDefaultCapacity),
+      min_level_(0),
+      next_seq_(1),
+      push_(false),
+      max_push_per_second_(kDefaultMaxPushPerSecond),
+      push_tokens_(kDefaultMaxPushPerSecond),
+      last_refill_(base::TimeTicks::Now()),
+      suppressed_(0) {
+}
+
+ConsoleMessageBuffer::~ConsoleMessageBuffer(void) {
+}
+
+bool ConsoleMessageBuffer::Configure(const base::DictionaryValue& options) {
+  int capacity = static_cast<int>(capacity_);
+  int level = min_level_;
+  bool push = push_;
+  int max_push = max_push_per_second_;
+  options.GetInteger("capacity", &capacity);
+  options.GetInteger("level", &level);
+  options.GetBoolean("push", &push);
+  options.GetInteger("maxPushPerSecond", &max_push);
+  if (capacity < 1 || static_cast<size_t>(capacity) > kMaxCapacity || max_push < 0) {
+    return false;
+  }
+  capacity_ = static_cast<size_t>(capacity);
+  while (entries_.size() > capacity_) {
+    entries_.pop_front();
+  }
+  min_level_ = level;
+  push_ = push;
+  max_push_per_second_ = max_push;
+  push_tokens_ = max_push;
+  last_refill_ = base::TimeTicks::Now();
+  return true;
+}
+
+uint64_t ConsoleMessageBuffer::Add(int level, const base::string16& message, int line_no, const base::string16& source_id, bool* push, int* suppressed) {
+  *push = false;
+  *suppressed = 0;
+  if (level < min_level_) {
+    return 0;
+  }
+  if (entries_.size() >= capacity_) {
+    entries_.pop_front();
+  }
+  Entry entry = {next_seq_++, level, base::UTF16ToUTF8(message), line_no, base::UTF16ToUTF8(source_id)};
+  entries_.push_back(std::move(entry));
+
+  if (push_) {
+    if (TakePushToken()) {
+      *push = true;
+      *suppressed = suppressed_;
+      suppressed_ = 0;
+    } else {
+      // still retrievable with Get().
+      suppressed_++;
+    }
+  }
+  return entries_.back().seq;
+}
+
+bool ConsoleMessageBuffer::TakePushToken(void) {
+  if (max_push_per_second_ == 0) {
+    // unlimited
+    return true;
+  }
+  base::TimeTicks now = base::TimeTicks::Now();
+  push_tokens_ = std::min<double>(max_push_per_second_, push_tokens_ + (now - last_refill_).InSecondsF() * max_push_per_second_);
+  last_refill_ = now;
+  if (push_tokens_ < 1.0) {
+    return false;
+  }
+  push_tokens_ -= 1.0;
+  return true;
+}
+
+std::unique_ptr<base::DictionaryValue> ConsoleMessageBuffer::Get(uint64_t since_seq, size_t max_count) const {
+  std::unique_ptr<base::ListValue> messages(new base::ListValue());
+  // entries are ordered by seq, so the first one after |since_seq| is found directly.
+  size_t begin = 0;
+  if (!entries_.empty() && since_seq >= entries_.front().seq) {
+    begin = std::min<size_t>(entries_.size(), since_seq - entries_.front().seq + 1);
+  }
+  for (size_t i = begin; i < entries_.size() && messages->GetSize() < max_count; i++) {
+    messages->Append(EntryToValue(entries_[i]));
+  }
+
+  size_t result_count = messages->GetSize();
+  std::unique_ptr<base::DictionaryValue> result(new base::DictionaryValue());
+  uint64_t first_seq = entries_.empty() ? next_seq_ : entries_.front().seq;
+  // messages evicted before the host pulled them.
+  uint64_t lost = first_seq > since_seq + 1 ? first_seq - since_seq - 1 : 0;
+  uint64_t last_seq = since_seq;
+  if (result_count > 0) {
+    last_seq = entries_[begin + result_count - 1].seq;
+  }
+  result->Set("messages", std::move(messages));
+  result->SetDouble("lastSeq", static_cast<double>(last_seq));
+  result->SetDouble("lost", static_cast<double>(lost));
+  result->SetBoolean("more", begin + result_count < entries_.size());
+  return result;
+}
+
+std::unique_ptr<base::DictionaryValue> ConsoleMessageBuffer::EntryToValue(const Entry& entry) const {
+  std::unique_ptr<base::DictionaryValue> value(new base::DictionaryValue());
+  value->SetDouble("seq", static_cast<double>(entry.seq));
+  value->SetInteger("level", entry.level);
+  value->SetString("message", entry.message);
+  value->SetInteger("lineNO", entry.line_no);
+  value->SetString("sourceID", entry.source_id);
+  return value;
+}
+}
@@ -0,0 +1,58 @@
+//-*-c++-*-
+#pragma once
+
+#include <stdint.h>
+#include <deque>
+#include <memory>
+#include <string>
+#include "base/macros.h"
+#include "base/strings/string16.h"
+#include "base/time/time.h"
+#include "base/values.h"
+
+namespace meson {
+// Bounded ring of console messages of a WebContents.
+// The host pulls them in bulk with Get(); pushing each message is optional
+// and rate limited.
+class ConsoleMessageBuffer {
+ public:
+  ConsoleMessageBuffer(void);
+  ~ConsoleMessageBuffer(void);
+
+  // options: {capacity, level, push, maxPushPerSecond}
+  // maxPushPerSecond is 100 by default, 0 pushes every message.
+  bool Configure(const base::DictionaryValue& options);
+  void set_push(bool push) { push_ = push; }
+
+  // returns the sequence number of the stored message, or 0 when filtered.
+  // |*push| is set when the message should be emitted now.
+  uint64_t Add(int level, const base::string16& message, int line_no, const base::string16& source_id, bool* push, int* suppressed);
+  // at most |max_count| messages newer than |since_seq|.
+  std::unique_ptr<base::DictionaryValue> Get(uint64_t since_seq, size_t max_count) const;
+
+ private:
+  struct Entry {
+    uint64_t seq;
+    int level;
+    std::string message;
+    int line_no;
+    std::string source_id;
+  };
+  std::unique_ptr<base::DictionaryValue> EntryToValue(const Entry& entry) const;
+  bool TakePushToken(void);
+
+ private:
+  std::deque<Entry> entries_;
+  size_t capacity_;
+  int min_level_;
+  uint64_t next_seq_;
+
+  // push mode, token bucket
+  bool push_;
+  int max_push_per_second_;
+  double push_tokens_;
+  base::TimeTicks last_refill_;
+  int suppressed_;
+  DISALLOW_COPY_AND_ASSIGN(ConsoleMessageBuffer);
+};
+}
@@ -0,0 +1,221 @@
+#include "browser/contents_discarder.h"
+
+#include <limits>
+#include "base/bind.h"
+#include "base/logging.h"
+#include "content/public/browser/navigation_controller.h"
+#include "content/public/browser/render_process_host.h"
+#include "content/public/browser/web_contents.h"
+#include "content/public/common/result_codes.h"
+
+namespace meson {
+ContentsDiscarder::Options::Options()
+    : enabled(true),
+      max_live_contents(0),
+      min_hidden_time(0) {
+}
+
+ContentsDiscarder::Entry::Entry()
+    : hidden(false),
+      discarded(false),
+      last_active(base::TimeTicks::Now()) {
+}
+
+ContentsDiscarder::ContentsDiscarder(void)
+    : memory_pressure_listener_(new base::MemoryPressureListener(base::Bind(&ContentsDiscarder::OnMemoryPressure, base::Unretained(this)))),
+      discards_(0),
+      reloads_(0),
+      pressure_events_(0),
+      skipped_(0) {
+}
+
+ContentsDiscarder::~ContentsDiscarder(void) {
+}
+
+bool ContentsDiscarder::Configure(const base::DictionaryValue& options) {
+  Options opt = options_;
+  options.GetBoolean("enabled", &opt.enabled);
+  options.GetInteger("maxLiveContents", &opt.max_live_contents);
+  options.GetInteger("minHiddenTime", &opt.min_hidden_time);
+  if (opt.max_live_contents < 0 || opt.min_hidden_time < 0) {
+    return false;
+  }
+  options_ = opt;
+  EnforceBudget();
+  return true;
+}
+
+void ContentsDiscarder::AddClient(Client* client) {
+  entries_[client] = Entry();
+  EnforceBudget();
+}
+
+void ContentsDiscarder::RemoveClient(Client* client) {
+  entries_.erase(client);
+}
+
+void ContentsDiscarder::WasShown(Client* client) {
+  auto fiter = entries_.find(client);
+  if (fiter == entries_.end()) {
+    return;
+  }
+  fiter->second.hidden = false;
+  fiter->second.last_active = base::TimeTicks::Now();
+  if (fiter->second.discarded) {
+    Undiscard(client, "shown", true);
+  }
+}
+
+void ContentsDiscarder::WasHidden(Client* client) {
+  auto fiter = entries_.find(client);
+  if (fiter == entries_.end()) {
+    return;
+  }
+  fiter->second.hidden = true;
+  fiter->second.last_active = base::TimeTicks::Now();
+  EnforceBudget();
+}
+
+bool ContentsDiscarder::IsDiscarded(Client* client) const {
+  auto fiter = entries_.find(client);
+  return fiter != entries_.end() && fiter->second.discarded;
+}
+
+bool ContentsDiscarder::Discard(Client* client, const std::string& reason) {
+  auto fiter = entries_.find(client);
+  if (fiter == entries_.end() || fiter->second.discarded) {
+    return false;
+  }
+  content::WebContents* web_contents = client->GetDiscardWebContents();
+  if (!web_contents) {
+    return false;
+  }
+  if (SharesProcess(client)) {
+    // killing the renderer would take other contents with it.
+    skipped_++;
+    return false;
+  }
+  LOG(INFO) << __PRETTY_FUNCTION__ << " : " << client->GetDiscardClientID() << " (" << reason << ")";
+  fiter->second.discarded = true;
+  discards_++;
+  client->OnDiscardStateChanged(true, reason);
+
+  // the navigation entries stay, and are loaded again by Undiscard().
+  web_contents->GetController().SetNeedsReload();
+  content::RenderProcessHost* process = web_contents->GetRenderProcessHost();
+  if (process->HasConnection()) {
+    process->Shutdown(content::RESULT_CODE_KILLED, false);
+  }
+  return true;
+}
+
+bool ContentsDiscarder::Undiscard(Client* client, const std::string& reason, bool reload) {
+  auto fiter = entries_.find(client);
+  if (fiter == entries_.end() || !fiter->second.discarded) {
+    return false;
+  }
+  LOG(INFO) << __PRETTY_FUNCTION__ << " : " << client->GetDiscardClientID() << " (" << reason << ")";
+  fiter->second.discarded = false;
+  fiter->second.last_active = base::TimeTicks::Now();
+  client->OnDiscardStateChanged(false, reason);
+
+  content::WebContents* web_contents = client->GetDiscardWebContents();
+  if (reload && web_contents) {
+    reloads_++;
+    // restores the last committed entry with its page state.
+    web_contents->GetController().LoadIfNecessary();
+  }
+  return true;
+}
+
+void ContentsDiscarder::OnMemoryPressure(base::MemoryPressureListener::MemoryPressureLevel level) {
+  if (!options_.enabled || level == base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_NONE) {
+    return;
+  }
+  pressure_events_++;
+  if (level == base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_CRITICAL) {
+    DiscardLeastRecentlyUsed(std::numeric_limits<int>::max(), true, "memory-pressure");
+  } else {
+    DiscardLeastRecentlyUsed(1, false, "memory-pressure");
+  }
+}
+
+int ContentsDiscarder::DiscardLeastRecentlyUsed(int count, bool ignore_hidden_time, const std::string& reason) {
+  int discarded = 0;
+  while (discarded < count) {
+    Client* lru = nullptr;
+    base::TimeTicks lru_time;
+    for (const auto& iter : entries_) {
+      if (!IsDiscardable(iter.first, iter.second, ignore_hidden_time))
+        continue;
+      if (!lru || iter.second.last_active < lru_time) {
+        lru = iter.first;
+        lru_time = iter.second.last_active;
+      }
+    }
+    if (!lru || !Discard(lru, reason)) {
+      break;
+    }
+    discarded++;
+  }
+  return discarded;
+}
+
+void ContentsDiscarder::EnforceBudget(void) {
+  if (!options_.enabled || options_.max_live_contents == 0) {
+    return;
+  }
+  int excess = GetLiveCount() - options_.max_live_contents;
+  if (excess > 0) {
+    DiscardLeastRecentlyUsed(excess, true, "budget");
+  }
+}
+
+bool ContentsDiscarder::IsDiscardable(Client* client, const Entry& entry, bool ignore_hidden_time) const {
+  if (!entry.hidden || entry.discarded || !client->CanDiscard()) {
+    return false;
+  }
+  if (!ignore_hidden_time && base::TimeTicks::Now() - entry.last_active < base::TimeDelta::FromSeconds(options_.min_hidden_time)) {
+    return false;
+  }
+  return !SharesProcess(client);
+}
+
+bool ContentsDiscarder::SharesProcess(Client* client) const {
+  content::WebContents* web_contents = client->GetDiscardWebContents();
+  if (!web_contents) {
+    return false;
+  }
+  content::RenderProcessHost* process = web_contents->GetRenderProcessHost();
+  for (const auto& iter : entries_) {
+    if (iter.first == client || iter.second.discarded)
+      continue;
+    content::WebContents* other = iter.first->GetDiscardWebContents();
+    if (other && other->GetRenderProcessHost() == process)
+      return true;
+  }
+  return false;
+}
+
+int ContentsDiscarder::GetLiveCount(void) const {
+  int live = 0;
+  for (const auto& iter : entries_) {
+    if (!iter.second.discarded)
+      live++;
+  }
+  return live;
+}
+
+std::unique_ptr<base::DictionaryValue> ContentsDiscarder::GetStatistics(void) const {
+  std::unique_ptr<base::DictionaryValue> stats(new base::DictionaryValue());
+  int live = GetLiveCount();
+  stats->SetInteger("live", live);
+  stats->SetInteger("discarded", static_cast<int>(entries_.size()) - live);
+  stats->SetInteger("discards", discards_);
+  stats->SetInteger("reloads", reloads_);
+  stats->SetInteger("pressureEvents", pressure_events_);
+  // not discarded because the renderer is shared.
+  stats->SetInteger("skipped", skipped_);
+  return stats;
+}
+}
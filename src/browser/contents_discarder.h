@@ -0,0 +1,87 @@
+//-*-c++-*-
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include "base/macros.h"
+#include "base/memory/memory_pressure_listener.h"
+#include "base/time/time.h"
+#include "base/values.h"
+
+namespace content {
+class WebContents;
+}
+
+namespace meson {
+// Discards hidden web contents of a session under memory pressure, or when
+// more than |max_live_contents| are alive.
+// A discarded contents has no renderer but keeps its navigation entries
+// (with the page state, e.g. the scroll position), and is reloaded from them
+// when it is shown or activated again.
+class ContentsDiscarder {
+ public:
+  struct Options {
+    Options();
+    bool enabled;
+    int max_live_contents;  // 0 means no budget.
+    int min_hidden_time;    // seconds.
+  };
+
+  class Client {
+   public:
+    virtual int GetDiscardClientID(void) const = 0;
+    virtual content::WebContents* GetDiscardWebContents(void) const = 0;
+    // e.g. playing audio or with devtools opened.
+    virtual bool CanDiscard(void) const = 0;
+    virtual void OnDiscardStateChanged(bool discarded, const std::string& reason) = 0;
+
+   protected:
+    virtual ~Client() {}
+  };
+
+  ContentsDiscarder(void);
+  ~ContentsDiscarder(void);
+
+  // options: {enabled, maxLiveContents, minHiddenTime}
+  bool Configure(const base::DictionaryValue& options);
+
+  void AddClient(Client* client);
+  void RemoveClient(Client* client);
+  void WasShown(Client* client);
+  void WasHidden(Client* client);
+  bool IsDiscarded(Client* client) const;
+
+  bool Discard(Client* client, const std::string& reason);
+  // |reload| is false when the client navigates anyway.
+  bool Undiscard(Client* client, const std::string& reason, bool reload);
+
+  std::unique_ptr<base::DictionaryValue> GetStatistics(void) const;
+
+ private:
+  struct Entry {
+    Entry();
+    bool hidden;
+    bool discarded;
+    base::TimeTicks last_active;
+  };
+  void OnMemoryPressure(base::MemoryPressureListener::MemoryPressureLevel level);
+  // discards the least recently active contents until |count| are discarded.
+  int DiscardLeastRecentlyUsed(int count, bool ignore_hidden_time, const std::string& reason);
+  void EnforceBudget(void);
+  bool IsDiscardable(Client* client, const Entry& entry, bool ignore_hidden_time) const;
+  bool SharesProcess(Client* client) const;
+  int GetLiveCount(void) const;
+
+ private:
+  Options options_;
+  std::map<Client*, Entry> entries_;
+  std::unique_ptr<base::MemoryPressureListener> memory_pressure_listener_;
+
+  int discards_;
+  int reloads_;
+  int pressure_events_;
+  int skipped_;
+  DISALLOW_COPY_AND_ASSIGN(ContentsDiscarder);
+};
+}
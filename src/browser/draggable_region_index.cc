@@ -0,0 +1,244 @@
+#include "browser/draggable_region_index.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace meson {
+DraggableRegionIndex::Band::Band()
+    : top(0),
+      bottom(0) {
+}
+
+DraggableRegionIndex::Band::~Band() {
+}
+
+DraggableRegionIndex::DraggableRegionIndex(void)
+    : full_updates_(0),
+      change_updates_(0),
+      unchanged_updates_(0),
+      bands_rebuilt_(0),
+      hit_tests_(0) {
+}
+
+DraggableRegionIndex::~DraggableRegionIndex(void) {
+}
+
+bool DraggableRegionIndex::SetRegions(const std::vector<DraggableRegion>& regions) {
+  if (regions == regions_) {
+    unchanged_updates_++;
+    return false;
+  }
+  full_updates_++;
+  regions_ = regions;
+  bands_.clear();
+  int top = std::numeric_limits<int>::max();
+  int bottom = std::numeric_limits<int>::min();
+  for (const auto& region : regions_) {
+    if (region.bounds.IsEmpty())
+      continue;
+    top = std::min(top, region.bounds.y());
+    bottom = std::max(bottom, region.bounds.bottom());
+  }
+  Rebuild(top, bottom);
+  return true;
+}
+
+bool DraggableRegionIndex::ApplyChanges(size_t count, const std::vector<DraggableRegionChange>& changes) {
+  for (const auto& change : changes) {
+    if (change.index >= count) {
+      return false;
+    }
+  }
+  int top = std::numeric_limits<int>::max();
+  int bottom = std::numeric_limits<int>::min();
+  auto invalidate = [&top, &bottom](const gfx::Rect& bounds) {
+    if (bounds.IsEmpty())
+      return;
+    top = std::min(top, bounds.y());
+    bottom = std::max(bottom, bounds.bottom());
+  };
+  for (size_t i = count; i < regions_.size(); ++i) {
+    invalidate(regions_[i].bounds);
+  }
+  regions_.resize(count);
+  for (const auto& change : changes) {
+    DraggableRegion& region = regions_[change.index];
+    if (region == change.region)
+      continue;
+    invalidate(region.bounds);
+    invalidate(change.region.bounds);
+    region = change.region;
+  }
+  if (top >= bottom) {
+    unchanged_updates_++;
+    return true;
+  }
+  change_updates_++;
+  Rebuild(top, bottom);
+  return true;
+}
+
+void DraggableRegionIndex::Rebuild(int top, int bottom) {
+  if (top >= bottom) {
+    return;
+  }
+  base::TimeTicks start = base::TimeTicks::Now();
+  // the bands crossing the edges are rebuilt whole.
+  auto first = std::upper_bound(bands_.begin(), bands_.end(), top, [](int y, const Band& band) { return y < band.bottom; });
+  if (first != bands_.end() && first->top < top) {
+    top = first->top;
+  }
+  auto last = std::lower_bound(first, bands_.end(), bottom, [](const Band& band, int y) { return band.top < y; });
+  if (last != first && (last - 1)->bottom > bottom) {
+    bottom = (last - 1)->bottom;
+  }
+
+  std::vector<int> edges = {top, bottom};
+  for (const auto& region : regions_) {
+    const gfx::Rect& bounds = region.bounds;
+    if (bounds.IsEmpty() || bounds.y() >= bottom || bounds.bottom() <= top)
+      continue;
+    if (bounds.y() > top)
+      edges.push_back(bounds.y());
+    if (bounds.bottom() < bottom)
+      edges.push_back(bounds.bottom());
+  }
+  std::sort(edges.begin(), edges.end());
+  edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+  std::vector<Band> rebuilt(edges.size() - 1);
+  for (size_t i = 0; i < rebuilt.size(); ++i) {
+    rebuilt[i].top = edges[i];
+    rebuilt[i].bottom = edges[i + 1];
+  }
+  for (const auto& region : regions_) {
+    const gfx::Rect& bounds = region.bounds;
+    if (bounds.IsEmpty() || bounds.y() >= bottom || bounds.bottom() <= top)
+      continue;
+    // the region starts and ends on an edge.
+    size_t begin = std::lower_bound(edges.begin(), edges.end(), std::max(bounds.y(), top)) - edges.begin();
+    size_t end = std::lower_bound(edges.begin(), edges.end(), std::min(bounds.bottom(), bottom)) - edges.begin();
+    for (size_t i = begin; i < end; ++i) {
+      if (region.draggable) {
+        AddSpan(&rebuilt[i].spans, bounds.x(), bounds.right());
+      } else {
+        SubtractSpan(&rebuilt[i].spans, bounds.x(), bounds.right());
+      }
+    }
+  }
+  rebuilt.erase(std::remove_if(rebuilt.begin(), rebuilt.end(), [](const Band& band) { return band.spans.empty(); }), rebuilt.end());
+
+  auto pos = bands_.erase(first, last);
+  bands_.insert(pos, rebuilt.begin(), rebuilt.end());
+  bands_rebuilt_ += static_cast<int>(rebuilt.size());
+  rebuild_time_ += base::TimeTicks::Now() - start;
+}
+
+// static
+void DraggableRegionIndex::AddSpan(std::vector<Span>* spans, int left, int right) {
+  std::vector<Span> result;
+  result.reserve(spans->size() + 1);
+  bool added = false;
+  for (const auto& span : *spans) {
+    if (span.second < left) {
+      result.push_back(span);
+    } else if (span.first > right) {
+      if (!added) {
+        result.push_back(Span(left, right));
+        added = true;
+      }
+      result.push_back(span);
+    } else {
+      // overlapping or adjacent.
+      left = std::min(left, span.first);
+      right = std::max(right, span.second);
+    }
+  }
+  if (!added) {
+    result.push_back(Span(left, right));
+  }
+  spans->swap(result);
+}
+
+// static
+void DraggableRegionIndex::SubtractSpan(std::vector<Span>* spans, int left, int right) {
+  std::vector<Span> result;
+  result.reserve(spans->size() + 1);
+  for (const auto& span : *spans) {
+    if (span.second <= left || span.first >= right) {
+      result.push_back(span);
+      continue;
+    }
+    if (span.first < left)
+      result.push_back(Span(span.first, left));
+    if (right < span.second)
+      result.push_back(Span(right, span.second));
+  }
+  spans->swap(result);
+}
+
+void DraggableRegionIndex::Clear(void) {
+  regions_.clear();
+  bands_.clear();
+}
+
+bool DraggableRegionIndex::Contains(const gfx::Point& point) const {
+  base::TimeTicks start = base::TimeTicks::Now();
+  bool contains = false;
+  auto band = std::upper_bound(bands_.begin(), bands_.end(), point.y(), [](int y, const Band& b) { return y < b.top; });
+  if (band != bands_.begin() && point.y() < (--band)->bottom) {
+    auto span = std::upper_bound(band->spans.begin(), band->spans.end(), point.x(), [](int x, const Span& s) { return x < s.first; });
+    contains = span != band->spans.begin() && point.x() < (--span)->second;
+  }
+  hit_tests_++;
+  hit_test_time_ += base::TimeTicks::Now() - start;
+  return contains;
+}
+
+std::vector<gfx::Rect> DraggableRegionIndex::GetNonDraggableRects(int width, int height) const {
+  std::vector<gfx::Rect> result;
+  auto add_row = [&result, width](int top, int bottom, const std::vector<Span>& spans) {
+    int x = 0;
+    for (const auto& span : spans) {
+      if (x >= width)
+        break;
+      int right = std::min(span.first, width);
+      if (right > x)
+        result.push_back(gfx::Rect(x, top, right - x, bottom - top));
+      x = std::max(x, span.second);
+    }
+    if (x < width)
+      result.push_back(gfx::Rect(x, top, width - x, bottom - top));
+  };
+  const std::vector<Span> none;
+  int y = 0;
+  for (const auto& band : bands_) {
+    int top = std::max(band.top, y);
+    int bottom = std::min(band.bottom, height);
+    if (top >= bottom)
+      continue;
+    if (top > y)
+      add_row(y, top, none);
+    add_row(top, bottom, band.spans);
+    y = bottom;
+  }
+  if (y < height)
+    add_row(y, height, none);
+  return result;
+}
+
+std::unique_ptr<base::DictionaryValue> DraggableRegionIndex::GetStatistics(void) const {
+  std::unique_ptr<base::DictionaryValue> stats(new base::DictionaryValue());
+  stats->SetInteger("regions", static_cast<int>(regions_.size()));
+  stats->SetInteger("bands", static_cast<int>(bands_.size()));
+  stats->SetInteger("fullUpdates", full_updates_);
+  stats->SetInteger("changeUpdates", change_updates_);
+  stats->SetInteger("unchangedUpdates", unchanged_updates_);
+  stats->SetInteger("bandsRebuilt", bands_rebuilt_);
+  // milliseconds, in total.
+  stats->SetDouble("rebuildTime", rebuild_time_.InMillisecondsF());
+  stats->SetInteger("hitTests", hit_tests_);
+  stats->SetDouble("hitTestTime", hit_test_time_.InMillisecondsF());
+  return stats;
+}
+}
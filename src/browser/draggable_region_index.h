@@ -0,0 +1,69 @@
+//-*-c++-*-
+#pragma once
+
+#include <memory>
+#include <utility>
+#include <vector>
+#include "base/macros.h"
+#include "base/time/time.h"
+#include "base/values.h"
+#include "common/draggable_region.h"
+#include "ui/gfx/geometry/point.h"
+
+namespace meson {
+// The draggable area of a frameless window, as horizontal bands each holding
+// the sorted draggable x spans, so that a hit test is two binary searches.
+// The regions are applied in order (draggable ones added, the others cut
+// out), and a change only rebuilds the bands its old and new bounds cover.
+class DraggableRegionIndex {
+ public:
+  DraggableRegionIndex(void);
+  ~DraggableRegionIndex(void);
+
+  // false if the regions are the same.
+  bool SetRegions(const std::vector<DraggableRegion>& regions);
+  // keeps |count| regions and replaces the changed ones.
+  // false if a change is out of the list.
+  bool ApplyChanges(size_t count, const std::vector<DraggableRegionChange>& changes);
+  // forgets the regions, not counted as an update.
+  void Clear(void);
+
+  bool Contains(const gfx::Point& point) const;
+  // the rest of (0, 0, width, height).
+  std::vector<gfx::Rect> GetNonDraggableRects(int width, int height) const;
+  const std::vector<DraggableRegion>& regions(void) const { return regions_; }
+
+  // {regions, bands, fullUpdates, changeUpdates, unchangedUpdates,
+  //  bandsRebuilt, rebuildTime, hitTests, hitTestTime}
+  std::unique_ptr<base::DictionaryValue> GetStatistics(void) const;
+
+ private:
+  // [left, right)
+  using Span = std::pair<int, int>;
+  struct Band {
+    Band();
+    ~Band();
+    int top;
+    int bottom;
+    std::vector<Span> spans;
+  };
+  // rebuilds the bands between |top| and |bottom|.
+  void Rebuild(int top, int bottom);
+  static void AddSpan(std::vector<Span>* spans, int left, int right);
+  static void SubtractSpan(std::vector<Span>* spans, int left, int right);
+
+ private:
+  std::vector<DraggableRegion> regions_;
+  // sorted, with no overlap. there is no band where nothing is draggable.
+  std::vector<Band> bands_;
+
+  int full_updates_;
+  int change_updates_;
+  int unchanged_updates_;
+  int bands_rebuilt_;
+  base::TimeDelta rebuild_time_;
+  mutable int hit_tests_;
+  mutable base::TimeDelta hit_test_time_;
+  DISALLOW_COPY_AND_ASSIGN(DraggableRegionIndex);
+};
+}
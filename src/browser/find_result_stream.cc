@@ -0,0 +1,138 @@
+#include "browser/find_result_stream.h"
+
+#include "base/bind.h"
+
+namespace meson {
+namespace {
+// column order of an update.
+const char* kFindUpdateSchema[] = {
+    "matches", "activeMatchOrdinal", "x", "y", "width", "height", "time",
+};
+}
+
+FindResultStream::FindResultStream(const FlushCallback& callback)
+    : callback_(callback),
+      active_(false),
+      request_id_(0),
+      got_first_result_(false),
+      matches_(0),
+      active_match_ordinal_(0),
+      requests_(0),
+      updates_(0),
+      batches_(0),
+      cancelled_(0),
+      last_first_result_ms_(-1.0),
+      last_final_result_ms_(-1.0) {
+}
+
+FindResultStream::~FindResultStream(void) {
+}
+
+void FindResultStream::Start(int request_id, const base::TimeDelta& batch_interval) {
+  if (active_) {
+    Cancel();
+  }
+  active_ = true;
+  request_id_ = request_id;
+  batch_interval_ = batch_interval;
+  start_time_ = base::TimeTicks::Now();
+  got_first_result_ = false;
+  matches_ = 0;
+  active_match_ordinal_ = 0;
+  selection_rect_ = gfx::Rect();
+  pending_.reset();
+  requests_++;
+}
+
+void FindResultStream::AddUpdate(int request_id, int number_of_matches, const gfx::Rect& selection_rect, int active_match_ordinal, bool final_update) {
+  if (!IsActive(request_id)) {
+    return;
+  }
+  if (number_of_matches != -1) {
+    matches_ = number_of_matches;
+  }
+  if (active_match_ordinal != -1) {
+    active_match_ordinal_ = active_match_ordinal;
+  }
+  if (!selection_rect.IsEmpty()) {
+    selection_rect_ = selection_rect;
+  }
+  double time = (base::TimeTicks::Now() - start_time_).InMillisecondsF();
+
+  std::unique_ptr<base::ListValue> update(new base::ListValue());
+  update->AppendInteger(matches_);
+  update->AppendInteger(active_match_ordinal_);
+  update->AppendInteger(selection_rect_.x());
+  update->AppendInteger(selection_rect_.y());
+  update->AppendInteger(selection_rect_.width());
+  update->AppendInteger(selection_rect_.height());
+  update->AppendDouble(time);
+  if (!pending_) {
+    pending_.reset(new base::ListValue());
+  }
+  pending_->Append(std::move(update));
+  updates_++;
+
+  if (final_update) {
+    last_final_result_ms_ = time;
+    Flush(true, false);
+  } else if (!got_first_result_ && matches_ > 0) {
+    // the first match is sent at once, the rest is batched.
+    got_first_result_ = true;
+    last_first_result_ms_ = time;
+    Flush(false, false);
+  } else if (batch_interval_.is_zero()) {
+    Flush(false, false);
+  } else if (!flush_timer_.IsRunning()) {
+    flush_timer_.Start(FROM_HERE, batch_interval_, base::Bind(&FindResultStream::OnFlushTimer, base::Unretained(this)));
+  }
+}
+
+void FindResultStream::Cancel(void) {
+  if (!active_) {
+    return;
+  }
+  cancelled_++;
+  Flush(true, true);
+}
+
+std::unique_ptr<base::DictionaryValue> FindResultStream::GetStatistics(void) const {
+  std::unique_ptr<base::DictionaryValue> stats(new base::DictionaryValue());
+  stats->SetInteger("requests", requests_);
+  stats->SetInteger("updates", updates_);
+  stats->SetInteger("batches", batches_);
+  stats->SetInteger("cancelled", cancelled_);
+  // of the last request, -1 if none.
+  stats->SetDouble("timeToFirstResult", last_first_result_ms_);
+  stats->SetDouble("timeToFinalResult", last_final_result_ms_);
+  return stats;
+}
+
+void FindResultStream::OnFlushTimer(void) {
+  Flush(false, false);
+}
+
+void FindResultStream::Flush(bool final_update, bool cancelled) {
+  flush_timer_.Stop();
+  if (!final_update && (!pending_ || pending_->empty())) {
+    return;
+  }
+  std::unique_ptr<base::DictionaryValue> batch(new base::DictionaryValue());
+  std::unique_ptr<base::ListValue> schema(new base::ListValue());
+  for (const char* column : kFindUpdateSchema) {
+    schema->AppendString(column);
+  }
+  batch->SetInteger("requestId", request_id_);
+  batch->Set("schema", std::move(schema));
+  batch->Set("updates", pending_ ? std::move(pending_) : std::unique_ptr<base::ListValue>(new base::ListValue()));
+  batch->SetInteger("matches", matches_);
+  batch->SetInteger("activeMatchOrdinal", active_match_ordinal_);
+  batch->SetBoolean("finalUpdate", final_update);
+  batch->SetBoolean("cancelled", cancelled);
+  if (final_update) {
+    active_ = false;
+  }
+  batches_++;
+  callback_.Run(std::move(batch));
+}
+}
@@ -0,0 +1,57 @@
+//-*-c++-*-
+#pragma once
+
+#include <memory>
+#include "base/callback.h"
+#include "base/macros.h"
+#include "base/time/time.h"
+#include "base/timer/timer.h"
+#include "base/values.h"
+#include "ui/gfx/geometry/rect.h"
+
+namespace meson {
+// Streams the intermediate replies of one find request in batches.
+// The renderer reports the match count while it scans the page, so the host
+// gets the first result long before the final one on large documents.
+class FindResultStream {
+ public:
+  // {requestId, schema, updates, matches, activeMatchOrdinal, finalUpdate, cancelled}
+  using FlushCallback = base::Callback<void(std::unique_ptr<base::DictionaryValue>)>;
+
+  explicit FindResultStream(const FlushCallback& callback);
+  ~FindResultStream(void);
+
+  // a new request replaces (and cancels) the current one.
+  void Start(int request_id, const base::TimeDelta& batch_interval);
+  bool IsActive(int request_id) const { return active_ && request_id == request_id_; }
+  // -1 and an empty rect mean "unchanged", as in WebContentsDelegate::FindReply().
+  void AddUpdate(int request_id, int number_of_matches, const gfx::Rect& selection_rect, int active_match_ordinal, bool final_update);
+  void Cancel(void);
+  std::unique_ptr<base::DictionaryValue> GetStatistics(void) const;
+
+ private:
+  void Flush(bool final_update, bool cancelled);
+  void OnFlushTimer(void);
+
+ private:
+  FlushCallback callback_;
+  bool active_;
+  int request_id_;
+  base::TimeDelta batch_interval_;
+  base::TimeTicks start_time_;
+  bool got_first_result_;
+  int matches_;
+  int active_match_ordinal_;
+  gfx::Rect selection_rect_;
+  std::unique_ptr<base::ListValue> pending_;
+  base::OneShotTimer flush_timer_;
+
+  int requests_;
+  int updates_;
+  int batches_;
+  int cancelled_;
+  double last_first_result_ms_;
+  double last_final_result_ms_;
+  DISALLOW_COPY_AND_ASSIGN(FindResultStream);
+};
+}
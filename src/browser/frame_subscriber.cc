@@ -0,0 +1,134 @@
+#include "browser/frame_subscriber.h"
+
+#include <algorithm>
+#include <cmath>
+#include "base/bind.h"
+#include "base/bind_helpers.h"
+#include "content/public/browser/render_widget_host.h"
+#include "content/public/browser/render_widget_host_view.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+#include "ui/gfx/geometry/size_conversions.h"
+
+namespace meson {
+namespace {
+const int kBytesPerPixel = 4;
+}
+
+FrameSubscriber::FrameSubscriber(content::RenderWidgetHostView* view,
+                                 scoped_refptr<FrameRingBuffer> ring,
+                                 bool only_dirty,
+                                 const FrameCallback& callback)
+    : view_(view),
+      ring_(ring),
+      only_dirty_(only_dirty),
+      callback_(callback),
+      readback_pending_(false),
+      frame_rate_(0),
+      frame_rate_cap_(0),
+      weak_factory_(this) {
+}
+
+FrameSubscriber::~FrameSubscriber() {
+}
+
+bool FrameSubscriber::ShouldCaptureFrame(const gfx::Rect& damage_rect,
+                                         base::TimeTicks present_time,
+                                         scoped_refptr<media::VideoFrame>* storage,
+                                         DeliverFrameCallback* callback) {
+  if (!view_ || !view_->GetRenderWidgetHost())
+    return false;
+
+  pending_damage_.Union(damage_rect);
+  if (pending_damage_.IsEmpty())
+    return false;
+
+  // the damage of a skipped frame goes into the next capture.
+  if (!CaptureFrame())
+    ring_->AddSkipped();
+  // the frame is read back from the backing store, not delivered here.
+  return false;
+}
+
+bool FrameSubscriber::CaptureFrame(void) {
+  const auto host = view_ ? view_->GetRenderWidgetHost() : nullptr;
+  if (!host || pending_damage_.IsEmpty())
+    return false;
+
+  if (readback_pending_) {
+    // don't queue readbacks, OnFrameDelivered captures again.
+    return false;
+  }
+
+  base::TimeTicks now = base::TimeTicks::Now();
+  const int frame_rate = GetEffectiveFrameRate();
+  if (frame_rate > 0 && !last_capture_time_.is_null()) {
+    base::TimeDelta interval = base::TimeDelta::FromSeconds(1) / frame_rate;
+    base::TimeDelta elapsed = now - last_capture_time_;
+    if (elapsed < interval) {
+      if (!trailing_frame_timer_.IsRunning()) {
+        trailing_frame_timer_.Start(FROM_HERE, interval - elapsed, base::Bind(base::IgnoreResult(&FrameSubscriber::CaptureFrame), base::Unretained(this)));
+      }
+      return false;
+    }
+  }
+  last_capture_time_ = now;
+
+  gfx::Rect view_rect(view_->GetVisibleViewportSize());
+  gfx::Rect dirty_rect = gfx::IntersectRects(pending_damage_, view_rect);
+  gfx::Rect rect = only_dirty_ ? dirty_rect : view_rect;
+  pending_damage_ = gfx::Rect();
+  if (rect.IsEmpty())
+    return false;
+
+  // downscale during readback when the frame does not fit into a slot.
+  gfx::Size output_size = rect.size();
+  const double bytes = static_cast<double>(output_size.GetArea()) * kBytesPerPixel;
+  if (bytes > ring_->GetSlotSize()) {
+    output_size = gfx::ScaleToFlooredSize(output_size, std::sqrt(ring_->GetSlotSize() / bytes));
+    if (output_size.IsEmpty())
+      return false;
+  }
+
+  readback_pending_ = true;
+  host->CopyFromBackingStore(rect, output_size,
+                             base::Bind(&FrameSubscriber::OnFrameDelivered, weak_factory_.GetWeakPtr(), dirty_rect),
+                             kBGRA_8888_SkColorType);
+  return true;
+}
+
+void FrameSubscriber::SetFrameRate(int frame_rate) {
+  frame_rate_ = std::max(frame_rate, 0);
+}
+
+void FrameSubscriber::SetFrameRateCap(int frame_rate_cap) {
+  frame_rate_cap_ = std::max(frame_rate_cap, 0);
+}
+
+int FrameSubscriber::GetEffectiveFrameRate(void) const {
+  if (frame_rate_cap_ == 0)
+    return frame_rate_;
+  if (frame_rate_ == 0)
+    return frame_rate_cap_;
+  return std::min(frame_rate_, frame_rate_cap_);
+}
+
+void FrameSubscriber::Invalidate(void) {
+  if (!view_)
+    return;
+  pending_damage_ = gfx::Rect(view_->GetVisibleViewportSize());
+  CaptureFrame();
+}
+
+void FrameSubscriber::OnFrameDelivered(const gfx::Rect& dirty_rect, const SkBitmap& bitmap, content::ReadbackResponse response) {
+  readback_pending_ = false;
+  // the damage that came in meanwhile.
+  CaptureFrame();
+  if (response != content::ReadbackResponse::READBACK_SUCCESS)
+    return;
+
+  unsigned int sequence = 0;
+  if (!ring_->Write(bitmap, dirty_rect, &sequence))
+    return;
+  callback_.Run(sequence, dirty_rect, gfx::Size(bitmap.width(), bitmap.height()));
+}
+}
@@ -0,0 +1,74 @@
+//-*-c++-*-
+#pragma once
+
+#include "base/callback.h"
+#include "base/memory/weak_ptr.h"
+#include "base/time/time.h"
+#include "base/timer/timer.h"
+#include "content/public/browser/readback_types.h"
+#include "content/public/browser/render_widget_host_view_frame_subscriber.h"
+#include "ui/gfx/geometry/rect.h"
+#include "api/api_frame_ring_buffer.h"
+
+class SkBitmap;
+
+namespace content {
+class RenderWidgetHostView;
+}
+
+namespace meson {
+// Copies the frames of a view into a FrameRingBuffer.
+// Only one readback is in flight at a time, and at most |frame_rate| per
+// second; damage of the frames skipped meanwhile is merged into the next one,
+// which is read back from the backing store once the limit allows it.
+class FrameSubscriber : public content::RenderWidgetHostViewFrameSubscriber {
+ public:
+  // (sequence, dirty_rect, frame_size)
+  using FrameCallback = base::Callback<void(unsigned int, const gfx::Rect&, const gfx::Size&)>;
+
+  FrameSubscriber(content::RenderWidgetHostView* view,
+                  scoped_refptr<FrameRingBuffer> ring,
+                  bool only_dirty,
+                  const FrameCallback& callback);
+  ~FrameSubscriber() override;
+
+  bool ShouldCaptureFrame(const gfx::Rect& damage_rect,
+                          base::TimeTicks present_time,
+                          scoped_refptr<media::VideoFrame>* storage,
+                          DeliverFrameCallback* callback) override;
+
+  // 0 means unlimited.
+  void SetFrameRate(int frame_rate);
+  int GetFrameRate(void) const { return frame_rate_; }
+  // Limits the frame rate below the one set, e.g. while throttled. 0 means none.
+  void SetFrameRateCap(int frame_rate_cap);
+  // Captures the whole view with the next frame.
+  void Invalidate(void);
+
+  base::WeakPtr<FrameSubscriber> GetWeakPtr(void) { return weak_factory_.GetWeakPtr(); }
+  // the view which owns this subscriber.
+  content::RenderWidgetHostView* view(void) const { return view_; }
+
+ private:
+  // false if the capture is deferred (or there is nothing to capture).
+  bool CaptureFrame(void);
+  int GetEffectiveFrameRate(void) const;
+  void OnFrameDelivered(const gfx::Rect& dirty_rect, const SkBitmap& bitmap, content::ReadbackResponse response);
+
+ private:
+  content::RenderWidgetHostView* view_;
+  scoped_refptr<FrameRingBuffer> ring_;
+  bool only_dirty_;
+  FrameCallback callback_;
+  bool readback_pending_;
+  gfx::Rect pending_damage_;
+  int frame_rate_;
+  int frame_rate_cap_;
+  base::TimeTicks last_capture_time_;
+  // captures the damage skipped by the frame rate limit.
+  base::OneShotTimer trailing_frame_timer_;
+
+  base::WeakPtrFactory<FrameSubscriber> weak_factory_;
+  DISALLOW_COPY_AND_ASSIGN(FrameSubscriber);
+};
+}
@@ -0,0 +1,290 @@
+#include "browser/guest_process_policy.h"
+
+#include <iterator>
+#include <set>
+#include "base/logging.h"
+#include "base/process/process_metrics.h"
+#include "content/public/browser/browser_child_process_host.h"
+#include "content/public/browser/render_process_host.h"
+#include "content/public/browser/site_instance.h"
+
+namespace meson {
+namespace {
+// the site of every guest, see WebContentsBinding.
+const char kGuestSiteURL[] = "chrome-guest::/fake-host";
+}
+
+GuestProcessPolicy::Instance::Instance()
+    : mode(PER_GUEST),
+      embedder_id(0),
+      guests(0) {
+}
+
+GuestProcessPolicy::Instance::~Instance() {
+}
+
+GuestProcessPolicy::GuestProcessPolicy(void)
+    : mode_(PER_GUEST),
+      max_processes_(4) {
+}
+
+GuestProcessPolicy::~GuestProcessPolicy(void) {
+}
+
+bool GuestProcessPolicy::Configure(const base::DictionaryValue& options) {
+  Mode mode = mode_;
+  int max_processes = max_processes_;
+  std::string mode_str;
+  if (options.GetString("mode", &mode_str)) {
+    if (mode_str == "per-guest") {
+      mode = PER_GUEST;
+    } else if (mode_str == "per-origin") {
+      mode = PER_ORIGIN;
+    } else if (mode_str == "capped") {
+      mode = CAPPED;
+    } else {
+      return false;
+    }
+  }
+  options.GetInteger("maxProcesses", &max_processes);
+  if (max_processes < 1) {
+    return false;
+  }
+  mode_ = mode;
+  max_processes_ = max_processes;
+  return true;
+}
+
+// static
+std::string GuestProcessPolicy::GetOrigin(const GURL& url) {
+  GURL origin = url.is_valid() ? url.GetOrigin() : GURL();
+  // empty: nothing to share with.
+  return origin.is_empty() ? std::string() : origin.spec();
+}
+
+GuestProcessPolicy::InstanceList::iterator GuestProcessPolicy::FindInstance(Mode mode, int embedder_id, const std::string& origin) {
+  for (auto iter = instances_.begin(); iter != instances_.end(); ++iter) {
+    if (iter->mode == mode && iter->embedder_id == embedder_id && iter->origin == origin) {
+      return iter;
+    }
+  }
+  return instances_.end();
+}
+
+GuestProcessPolicy::InstanceList::iterator GuestProcessPolicy::FindInstance(const content::SiteInstance* site_instance) {
+  for (auto iter = instances_.begin(); iter != instances_.end(); ++iter) {
+    if (iter->site_instance.get() == site_instance) {
+      return iter;
+    }
+  }
+  return instances_.end();
+}
+
+GuestProcessPolicy::InstanceList::iterator GuestProcessPolicy::FindCappedInstance(int embedder_id) {
+  int processes = 0;
+  auto lru = instances_.end();
+  for (auto iter = instances_.begin(); iter != instances_.end(); ++iter) {
+    if (iter->mode != CAPPED) {
+      continue;
+    }
+    processes++;
+    if (iter->embedder_id == embedder_id) {
+      lru = iter;
+    }
+  }
+  return processes >= max_processes_ ? lru : instances_.end();
+}
+
+GuestProcessPolicy::InstanceList::iterator GuestProcessPolicy::CreateInstance(content::BrowserContext* browser_context, Mode mode, int embedder_id, const std::string& origin) {
+  // instances created for a navigation which never happened.
+  for (auto iter = instances_.begin(); iter != instances_.end();) {
+    iter = iter->guests == 0 ? instances_.erase(iter) : std::next(iter);
+  }
+  Instance instance;
+  instance.site_instance = content::SiteInstance::CreateForURL(browser_context, GURL(kGuestSiteURL));
+  instance.mode = mode;
+  instance.embedder_id = embedder_id;
+  instance.origin = origin;
+  instances_.push_front(instance);
+  metrics_[mode].processes++;
+  return instances_.begin();
+}
+
+void GuestProcessPolicy::Touch(InstanceList::iterator iter) {
+  instances_.splice(instances_.begin(), instances_, iter);
+}
+
+void GuestProcessPolicy::RemoveGuestFromInstance(InstanceList::iterator iter) {
+  if (--iter->guests == 0) {
+    // the process goes away with its last guest.
+    instances_.erase(iter);
+  }
+}
+
+scoped_refptr<content::SiteInstance> GuestProcessPolicy::AcquireSiteInstance(content::BrowserContext* browser_context,
+                                                                             int guest_instance_id,
+                                                                             int embedder_id,
+                                                                             const GURL& url) {
+  ReleaseGuest(guest_instance_id);
+  Metrics& metrics = metrics_[mode_];
+  metrics.guests++;
+
+  auto iter = instances_.end();
+  std::string origin;
+  if (mode_ != PER_GUEST) {
+    origin = GetOrigin(url);
+    if (!origin.empty()) {
+      iter = FindInstance(mode_, embedder_id, origin);
+    }
+    if (iter == instances_.end() && mode_ == CAPPED) {
+      iter = FindCappedInstance(embedder_id);
+    }
+  }
+
+  if (iter != instances_.end()) {
+    metrics.shared_guests++;
+  } else {
+    iter = CreateInstance(browser_context, mode_, embedder_id, origin);
+  }
+  Touch(iter);
+  iter->guests++;
+  guests_[guest_instance_id] = iter;
+  LOG(INFO) << __PRETTY_FUNCTION__ << " : " << guest_instance_id << " " << ModeToString(mode_) << " (" << embedder_id << " " << iter->origin << ") guests:" << iter->guests;
+  return iter->site_instance;
+}
+
+void GuestProcessPolicy::ReleaseGuest(int guest_instance_id) {
+  auto fiter = guests_.find(guest_instance_id);
+  if (fiter == guests_.end()) {
+    return;
+  }
+  auto iter = (*fiter).second;
+  guests_.erase(fiter);
+  RemoveGuestFromInstance(iter);
+}
+
+bool GuestProcessPolicy::GetSiteInstanceForNavigation(content::BrowserContext* browser_context,
+                                                      content::SiteInstance* current,
+                                                      const GURL& url,
+                                                      scoped_refptr<content::SiteInstance>* target) {
+  auto iter = FindInstance(current);
+  if (iter == instances_.end() || iter->mode == PER_GUEST) {
+    return false;
+  }
+  *target = current;
+  std::string origin = GetOrigin(url);
+  if (origin.empty() || origin == iter->origin) {
+    return true;
+  }
+  // the group of the new origin, of the same embedder only.
+  auto to = FindInstance(iter->mode, iter->embedder_id, origin);
+  if (to == instances_.end()) {
+    if (iter->mode == CAPPED && FindCappedInstance(iter->embedder_id) != instances_.end()) {
+      // no room for another process.
+      return true;
+    }
+    // the guest is counted in once it has moved, see GuestSiteInstanceChanged.
+    to = CreateInstance(browser_context, iter->mode, iter->embedder_id, origin);
+  }
+  *target = to->site_instance;
+  return true;
+}
+
+void GuestProcessPolicy::GuestSiteInstanceChanged(int guest_instance_id, content::SiteInstance* site_instance) {
+  auto fiter = guests_.find(guest_instance_id);
+  if (fiter == guests_.end() || (*fiter).second->site_instance.get() == site_instance) {
+    return;
+  }
+  auto from = (*fiter).second;
+  auto to = FindInstance(site_instance);
+  if (to == instances_.end()) {
+    // e.g. a per-guest instance created for the navigation.
+    guests_.erase(fiter);
+  } else {
+    to->guests++;
+    Touch(to);
+    (*fiter).second = to;
+  }
+  RemoveGuestFromInstance(from);
+}
+
+void GuestProcessPolicy::RecordSpawn(int guest_instance_id, base::TimeDelta spawn) {
+  auto fiter = guests_.find(guest_instance_id);
+  if (fiter == guests_.end()) {
+    return;
+  }
+  Metrics& metrics = metrics_[(*fiter).second->mode];
+  metrics.spawns++;
+  metrics.spawn_time += spawn;
+}
+
+void GuestProcessPolicy::RecordFirstPaint(int guest_instance_id, base::TimeDelta first_paint) {
+  auto fiter = guests_.find(guest_instance_id);
+  if (fiter == guests_.end()) {
+    return;
+  }
+  Metrics& metrics = metrics_[(*fiter).second->mode];
+  metrics.first_paints++;
+  metrics.first_paint_time += first_paint;
+}
+
+std::unique_ptr<base::DictionaryValue> GuestProcessPolicy::GetStatistics(void) const {
+  int live_guests[MODE_COUNT] = {};
+  std::set<base::ProcessHandle> processes[MODE_COUNT];
+  for (const auto& instance : instances_) {
+    live_guests[instance.mode] += instance.guests;
+    if (!instance.site_instance->HasProcess()) {
+      continue;
+    }
+    base::ProcessHandle handle = instance.site_instance->GetProcess()->GetHandle();
+    if (handle != base::kNullProcessHandle) {
+      processes[instance.mode].insert(handle);
+    }
+  }
+
+  std::unique_ptr<base::DictionaryValue> policies(new base::DictionaryValue());
+  for (int i = 0; i < MODE_COUNT; ++i) {
+    const Metrics& metrics = metrics_[i];
+    size_t working_set_size = 0;
+    for (base::ProcessHandle handle : processes[i]) {
+#if defined(OS_MACOSX)
+      auto process_metrics = base::ProcessMetrics::CreateProcessMetrics(handle, content::BrowserChildProcessHost::GetPortProvider());
+#else
+      auto process_metrics = base::ProcessMetrics::CreateProcessMetrics(handle);
+#endif
+      working_set_size += process_metrics->GetWorkingSetSize();
+    }
+    std::unique_ptr<base::DictionaryValue> stats(new base::DictionaryValue());
+    stats->SetInteger("guests", metrics.guests);
+    stats->SetInteger("processes", metrics.processes);
+    stats->SetInteger("sharedGuests", metrics.shared_guests);
+    stats->SetInteger("liveGuests", live_guests[i]);
+    stats->SetInteger("liveProcesses", static_cast<int>(processes[i].size()));
+    // bytes, of the live processes.
+    stats->SetDouble("workingSetSize", static_cast<double>(working_set_size));
+    // averages in milliseconds.
+    stats->SetDouble("spawnTime", metrics.spawns ? metrics.spawn_time.InMillisecondsF() / metrics.spawns : 0.0);
+    stats->SetDouble("firstPaintTime", metrics.first_paints ? metrics.first_paint_time.InMillisecondsF() / metrics.first_paints : 0.0);
+    policies->Set(ModeToString(static_cast<Mode>(i)), std::move(stats));
+  }
+
+  std::unique_ptr<base::DictionaryValue> result(new base::DictionaryValue());
+  result->SetString("mode", ModeToString(mode_));
+  result->SetInteger("maxProcesses", max_processes_);
+  result->Set("policies", std::move(policies));
+  return result;
+}
+
+// static
+const char* GuestProcessPolicy::ModeToString(Mode mode) {
+  switch (mode) {
+  case PER_GUEST:
+    return "per-guest";
+  case PER_ORIGIN:
+    return "per-origin";
+  case CAPPED:
+    return "capped";
+  }
+  return "unknown";
+}
+}
@@ -0,0 +1,113 @@
+//-*-c++-*-
+#pragma once
+
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/time/time.h"
+#include "base/values.h"
+#include "url/gurl.h"
+
+namespace content {
+class BrowserContext;
+class SiteInstance;
+}
+
+namespace meson {
+// Decides which renderer process a <webview> guest of a session is created in.
+//  PER_GUEST:    every guest has its own process (the default).
+//  PER_ORIGIN:   the guests of an embedder with the same origin share one.
+//  CAPPED:       at most |max_processes| guest processes. a guest goes to the
+//                process of its embedder and origin if there is one, then to
+//                a new one, and past the cap to the least recently used one
+//                of its embedder.
+// Guests sharing a process share its site instance (and browsing instance),
+// so only the guests of the same embedder are grouped; the policy belongs to
+// the session, i.e. the partition. The guests of an embedder without a
+// process yet get a new one even past the cap.
+// A shared guest navigating to another origin moves to the process of that
+// origin, or to a new one, unless the cap keeps it in place (see
+// MesonBrowserClient::OverrideSiteInstanceForNavigation).
+class GuestProcessPolicy {
+ public:
+  enum Mode {
+    PER_GUEST,
+    PER_ORIGIN,
+    CAPPED,
+  };
+  enum { MODE_COUNT = CAPPED + 1 };
+
+  GuestProcessPolicy(void);
+  ~GuestProcessPolicy(void);
+
+  // options: {mode: "per-guest" | "per-origin" | "capped", maxProcesses}
+  // applies to the guests created afterwards.
+  bool Configure(const base::DictionaryValue& options);
+  Mode mode(void) const { return mode_; }
+
+  // the site instance the guest is to be created in.
+  scoped_refptr<content::SiteInstance> AcquireSiteInstance(content::BrowserContext* browser_context,
+                                                           int guest_instance_id,
+                                                           int embedder_id,
+                                                           const GURL& url);
+  void ReleaseGuest(int guest_instance_id);
+  // true if |current| is shared by guests; |*target| is then the site
+  // instance to navigate to |url| in (|current| to stay).
+  bool GetSiteInstanceForNavigation(content::BrowserContext* browser_context,
+                                    content::SiteInstance* current,
+                                    const GURL& url,
+                                    scoped_refptr<content::SiteInstance>* target);
+  // the guest was moved to |site_instance| by a navigation.
+  void GuestSiteInstanceChanged(int guest_instance_id, content::SiteInstance* site_instance);
+
+  void RecordSpawn(int guest_instance_id, base::TimeDelta spawn);
+  void RecordFirstPaint(int guest_instance_id, base::TimeDelta first_paint);
+
+  // {mode, maxProcesses, policies: {"per-guest": {guests, processes, sharedGuests,
+  //  liveGuests, liveProcesses, workingSetSize, spawnTime, firstPaintTime}, ...}}
+  std::unique_ptr<base::DictionaryValue> GetStatistics(void) const;
+
+  static const char* ModeToString(Mode mode);
+
+ private:
+  struct Instance {
+    Instance();
+    ~Instance();
+    scoped_refptr<content::SiteInstance> site_instance;
+    Mode mode;
+    int embedder_id;
+    std::string origin;
+    int guests;
+  };
+  using InstanceList = std::list<Instance>;
+  struct Metrics {
+    int guests = 0;
+    int processes = 0;
+    int shared_guests = 0;
+    int spawns = 0;
+    base::TimeDelta spawn_time;
+    int first_paints = 0;
+    base::TimeDelta first_paint_time;
+  };
+  static std::string GetOrigin(const GURL& url);
+  InstanceList::iterator FindInstance(Mode mode, int embedder_id, const std::string& origin);
+  InstanceList::iterator FindInstance(const content::SiteInstance* site_instance);
+  // the least recently used instance of |embedder_id|, if the cap is reached.
+  InstanceList::iterator FindCappedInstance(int embedder_id);
+  InstanceList::iterator CreateInstance(content::BrowserContext* browser_context, Mode mode, int embedder_id, const std::string& origin);
+  void Touch(InstanceList::iterator iter);
+  void RemoveGuestFromInstance(InstanceList::iterator iter);
+
+ private:
+  Mode mode_;
+  int max_processes_;
+  // most recently used first.
+  InstanceList instances_;
+  std::map<int, InstanceList::iterator> guests_;
+  Metrics metrics_[MODE_COUNT];
+  DISALLOW_COPY_AND_ASSIGN(GuestProcessPolicy);
+};
+}
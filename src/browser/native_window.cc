@@ -29,8 +29,8 @@
 #include "content/public/browser/render_widget_host.h"
 #include "content/public/browser/render_widget_host_view.h"
 #include "content/public/common/content_switches.h"
+#include "content/public/common/result_codes.h"
 #include "ipc/ipc_message_macros.h"
-#include "third_party/skia/include/core/SkRegion.h"
 #include "ui/gfx/codec/png_codec.h"
 #include "ui/gfx/geometry/point.h"
 #include "ui/gfx/geometry/rect.h"
@@ -71,8 +71,12 @@ NativeWindow::NativeWindow(brightray::InspectableWebContents* inspectable_web_co
     : content::WebContentsObserver(inspectable_web_contents->GetWebContents()),
       has_frame_(true),
       transparent_(false),
+      draggable_regions_generation_(0),
+      draggable_regions_synced_(false),
+      draggable_regions_requested_(false),
       enable_larger_than_screen_(false),
       is_closed_(false),
+      unresponsive_watchdog_(this),
       sheet_offset_x_(0.0),
       sheet_offset_y_(0.0),
       aspect_ratio_(0.0),
@@ -102,6 +106,9 @@ NativeWindow::NativeWindow(brightray::InspectableWebContents* inspectable_web_co
 
   ui::GpuSwitchingManager::SetTransparent(transparent_);
 
+  // the contents may have sent its regions to another window already.
+  RequestDraggableRegions();
+
   WindowList::AddWindow(this);
 }
 
@@ -119,6 +126,14 @@ NativeWindow* NativeWindow::FromWebContents(content::WebContents* web_contents)
   return nullptr;
 }
 
+void NativeWindow::SetInspectableWebContents(brightray::InspectableWebContents* inspectable_web_contents) {
+  inspectable_web_contents_ = inspectable_web_contents;
+  Observe(inspectable_web_contents->GetWebContents());
+  // its renderer is already created.
+  unresponsive_watchdog_.Start();
+  RequestDraggableRegions();
+}
+
 void NativeWindow::InitFromOptions(const base::DictionaryValue& options) {
   // Setup window from options.
   int x = -1, y = -1;
@@ -381,7 +396,7 @@ void NativeWindow::RequestToClosePage() {
   // dialog when the window is busy executing some script withouth waiting for
   // the unresponsive timeout.
   if (window_unresposive_closure_.IsCancelled())
-    ScheduleUnresponsiveEvent(5000);
+    ScheduleUnresponsiveEvent(5000, "close-timeout");
 
   if (!web_contents())
     // Already closed by renderer
@@ -415,6 +430,7 @@ void NativeWindow::CloseContents(content::WebContents* source) {
 
   // Do not sent "unresponsive" event after window is closed.
   window_unresposive_closure_.Cancel();
+  unresponsive_watchdog_.Stop();
 }
 
 void NativeWindow::RendererUnresponsive(content::WebContents* source) {
@@ -425,13 +441,13 @@ void NativeWindow::RendererUnresponsive(content::WebContents* source) {
   // explicitly started a close timeout counter. This is on purpose because we
   // don't want the unresponsive event to be sent too early when user is closing
   // the window.
-  ScheduleUnresponsiveEvent(50);
+  ScheduleUnresponsiveEvent(50, "hang-monitor");
 }
 
 void NativeWindow::RendererResponsive(content::WebContents* source) {
   window_unresposive_closure_.Cancel();
-  for (NativeWindowObserver& observer : observers_)
-    observer.OnRendererResponsive();
+  // the watchdog sends the event, unless it has sent it already.
+  unresponsive_watchdog_.OnResponsive("hang-monitor");
 }
 
 void NativeWindow::NotifyWindowClosed() {
@@ -552,16 +568,9 @@ void NativeWindow::NotifyWindowMessage(UINT message, WPARAM w_param, LPARAM l_pa
 }
 #endif
 
-std::unique_ptr<SkRegion> NativeWindow::DraggableRegionsToSkRegion(const std::vector<DraggableRegion>& regions) {
-  std::unique_ptr<SkRegion> sk_region(new SkRegion);
-  for (const DraggableRegion& region : regions) {
-    sk_region->op(region.bounds.x(), region.bounds.y(), region.bounds.right(), region.bounds.bottom(),
-                  region.draggable ? SkRegion::kUnion_Op : SkRegion::kDifference_Op);
-  }
-  return sk_region;
-}
-
 void NativeWindow::RenderViewCreated(content::RenderViewHost* render_view_host) {
+  unresponsive_watchdog_.Start();
+
   if (!transparent_)
     return;
 
@@ -572,6 +581,17 @@ void NativeWindow::RenderViewCreated(content::RenderViewHost* render_view_host)
     impl->SetBackgroundOpaque(false);
 }
 
+void NativeWindow::RenderViewHostChanged(content::RenderViewHost* old_host, content::RenderViewHost* new_host) {
+  // the ping to the renderer before is never answered.
+  unresponsive_watchdog_.Start();
+  RequestDraggableRegions();
+  OnDraggableRegionsChanged();
+}
+
+void NativeWindow::RenderProcessGone(base::TerminationStatus status) {
+  unresponsive_watchdog_.Stop();
+}
+
 void NativeWindow::BeforeUnloadDialogCancelled() {
   WindowList::WindowCloseCancelled(this);
 
@@ -596,6 +616,9 @@ bool NativeWindow::OnMessageReceived(const IPC::Message& message) {
   bool handled = true;
   IPC_BEGIN_MESSAGE_MAP(NativeWindow, message)
     IPC_MESSAGE_HANDLER(MesonViewHostMsg_UpdateDraggableRegions, UpdateDraggableRegions)
+    IPC_MESSAGE_HANDLER(MesonViewHostMsg_UpdateDraggableRegionChanges, UpdateDraggableRegionChanges)
+    IPC_MESSAGE_FORWARD(MesonViewHostMsg_Pong, &unresponsive_watchdog_, UnresponsiveWatchdog::OnPong)
+    IPC_MESSAGE_FORWARD(MesonViewHostMsg_HangStack, &unresponsive_watchdog_, UnresponsiveWatchdog::OnHangStack)
     IPC_MESSAGE_UNHANDLED(handled = false)
   IPC_END_MESSAGE_MAP()
 
@@ -607,6 +630,14 @@ bool NativeWindow::OnMessageReceived(const IPC::Message& message, content::Rende
   content::WebContents* wc = web_contents();
   WebViewManager* webviewManager = WebViewManager::GetWebViewManager(wc);
   if (webviewManager) {
+    IPC_BEGIN_MESSAGE_MAP_WITH_PARAM(NativeWindow, message, render_frame_host)
+      IPC_MESSAGE_HANDLER(MesonFrameHostMsg_CreateWebViewGuestAsync, OnCreateWebViewGuestAsync)
+      IPC_MESSAGE_UNHANDLED(handled = false)
+    IPC_END_MESSAGE_MAP()
+    if (handled) {
+      return true;
+    }
+    handled = true;
     IPC_BEGIN_MESSAGE_MAP_WITH_PARAM(NativeWindow, message, wc)
       IPC_MESSAGE_UNHANDLED(handled = false)
       IPC_MESSAGE_HANDLER(MesonFrameHostMsg_CreateWebViewGuest, OnCreateWebViewGuest)
@@ -625,6 +656,7 @@ bool NativeWindow::OnMessageReceived(const IPC::Message& message, content::Rende
       IPC_MESSAGE_FORWARD(MesonFrameHostMsg_WebViewGuestCloseDevTools, webviewManager, WebViewManager::OnWebViewGuestCloseDevTools)
       IPC_MESSAGE_FORWARD(MesonFrameHostMsg_WebViewGuestIsDevToolsOpened, webviewManager, WebViewManager::OnWebViewGuestIsDevToolsOpened)
       IPC_MESSAGE_FORWARD(MesonFrameHostMsg_WebViewGuestJavaScriptDialogClosed, webviewManager, WebViewManager::OnWebViewGuestJavaScriptDialogClosed)
+      IPC_MESSAGE_FORWARD(MesonFrameHostMsg_WebViewGuestBatch, webviewManager, WebViewManager::OnWebViewGuestBatch)
     IPC_END_MESSAGE_MAP()
   }
 #if 0
@@ -637,29 +669,124 @@ bool NativeWindow::OnMessageReceived(const IPC::Message& message, content::Rende
 void NativeWindow::OnCreateWebViewGuest(const base::DictionaryValue& params, int* guest_instance_id) {
   LOG(INFO) << __PRETTY_FUNCTION__;
   auto wc = web_contents();
-  WebViewManager::GetWebViewManager(wc)->OnCreateWebViewGuest(wc, params, guest_instance_id);
+  auto manager = WebViewManager::GetWebViewManager(wc);
+  *guest_instance_id = manager->OnCreateWebViewGuest(wc, params);
+  // the renderer is blocked anyway, the guest is created before replying.
+  manager->CreatePendingGuest(*guest_instance_id, false);
 }
-void NativeWindow::UpdateDraggableRegions(const std::vector<DraggableRegion>& regions) {
+void NativeWindow::OnCreateWebViewGuestAsync(content::RenderFrameHost* render_frame_host, int request_id, const base::DictionaryValue& params) {
+  LOG(INFO) << __PRETTY_FUNCTION__ << "(" << request_id << ")";
+  auto wc = web_contents();
+  // replies with the id before the guest web contents is created.
+  int guest_instance_id = WebViewManager::GetWebViewManager(wc)->OnCreateWebViewGuest(wc, params);
+  render_frame_host->Send(new MesonFrameMsg_WebViewGuestCreated(render_frame_host->GetRoutingID(), request_id, guest_instance_id));
+}
+void NativeWindow::UpdateDraggableRegions(uint32_t generation, const std::vector<DraggableRegion>& regions) {
   // Draggable region is not supported for non-frameless window.
   if (has_frame_)
     return;
-  draggable_region_ = DraggableRegionsToSkRegion(regions);
+  draggable_regions_generation_ = generation;
+  draggable_regions_synced_ = true;
+  draggable_regions_requested_ = false;
+  if (draggable_region_index_.SetRegions(regions))
+    OnDraggableRegionsChanged();
+}
+
+void NativeWindow::UpdateDraggableRegionChanges(uint32_t generation, uint32_t count, const std::vector<DraggableRegionChange>& changes) {
+  if (has_frame_)
+    return;
+  if (!draggable_regions_synced_ || generation != draggable_regions_generation_ + 1) {
+    // based on a list this window does not have, waits for the whole list.
+    if (!draggable_regions_requested_)
+      RequestDraggableRegions();
+    return;
+  }
+  if (!draggable_region_index_.ApplyChanges(count, changes)) {
+    LOG(ERROR) << __PRETTY_FUNCTION__ << " : invalid changes";
+    RequestDraggableRegions();
+    return;
+  }
+  draggable_regions_generation_ = generation;
+  OnDraggableRegionsChanged();
+}
+
+void NativeWindow::RequestDraggableRegions() {
+  if (has_frame_)
+    return;
+  draggable_regions_synced_ = false;
+  draggable_region_index_.Clear();
+  auto* rvh = web_contents() ? web_contents()->GetRenderViewHost() : nullptr;
+  // a new renderer sends the whole list first anyway.
+  if (!rvh || !rvh->IsRenderViewLive())
+    return;
+  draggable_regions_requested_ = rvh->Send(new MesonViewMsg_ResendDraggableRegions(rvh->GetRoutingID()));
+}
+
+bool NativeWindow::IsDraggableAt(const gfx::Point& point) const {
+  return !has_frame_ && draggable_region_index_.Contains(point);
 }
 
-void NativeWindow::ScheduleUnresponsiveEvent(int ms) {
+void NativeWindow::ScheduleUnresponsiveEvent(int ms, const std::string& source) {
   if (!window_unresposive_closure_.IsCancelled())
     return;
 
-  window_unresposive_closure_.Reset(base::Bind(&NativeWindow::NotifyWindowUnresponsive, weak_factory_.GetWeakPtr()));
+  window_unresposive_closure_.Reset(base::Bind(&NativeWindow::NotifyWindowUnresponsive, weak_factory_.GetWeakPtr(), source));
   base::ThreadTaskRunnerHandle::Get()->PostDelayedTask(FROM_HERE, window_unresposive_closure_.callback(), base::TimeDelta::FromMilliseconds(ms));
 }
 
-void NativeWindow::NotifyWindowUnresponsive() {
+void NativeWindow::NotifyWindowUnresponsive(const std::string& source) {
   window_unresposive_closure_.Cancel();
 
-  if (!is_closed_ && !IsUnresponsiveEventSuppressed() && IsEnabled()) {
-    for (NativeWindowObserver& observer : observers_)
-      observer.OnRendererUnresponsive();
+  // the event is sent with a stack, unless the watchdog has sent it already.
+  if (CanEscalate())
+    unresponsive_watchdog_.Escalate(source);
+}
+
+bool NativeWindow::SendPing(int seq) {
+  auto* rvh = web_contents() ? web_contents()->GetRenderViewHost() : nullptr;
+  if (!rvh || !rvh->IsRenderViewLive())
+    return false;
+  return rvh->Send(new MesonViewMsg_Ping(rvh->GetRoutingID(), seq));
+}
+
+void NativeWindow::RequestHangStack(int request_id, base::TimeDelta timeout) {
+  auto* rvh = web_contents() ? web_contents()->GetRenderViewHost() : nullptr;
+  if (rvh)
+    rvh->Send(new MesonViewMsg_CaptureHangStack(rvh->GetRoutingID(), request_id, static_cast<int>(timeout.InMilliseconds())));
+}
+
+bool NativeWindow::CanEscalate() {
+  return !is_closed_ && !IsUnresponsiveEventSuppressed() && IsEnabled();
+}
+
+bool NativeWindow::KillRenderer() {
+  if (!web_contents())
+    return false;
+  content::RenderProcessHost* process = web_contents()->GetRenderProcessHost();
+  // the other pages of the process would go with it.
+  if (process->GetActiveViewCount() > 1)
+    return false;
+  return process->Shutdown(content::RESULT_CODE_HUNG, false);
+}
+
+void NativeWindow::OnWatchdogStage(UnresponsiveWatchdog::Stage stage, const base::DictionaryValue& details) {
+  if (is_closed_)
+    return;
+  for (NativeWindowObserver& observer : observers_) {
+    switch (stage) {
+    case UnresponsiveWatchdog::RESPONSIVE:
+      observer.OnRendererResponsive();
+      break;
+    case UnresponsiveWatchdog::WARNING:
+      observer.OnRendererHangWarning(details);
+      break;
+    case UnresponsiveWatchdog::UNRESPONSIVE:
+      observer.OnRendererUnresponsive(details);
+      break;
+    case UnresponsiveWatchdog::KILLED:
+      observer.OnRendererKilled(details);
+      break;
+    }
   }
 }
 
@@ -4,7 +4,9 @@
 #include <memory>
 #include <vector>
 
+#include "browser/draggable_region_index.h"
 #include "browser/native_window_observer.h"
+#include "browser/unresponsive_watchdog.h"
 //#include "browser/ui/accelerator_util.h"
 //#include "browser/ui/meson_menu_model.h"
 #include "base/cancelable_callback.h"
@@ -26,9 +28,10 @@ struct NativeWebKeyboardEvent;
 }
 
 namespace meson {
-struct DraggableRegion;
 class MesonMenuModel;
-class NativeWindow : public base::SupportsUserData, public content::WebContentsObserver {
+class NativeWindow : public base::SupportsUserData,
+                     public content::WebContentsObserver,
+                     public UnresponsiveWatchdog::Delegate {
  public:
   ~NativeWindow() override;
 
@@ -190,34 +193,53 @@ class NativeWindow : public base::SupportsUserData, public content::WebContentsO
 
  public:
   brightray::InspectableWebContents* inspectable_web_contents() const { return inspectable_web_contents_; }
+  // Shows another (e.g. prerendered) web contents in this window.
+  virtual void SetInspectableWebContents(brightray::InspectableWebContents* inspectable_web_contents);
 
  public:
   bool has_frame() const { return has_frame_; }
   void set_has_frame(bool has_frame) { has_frame_ = has_frame; }
 
   bool transparent() const { return transparent_; }
-  SkRegion* draggable_region() const { return draggable_region_.get(); }
+  const DraggableRegionIndex& draggable_region_index() const { return draggable_region_index_; }
+  // used in custom drag.
+  bool IsDraggableAt(const gfx::Point& point) const;
   bool enable_larger_than_screen() const { return enable_larger_than_screen_; }
 
   NativeWindow* parent() const { return parent_; }
   bool is_modal() const { return is_modal_; }
+  UnresponsiveWatchdog* unresponsive_watchdog() { return &unresponsive_watchdog_; }
 
  protected:
   NativeWindow(brightray::InspectableWebContents* inspectable_web_contents, const base::DictionaryValue& options, NativeWindow* parent);
-  std::unique_ptr<SkRegion> DraggableRegionsToSkRegion(const std::vector<DraggableRegion>& regions);
   virtual gfx::Rect ContentBoundsToWindowBounds(const gfx::Rect& bounds) = 0;
   virtual gfx::Rect WindowBoundsToContentBounds(const gfx::Rect& bounds) = 0;
-  virtual void UpdateDraggableRegions(const std::vector<DraggableRegion>& regions);
+  // called when the draggable regions of a frameless window changed.
+  virtual void OnDraggableRegionsChanged() {}
 
  protected:
   void RenderViewCreated(content::RenderViewHost* render_view_host) override;
+  void RenderViewHostChanged(content::RenderViewHost* old_host, content::RenderViewHost* new_host) override;
+  void RenderProcessGone(base::TerminationStatus status) override;
   void BeforeUnloadDialogCancelled() override;
   void DidFirstVisuallyNonEmptyPaint() override;
   bool OnMessageReceived(const IPC::Message& message) override;
   bool OnMessageReceived(const IPC::Message& message, content::RenderFrameHost* render_frame_host) override;
 
  private:
+  // UnresponsiveWatchdog::Delegate:
+  bool SendPing(int seq) override;
+  void RequestHangStack(int request_id, base::TimeDelta timeout) override;
+  bool CanEscalate() override;
+  bool KillRenderer() override;
+  void OnWatchdogStage(UnresponsiveWatchdog::Stage stage, const base::DictionaryValue& details) override;
+
+  void UpdateDraggableRegions(uint32_t generation, const std::vector<DraggableRegion>& regions);
+  void UpdateDraggableRegionChanges(uint32_t generation, uint32_t count, const std::vector<DraggableRegionChange>& changes);
+  // forgets the regions and asks the renderer for the whole list.
+  void RequestDraggableRegions();
   void OnCreateWebViewGuest(const base::DictionaryValue& params, int* guest_instance_id);
+  void OnCreateWebViewGuestAsync(content::RenderFrameHost* render_frame_host, int request_id, const base::DictionaryValue& params);
 #if 0
   void OnAttachWindowGuest(int internal_instance_id, int guest_instance_id, const base::DictionaryValue& params);
   void OnDestroyWebViewGuest(int guest_instance_id);
@@ -237,16 +259,21 @@ class NativeWindow : public base::SupportsUserData, public content::WebContentsO
   void OnWebViewGuestJavaScriptDialogClosed(int guest_instance_id, bool success, const std::string& response);
 #endif
  private:
-  void ScheduleUnresponsiveEvent(int ms);
-  void NotifyWindowUnresponsive();
+  void ScheduleUnresponsiveEvent(int ms, const std::string& source);
+  void NotifyWindowUnresponsive(const std::string& source);
   void NotifyReadyToShow();
   bool has_frame_;
   bool transparent_;
-  std::unique_ptr<SkRegion> draggable_region_;  // used in custom drag.
+  DraggableRegionIndex draggable_region_index_;
+  // the changes are only applied on top of the generation last applied.
+  uint32_t draggable_regions_generation_;
+  bool draggable_regions_synced_;
+  bool draggable_regions_requested_;
   extensions::SizeConstraints size_constraints_;
   bool enable_larger_than_screen_;
   bool is_closed_;
   base::CancelableClosure window_unresposive_closure_;
+  UnresponsiveWatchdog unresponsive_watchdog_;
   double sheet_offset_x_;
   double sheet_offset_y_;
   double aspect_ratio_;
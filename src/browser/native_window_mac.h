@@ -86,7 +86,8 @@ class NativeWindowMac : public NativeWindow,
 
  public:
   void RenderViewHostChanged(content::RenderViewHost* old_host, content::RenderViewHost* new_host) override;
-  void UpdateDraggableRegionViews() { UpdateDraggableRegionViews(draggable_regions_); }
+  void SetInspectableWebContents(brightray::InspectableWebContents* inspectable_web_contents) override;
+  void UpdateDraggableRegionViews();
 
  public:
   void SetStyleMask(bool on, NSUInteger flag);
@@ -103,16 +104,15 @@ class NativeWindowMac : public NativeWindow,
  protected:
   // Return a vector of non-draggable regions that fill a window of size
   // |width| by |height|, but leave gaps where the window should be draggable.
-  std::vector<gfx::Rect> CalculateNonDraggableRegions(const std::vector<DraggableRegion>& regions, int width, int height);
+  std::vector<gfx::Rect> CalculateNonDraggableRegions(int width, int height);
 
  private:
   gfx::Rect ContentBoundsToWindowBounds(const gfx::Rect& bounds);
   gfx::Rect WindowBoundsToContentBounds(const gfx::Rect& bounds);
-  void UpdateDraggableRegions(const std::vector<DraggableRegion>& regions) override;
+  void OnDraggableRegionsChanged() override;
   void ShowWindowButton(NSWindowButton button);
   void InstallView();
   void UninstallView();
-  void UpdateDraggableRegionViews(const std::vector<DraggableRegion>& regions);
   void RegisterInputEventObserver(content::RenderViewHost* host);
   void UnregisterInputEventObserver(content::RenderViewHost* host);
 
@@ -121,7 +121,9 @@ class NativeWindowMac : public NativeWindow,
   base::scoped_nsobject<MesonNSWindowDelegate> window_delegate_;
   id wheel_event_monitor_;
   base::scoped_nsobject<FullSizeContentView> content_view_;
-  std::vector<DraggableRegion> draggable_regions_;
+  // the ControlRegionViews are only replaced when these change.
+  NSView* control_region_parent_;
+  std::vector<gfx::Rect> control_region_rects_;
   bool is_kiosk_;
   NSInteger attention_request_id_;
   NSApplicationPresentationOptions kiosk_options_;
@@ -18,7 +18,6 @@
 #include "content/public/browser/render_view_host.h"
 #include "content/public/browser/render_widget_host_view.h"
 #include "skia/ext/skia_utils_mac.h"
-#include "third_party/skia/include/core/SkRegion.h"
 #include "ui/gfx/skia_util.h"
 
 namespace {
@@ -466,6 +465,7 @@ namespace meson {
 
 NativeWindowMac::NativeWindowMac(brightray::InspectableWebContents* web_contents, const base::DictionaryValue& options, NativeWindow* parent)
     : NativeWindow(web_contents, options, parent),
+      control_region_parent_(nil),
       is_kiosk_(false),
       attention_request_id_(0),
       title_bar_style_(NORMAL) {
@@ -1100,27 +1100,30 @@ void NativeWindowMac::OnInputEvent(const blink::WebInputEvent& event) {
 }
 
 void NativeWindowMac::RenderViewHostChanged(content::RenderViewHost* old_host, content::RenderViewHost* new_host) {
+  NativeWindow::RenderViewHostChanged(old_host, new_host);
   UnregisterInputEventObserver(old_host);
   RegisterInputEventObserver(new_host);
 }
 
-std::vector<gfx::Rect> NativeWindowMac::CalculateNonDraggableRegions(
-    const std::vector<DraggableRegion>& regions,
-    int width,
-    int height) {
-  std::vector<gfx::Rect> result;
-  if (regions.empty()) {
-    result.push_back(gfx::Rect(0, 0, width, height));
-  } else {
-    std::unique_ptr<SkRegion> draggable(DraggableRegionsToSkRegion(regions));
-    std::unique_ptr<SkRegion> non_draggable(new SkRegion);
-    non_draggable->op(0, 0, width, height, SkRegion::kUnion_Op);
-    non_draggable->op(*draggable, SkRegion::kDifference_Op);
-    for (SkRegion::Iterator it(*non_draggable); !it.done(); it.next()) {
-      result.push_back(gfx::SkIRectToRect(it.rect()));
-    }
-  }
-  return result;
+void NativeWindowMac::SetInspectableWebContents(brightray::InspectableWebContents* new_contents) {
+  NSView* old_view = inspectable_web_contents()->GetView()->GetNativeView();
+  NSView* parent = [old_view superview];
+  UnregisterInputEventObserver(web_contents()->GetRenderViewHost());
+
+  NativeWindow::SetInspectableWebContents(new_contents);
+
+  // Replace the view in place, so the content view of frameless windows is kept.
+  NSView* view = new_contents->GetView()->GetNativeView();
+  [view setAutoresizingMask:NSViewWidthSizable | NSViewHeightSizable];
+  [view setFrame:[parent bounds]];
+  [parent replaceSubview:old_view with:view];
+
+  RegisterInputEventObserver(web_contents()->GetRenderViewHost());
+  UpdateDraggableRegionViews();
+}
+
+std::vector<gfx::Rect> NativeWindowMac::CalculateNonDraggableRegions(int width, int height) {
+  return draggable_region_index().GetNonDraggableRects(width, height);
 }
 
 gfx::Rect NativeWindowMac::ContentBoundsToWindowBounds(
@@ -1149,11 +1152,8 @@ gfx::Rect NativeWindowMac::WindowBoundsToContentBounds(
   }
 }
 
-void NativeWindowMac::UpdateDraggableRegions(
-    const std::vector<DraggableRegion>& regions) {
-  NativeWindow::UpdateDraggableRegions(regions);
-  draggable_regions_ = regions;
-  UpdateDraggableRegionViews(regions);
+void NativeWindowMac::OnDraggableRegionsChanged() {
+  UpdateDraggableRegionViews();
 }
 
 void NativeWindowMac::ShowWindowButton(NSWindowButton button) {
@@ -1216,8 +1216,7 @@ void NativeWindowMac::UninstallView() {
   [view removeFromSuperview];
 }
 
-void NativeWindowMac::UpdateDraggableRegionViews(
-    const std::vector<DraggableRegion>& regions) {
+void NativeWindowMac::UpdateDraggableRegionViews() {
   if (has_frame())
     return;
 
@@ -1232,6 +1231,17 @@ void NativeWindowMac::UpdateDraggableRegionViews(
     [webView setMouseDownCanMoveWindow:YES];
   }
 
+  // Draggable regions is implemented by having the whole web view draggable
+  // (mouseDownCanMoveWindow) and overlaying regions that are not draggable.
+  std::vector<gfx::Rect> system_drag_exclude_areas =
+      CalculateNonDraggableRegions(webViewWidth, webViewHeight);
+  // Most updates of the regions do not change the views.
+  if (webView == control_region_parent_ &&
+      system_drag_exclude_areas == control_region_rects_)
+    return;
+  control_region_parent_ = webView;
+  control_region_rects_ = system_drag_exclude_areas;
+
   // Remove all ControlRegionViews that are added last time.
   // Note that [webView subviews] returns the view's mutable internal array and
   // it should be copied to avoid mutating the original array while enumerating
@@ -1241,11 +1251,6 @@ void NativeWindowMac::UpdateDraggableRegionViews(
     if ([subview isKindOfClass:[ControlRegionView class]])
       [subview removeFromSuperview];
 
-  // Draggable regions is implemented by having the whole web view draggable
-  // (mouseDownCanMoveWindow) and overlaying regions that are not draggable.
-  std::vector<gfx::Rect> system_drag_exclude_areas =
-      CalculateNonDraggableRegions(regions, webViewWidth, webViewHeight);
-
   // Create and add a ControlRegionView for each region that needs to be
   // excluded from the dragging.
   for (std::vector<gfx::Rect>::const_iterator iter =
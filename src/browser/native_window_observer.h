@@ -4,6 +4,7 @@
 #include <string>
 
 #include "base/strings/string16.h"
+#include "base/values.h"
 #include "ui/base/window_open_disposition.h"
 #include "url/gurl.h"
 
@@ -47,7 +48,10 @@ public:
 #if defined(OS_WIN)
   virtual void OnWindowMessage(UINT message, WPARAM w_param, LPARAM l_param) {}
 #endif
-  virtual void OnRendererUnresponsive() {}
+  // |details|: see UnresponsiveWatchdog::Delegate::OnWatchdogStage().
+  virtual void OnRendererHangWarning(const base::DictionaryValue& details) {}
+  virtual void OnRendererUnresponsive(const base::DictionaryValue& details) {}
+  virtual void OnRendererKilled(const base::DictionaryValue& details) {}
   virtual void OnRendererResponsive() {}
   virtual void OnExecuteWindowsCommand(const std::string& command_name) {}
 };
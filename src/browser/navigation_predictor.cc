@@ -0,0 +1,116 @@
+#include "browser/navigation_predictor.h"
+
+#include "base/bind.h"
+#include "base/logging.h"
+#include "content/public/browser/browser_thread.h"
+#include "content/public/browser/resource_hints.h"
+#include "net/base/load_flags.h"
+#include "net/url_request/url_fetcher.h"
+#include "browser/session/meson_browser_context.h"
+
+using content::BrowserThread;
+
+namespace meson {
+namespace {
+const size_t kMaxConcurrentPrefetches = 6;
+// remembered warm urls, only for the hit statistics.
+const size_t kMaxRemembered = 256;
+
+void PreconnectOnIOThread(content::ResourceContext* resource_context, const GURL& url, int count) {
+  content::PreconnectUrl(resource_context, url, url, count, true, net::HttpRequestInfo::PRECONNECT_MOTIVATED);
+}
+
+void PreresolveOnIOThread(content::ResourceContext* resource_context, const GURL& url) {
+  content::PreresolveUrl(resource_context, url, net::CompletionCallback(), nullptr);
+}
+
+void Remember(std::set<GURL>* set, const GURL& url) {
+  if (set->size() >= kMaxRemembered) {
+    set->clear();
+  }
+  set->insert(url);
+}
+}
+
+NavigationPredictor::NavigationPredictor(MesonBrowserContext* browser_context)
+    : browser_context_(browser_context),
+      preconnects_(0),
+      preresolves_(0),
+      prefetches_started_(0),
+      prefetches_failed_(0),
+      prefetch_hits_(0),
+      preconnect_hits_(0) {
+}
+
+NavigationPredictor::~NavigationPredictor() {
+}
+
+void NavigationPredictor::Preconnect(const GURL& url, int count) {
+  preconnects_++;
+  Remember(&preconnected_, url.GetOrigin());
+  BrowserThread::PostTask(BrowserThread::IO, FROM_HERE,
+                          base::Bind(&PreconnectOnIOThread, browser_context_->GetResourceContext(), url, count));
+}
+
+void NavigationPredictor::Preresolve(const GURL& url) {
+  preresolves_++;
+  BrowserThread::PostTask(BrowserThread::IO, FROM_HERE,
+                          base::Bind(&PreresolveOnIOThread, browser_context_->GetResourceContext(), url));
+}
+
+bool NavigationPredictor::Prefetch(const GURL& url) {
+  if (prefetches_.size() >= kMaxConcurrentPrefetches) {
+    return false;
+  }
+  std::unique_ptr<net::URLFetcher> fetcher = net::URLFetcher::Create(url, net::URLFetcher::GET, this);
+  fetcher->SetRequestContext(browser_context_->GetRequestContext());
+  fetcher->SetLoadFlags(net::LOAD_PREFETCH);
+  fetcher->Start();
+  prefetches_[fetcher.get()] = std::move(fetcher);
+  prefetches_started_++;
+  return true;
+}
+
+void NavigationPredictor::OnURLFetchComplete(const net::URLFetcher* source) {
+  auto fiter = prefetches_.find(source);
+  if (fiter == prefetches_.end()) {
+    return;
+  }
+  if (source->GetStatus().is_success()) {
+    Remember(&prefetched_, source->GetOriginalURL());
+  } else {
+    LOG(INFO) << __PRETTY_FUNCTION__ << " : failed " << source->GetOriginalURL();
+    prefetches_failed_++;
+  }
+  // |source| is deleted here.
+  prefetches_.erase(fiter);
+}
+
+bool NavigationPredictor::TakePrefetched(const GURL& url) {
+  if (prefetched_.erase(url) == 0) {
+    return false;
+  }
+  prefetch_hits_++;
+  return true;
+}
+
+bool NavigationPredictor::TakePreconnected(const GURL& url) {
+  if (preconnected_.erase(url.GetOrigin()) == 0) {
+    return false;
+  }
+  preconnect_hits_++;
+  return true;
+}
+
+std::unique_ptr<base::DictionaryValue> NavigationPredictor::GetStatistics(void) const {
+  std::unique_ptr<base::DictionaryValue> stats(new base::DictionaryValue());
+  stats->SetInteger("preconnects", preconnects_);
+  stats->SetInteger("preresolves", preresolves_);
+  stats->SetInteger("prefetches", prefetches_started_);
+  stats->SetInteger("prefetchesFailed", prefetches_failed_);
+  stats->SetInteger("prefetchesPending", static_cast<int>(prefetches_.size()));
+  stats->SetInteger("prefetchHits", prefetch_hits_);
+  stats->SetInteger("preconnectHits", preconnect_hits_);
+  return stats;
+}
+}
@@ -0,0 +1,55 @@
+//-*-c++-*-
+#pragma once
+
+#include <map>
+#include <memory>
+#include <set>
+#include "base/macros.h"
+#include "base/values.h"
+#include "net/url_request/url_fetcher_delegate.h"
+#include "url/gurl.h"
+
+namespace net {
+class URLFetcher;
+}
+
+namespace meson {
+class MesonBrowserContext;
+// Warms up the network stack of a browser context for likely navigations:
+// pre-resolves and preconnects origins, and prefetches resources into the
+// HTTP cache.
+class NavigationPredictor : public net::URLFetcherDelegate {
+ public:
+  explicit NavigationPredictor(MesonBrowserContext* browser_context);
+  ~NavigationPredictor() override;
+
+  // opens |count| connections to the origin of |url|.
+  void Preconnect(const GURL& url, int count);
+  void Preresolve(const GURL& url);
+  // fetches |url| into the HTTP cache, false if too many are in flight.
+  bool Prefetch(const GURL& url);
+
+  // consumed by the navigation, for the statistics.
+  bool TakePrefetched(const GURL& url);
+  bool TakePreconnected(const GURL& url);
+  std::unique_ptr<base::DictionaryValue> GetStatistics(void) const;
+
+ private:
+  // net::URLFetcherDelegate:
+  void OnURLFetchComplete(const net::URLFetcher* source) override;
+
+ private:
+  MesonBrowserContext* browser_context_;
+  std::map<const net::URLFetcher*, std::unique_ptr<net::URLFetcher>> prefetches_;
+  std::set<GURL> prefetched_;
+  std::set<GURL> preconnected_;
+
+  int preconnects_;
+  int preresolves_;
+  int prefetches_started_;
+  int prefetches_failed_;
+  int prefetch_hits_;
+  int preconnect_hits_;
+  DISALLOW_COPY_AND_ASSIGN(NavigationPredictor);
+};
+}
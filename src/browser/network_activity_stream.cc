@@ -0,0 +1,247 @@
+#include "browser/network_activity_stream.h"
+
+#include "base/bind.h"
+#include "base/logging.h"
+#include "base/strings/pattern.h"
+#include "base/strings/string_util.h"
+#include "net/http/http_response_headers.h"
+#include "url/gurl.h"
+
+namespace meson {
+namespace {
+const int kDefaultFlushIntervalMs = 1000;
+const size_t kDefaultMaxBatch = 256;
+
+// column order of a record.
+const char* kNetworkActivitySchema[] = {
+    "type", "url", "originalURL", "httpResponseCode", "requestMethod", "referer", "resourceType", "time", "headers",
+};
+
+struct ResourceTypeName {
+  content::ResourceType type;
+  const char* name;
+};
+const ResourceTypeName kResourceTypeNames[] = {
+    {content::RESOURCE_TYPE_MAIN_FRAME, "mainFrame"},
+    {content::RESOURCE_TYPE_SUB_FRAME, "subFrame"},
+    {content::RESOURCE_TYPE_STYLESHEET, "stylesheet"},
+    {content::RESOURCE_TYPE_SCRIPT, "script"},
+    {content::RESOURCE_TYPE_IMAGE, "image"},
+    {content::RESOURCE_TYPE_FONT_RESOURCE, "font"},
+    {content::RESOURCE_TYPE_SUB_RESOURCE, "subresource"},
+    {content::RESOURCE_TYPE_OBJECT, "object"},
+    {content::RESOURCE_TYPE_MEDIA, "media"},
+    {content::RESOURCE_TYPE_WORKER, "worker"},
+    {content::RESOURCE_TYPE_SHARED_WORKER, "sharedWorker"},
+    {content::RESOURCE_TYPE_PREFETCH, "prefetch"},
+    {content::RESOURCE_TYPE_FAVICON, "favicon"},
+    {content::RESOURCE_TYPE_XHR, "xhr"},
+    {content::RESOURCE_TYPE_PING, "ping"},
+    {content::RESOURCE_TYPE_SERVICE_WORKER, "serviceWorker"},
+    {content::RESOURCE_TYPE_CSP_REPORT, "cspReport"},
+    {content::RESOURCE_TYPE_PLUGIN_RESOURCE, "pluginResource"},
+};
+
+const char* ResourceTypeToString(content::ResourceType type) {
+  for (const auto& entry : kResourceTypeNames) {
+    if (entry.type == type)
+      return entry.name;
+  }
+  return "other";
+}
+
+bool ResourceTypeFromString(const std::string& name, content::ResourceType* type) {
+  for (const auto& entry : kResourceTypeNames) {
+    if (name == entry.name) {
+      *type = entry.type;
+      return true;
+    }
+  }
+  return false;
+}
+}
+
+NetworkActivityStream::NetworkActivityStream(const FlushCallback& callback)
+    : callback_(callback),
+      sample_rate_(1.0),
+      sample_credit_(0.0),
+      flush_interval_(base::TimeDelta::FromMilliseconds(kDefaultFlushIntervalMs)),
+      max_batch_(kDefaultMaxBatch),
+      start_time_(base::TimeTicks::Now()),
+      recorded_(0),
+      filtered_(0),
+      sampled_out_(0),
+      batches_(0) {
+}
+
+NetworkActivityStream::~NetworkActivityStream(void) {
+}
+
+bool NetworkActivityStream::Configure(const base::DictionaryValue& options) {
+  std::set<std::string> headers;
+  std::set<int> resource_types;
+  std::vector<std::string> url_patterns;
+  double sample_rate = 1.0;
+  int flush_interval = kDefaultFlushIntervalMs;
+  int max_batch = static_cast<int>(kDefaultMaxBatch);
+  const base::ListValue* list = nullptr;
+  std::string s;
+
+  if (options.GetList("headers", &list)) {
+    for (size_t i = 0; i < list->GetSize(); i++) {
+      if (!list->GetString(i, &s))
+        return false;
+      // header names are compared case-insensitively.
+      headers.insert(base::ToLowerASCII(s));
+    }
+  }
+  if (options.GetList("resourceTypes", &list)) {
+    for (size_t i = 0; i < list->GetSize(); i++) {
+      content::ResourceType type;
+      if (!list->GetString(i, &s) || !ResourceTypeFromString(s, &type))
+        return false;
+      resource_types.insert(type);
+    }
+  }
+  if (options.GetList("urlPatterns", &list)) {
+    for (size_t i = 0; i < list->GetSize(); i++) {
+      if (!list->GetString(i, &s))
+        return false;
+      url_patterns.push_back(s);
+    }
+  }
+  options.GetDouble("sampleRate", &sample_rate);
+  options.GetInteger("flushInterval", &flush_interval);
+  options.GetInteger("maxBatch", &max_batch);
+  if (sample_rate < 0.0 || sample_rate > 1.0 || flush_interval < 0 || max_batch < 1)
+    return false;
+
+  Flush();
+  headers_.swap(headers);
+  resource_types_.swap(resource_types);
+  url_patterns_.swap(url_patterns);
+  sample_rate_ = sample_rate;
+  sample_credit_ = 0.0;
+  flush_interval_ = base::TimeDelta::FromMilliseconds(flush_interval);
+  max_batch_ = static_cast<size_t>(max_batch);
+  return true;
+}
+
+std::unique_ptr<base::DictionaryValue> NetworkActivityStream::GetStatistics(void) const {
+  std::unique_ptr<base::DictionaryValue> stats(new base::DictionaryValue());
+  stats->SetInteger("recorded", recorded_);
+  stats->SetInteger("filtered", filtered_);
+  stats->SetInteger("sampledOut", sampled_out_);
+  stats->SetInteger("batches", batches_);
+  stats->SetInteger("pending", pending_ ? static_cast<int>(pending_->GetSize()) : 0);
+  return stats;
+}
+
+void NetworkActivityStream::AddResponse(const GURL& url,
+                                        const GURL& original_url,
+                                        int http_response_code,
+                                        const std::string& method,
+                                        const std::string& referrer,
+                                        content::ResourceType resource_type,
+                                        const net::HttpResponseHeaders* headers) {
+  if (!Accept(url, resource_type))
+    return;
+  AddRecord("response", url, original_url, http_response_code, method, referrer, resource_type, headers);
+}
+
+void NetworkActivityStream::AddRedirect(const GURL& url,
+                                        const GURL& new_url,
+                                        int http_response_code,
+                                        const std::string& method,
+                                        const std::string& referrer,
+                                        content::ResourceType resource_type,
+                                        const net::HttpResponseHeaders* headers) {
+  if (!Accept(url, resource_type))
+    return;
+  AddRecord("redirect", new_url, url, http_response_code, method, referrer, resource_type, headers);
+}
+
+bool NetworkActivityStream::Accept(const GURL& url, content::ResourceType resource_type) {
+  if (!resource_types_.empty() && resource_types_.find(resource_type) == resource_types_.end()) {
+    filtered_++;
+    return false;
+  }
+  if (!url_patterns_.empty()) {
+    const std::string& spec = url.spec();
+    bool matched = false;
+    for (const auto& pattern : url_patterns_) {
+      if (base::MatchPattern(spec, pattern)) {
+        matched = true;
+        break;
+      }
+    }
+    if (!matched) {
+      filtered_++;
+      return false;
+    }
+  }
+  // take exactly |sample_rate_| of the records, without randomness.
+  sample_credit_ += sample_rate_;
+  if (sample_credit_ < 1.0) {
+    sampled_out_++;
+    return false;
+  }
+  sample_credit_ -= 1.0;
+  return true;
+}
+
+void NetworkActivityStream::AddRecord(const char* kind,
+                                      const GURL& url,
+                                      const GURL& original_url,
+                                      int http_response_code,
+                                      const std::string& method,
+                                      const std::string& referrer,
+                                      content::ResourceType resource_type,
+                                      const net::HttpResponseHeaders* headers) {
+  std::unique_ptr<base::ListValue> record(new base::ListValue());
+  record->AppendString(kind);
+  record->AppendString(url.spec());
+  record->AppendString(original_url.spec());
+  record->AppendInteger(http_response_code);
+  record->AppendString(method);
+  record->AppendString(referrer);
+  record->AppendString(ResourceTypeToString(resource_type));
+  record->AppendDouble((base::TimeTicks::Now() - start_time_).InMillisecondsF());
+  if (headers && !headers_.empty()) {
+    // only the allowed headers are looked up, the rest is never copied.
+    std::unique_ptr<base::DictionaryValue> h(new base::DictionaryValue());
+    std::string value;
+    for (const auto& name : headers_) {
+      if (headers->GetNormalizedHeader(name, &value))
+        h->SetStringWithoutPathExpansion(name, value);
+    }
+    record->Append(std::move(h));
+  } else {
+    record->Append(base::Value::CreateNullValue());
+  }
+
+  if (!pending_)
+    pending_.reset(new base::ListValue());
+  pending_->Append(std::move(record));
+  recorded_++;
+
+  if (pending_->GetSize() >= max_batch_ || flush_interval_.is_zero()) {
+    Flush();
+  } else if (!flush_timer_.IsRunning()) {
+    flush_timer_.Start(FROM_HERE, flush_interval_, base::Bind(&NetworkActivityStream::Flush, base::Unretained(this)));
+  }
+}
+
+void NetworkActivityStream::Flush(void) {
+  flush_timer_.Stop();
+  if (!pending_ || pending_->empty())
+    return;
+  std::unique_ptr<base::ListValue> records = std::move(pending_);
+  std::unique_ptr<base::ListValue> schema(new base::ListValue());
+  for (const char* column : kNetworkActivitySchema) {
+    schema->AppendString(column);
+  }
+  batches_++;
+  callback_.Run(std::move(schema), std::move(records));
+}
+}
@@ -0,0 +1,85 @@
+//-*-c++-*-
+#pragma once
+
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+#include "base/callback.h"
+#include "base/macros.h"
+#include "base/time/time.h"
+#include "base/timer/timer.h"
+#include "base/values.h"
+#include "content/public/common/resource_type.h"
+
+class GURL;
+
+namespace net {
+class HttpResponseHeaders;
+}
+
+namespace meson {
+// Filters, samples and batches the resource responses of a WebContents.
+// Records have a fixed schema (see kNetworkActivitySchema), and are flushed
+// as one list per interval instead of one event per resource.
+class NetworkActivityStream {
+ public:
+  // (schema, records)
+  using FlushCallback = base::Callback<void(std::unique_ptr<base::ListValue>, std::unique_ptr<base::ListValue>)>;
+
+  explicit NetworkActivityStream(const FlushCallback& callback);
+  ~NetworkActivityStream(void);
+
+  // options: {headers: [name], resourceTypes: [type], urlPatterns: [pattern],
+  //           sampleRate: 0.0-1.0, flushInterval: ms, maxBatch: n}
+  bool Configure(const base::DictionaryValue& options);
+  std::unique_ptr<base::DictionaryValue> GetStatistics(void) const;
+
+  void AddResponse(const GURL& url,
+                   const GURL& original_url,
+                   int http_response_code,
+                   const std::string& method,
+                   const std::string& referrer,
+                   content::ResourceType resource_type,
+                   const net::HttpResponseHeaders* headers);
+  void AddRedirect(const GURL& url,
+                   const GURL& new_url,
+                   int http_response_code,
+                   const std::string& method,
+                   const std::string& referrer,
+                   content::ResourceType resource_type,
+                   const net::HttpResponseHeaders* headers);
+  void Flush(void);
+
+ private:
+  bool Accept(const GURL& url, content::ResourceType resource_type);
+  void AddRecord(const char* kind,
+                 const GURL& url,
+                 const GURL& original_url,
+                 int http_response_code,
+                 const std::string& method,
+                 const std::string& referrer,
+                 content::ResourceType resource_type,
+                 const net::HttpResponseHeaders* headers);
+
+ private:
+  FlushCallback callback_;
+  std::set<std::string> headers_;
+  std::set<int> resource_types_;
+  std::vector<std::string> url_patterns_;
+  double sample_rate_;
+  double sample_credit_;
+  base::TimeDelta flush_interval_;
+  size_t max_batch_;
+
+  base::TimeTicks start_time_;
+  std::unique_ptr<base::ListValue> pending_;
+  base::OneShotTimer flush_timer_;
+
+  int recorded_;
+  int filtered_;
+  int sampled_out_;
+  int batches_;
+  DISALLOW_COPY_AND_ASSIGN(NetworkActivityStream);
+};
+}
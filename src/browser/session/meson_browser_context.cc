@@ -7,7 +7,11 @@
 #include "app/common/chrome_version.h"
 #include "app/common/meson_version.h"
 
+#include "browser/background_throttling_policy.h"
 #include "browser/browser.h"
+#include "browser/contents_discarder.h"
+#include "browser/guest_process_policy.h"
+#include "browser/navigation_predictor.h"
 
 static std::string RemoveWhitespace(const std::string& str) {
   std::string trimmed;
@@ -56,6 +60,34 @@ content::BrowserPluginGuestManager* MesonBrowserContext::GetGuestManager() {
   return guest_manager_.get();
 }
 
+NavigationPredictor* MesonBrowserContext::GetNavigationPredictor() {
+  if (!navigation_predictor_) {
+    navigation_predictor_.reset(new NavigationPredictor(this));
+  }
+  return navigation_predictor_.get();
+}
+
+BackgroundThrottlingPolicy* MesonBrowserContext::GetBackgroundThrottlingPolicy() {
+  if (!background_throttling_policy_) {
+    background_throttling_policy_.reset(new BackgroundThrottlingPolicy());
+  }
+  return background_throttling_policy_.get();
+}
+
+ContentsDiscarder* MesonBrowserContext::GetContentsDiscarder() {
+  if (!contents_discarder_) {
+    contents_discarder_.reset(new ContentsDiscarder());
+  }
+  return contents_discarder_.get();
+}
+
+GuestProcessPolicy* MesonBrowserContext::GetGuestProcessPolicy() {
+  if (!guest_process_policy_) {
+    guest_process_policy_.reset(new GuestProcessPolicy());
+  }
+  return guest_process_policy_.get();
+}
+
 scoped_refptr<MesonBrowserContext> MesonBrowserContext::From(SessionBinding* binding,
                                                              const std::string& partition,
                                                              bool is_memory,
@@ -12,6 +12,10 @@
 
 namespace meson {
 class SessionBinding;
+class NavigationPredictor;
+class BackgroundThrottlingPolicy;
+class ContentsDiscarder;
+class GuestProcessPolicy;
 class MesonBrowserContext : public brightray::BrowserContext {
  public:
   MesonBrowserContext(SessionBinding* binding, const std::string& partition, bool is_memory, const base::DictionaryValue& args);
@@ -25,12 +29,20 @@ class MesonBrowserContext : public brightray::BrowserContext {
 
  public:
   content::BrowserPluginGuestManager* GetGuestManager() override;
+  NavigationPredictor* GetNavigationPredictor();
+  BackgroundThrottlingPolicy* GetBackgroundThrottlingPolicy();
+  ContentsDiscarder* GetContentsDiscarder();
+  GuestProcessPolicy* GetGuestProcessPolicy();
 
  private:
   base::WeakPtr<SessionBinding> binding_;
   std::string user_agent_;
   bool use_cache_;
   std::unique_ptr<WebViewManager> guest_manager_;
+  std::unique_ptr<NavigationPredictor> navigation_predictor_;
+  std::unique_ptr<BackgroundThrottlingPolicy> background_throttling_policy_;
+  std::unique_ptr<ContentsDiscarder> contents_discarder_;
+  std::unique_ptr<GuestProcessPolicy> guest_process_policy_;
 
   DISALLOW_COPY_AND_ASSIGN(MesonBrowserContext);
 };
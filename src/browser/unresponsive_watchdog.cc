@@ -0,0 +1,309 @@
+#include "browser/unresponsive_watchdog.h"
+
+#include <algorithm>
+#include <cmath>
+#include "base/bind.h"
+#include "base/logging.h"
+
+namespace meson {
+UnresponsiveWatchdog::UnresponsiveWatchdog(Delegate* delegate)
+    : delegate_(delegate),
+      enabled_(true),
+      interval_(base::TimeDelta::FromMilliseconds(1000)),
+      warn_after_(base::TimeDelta::FromMilliseconds(1000)),
+      unresponsive_after_(base::TimeDelta::FromMilliseconds(5000)),
+      deviations_(4.0),
+      stack_timeout_(base::TimeDelta::FromMilliseconds(200)),
+      started_(false),
+      stage_(RESPONSIVE),
+      seq_(0),
+      baseline_(0.0),
+      deviation_(0.0),
+      samples_(0),
+      stack_request_id_(0),
+      pending_stage_(RESPONSIVE),
+      warnings_(0),
+      unresponsive_(0),
+      kills_(0),
+      recoveries_(0),
+      stacks_captured_(0) {
+}
+
+UnresponsiveWatchdog::~UnresponsiveWatchdog(void) {
+}
+
+bool UnresponsiveWatchdog::Configure(const base::DictionaryValue& options) {
+  bool enabled = enabled_;
+  int interval = static_cast<int>(interval_.InMilliseconds());
+  int warn_after = static_cast<int>(warn_after_.InMilliseconds());
+  int unresponsive_after = static_cast<int>(unresponsive_after_.InMilliseconds());
+  int kill_after = static_cast<int>(kill_after_.InMilliseconds());
+  double deviations = deviations_;
+  int stack_timeout = static_cast<int>(stack_timeout_.InMilliseconds());
+  options.GetBoolean("enabled", &enabled);
+  options.GetInteger("interval", &interval);
+  options.GetInteger("warnAfter", &warn_after);
+  options.GetInteger("unresponsiveAfter", &unresponsive_after);
+  options.GetInteger("killAfter", &kill_after);
+  options.GetDouble("deviations", &deviations);
+  options.GetInteger("stackTimeout", &stack_timeout);
+  if (interval <= 0 || warn_after <= 0 || unresponsive_after < warn_after || kill_after < 0 || deviations < 0.0 || stack_timeout < 0) {
+    return false;
+  }
+  interval_ = base::TimeDelta::FromMilliseconds(interval);
+  warn_after_ = base::TimeDelta::FromMilliseconds(warn_after);
+  unresponsive_after_ = base::TimeDelta::FromMilliseconds(unresponsive_after);
+  kill_after_ = base::TimeDelta::FromMilliseconds(kill_after);
+  deviations_ = deviations;
+  stack_timeout_ = base::TimeDelta::FromMilliseconds(stack_timeout);
+
+  if (enabled != enabled_) {
+    enabled_ = enabled;
+    timer_.Stop();
+    ping_sent_ = base::TimeTicks();
+    if (enabled_ && started_) {
+      timer_.Start(FROM_HERE, interval_, base::Bind(&UnresponsiveWatchdog::SendPing, base::Unretained(this)));
+    }
+  }
+  return true;
+}
+
+void UnresponsiveWatchdog::Start(void) {
+  started_ = true;
+  stage_ = RESPONSIVE;
+  ping_sent_ = base::TimeTicks();
+  // the answers of the renderer before are ignored.
+  seq_++;
+  stack_timer_.Stop();
+  pending_details_.reset();
+  timer_.Stop();
+  if (enabled_) {
+    timer_.Start(FROM_HERE, interval_, base::Bind(&UnresponsiveWatchdog::SendPing, base::Unretained(this)));
+  }
+}
+
+void UnresponsiveWatchdog::Stop(void) {
+  started_ = false;
+  ping_sent_ = base::TimeTicks();
+  timer_.Stop();
+  FlushPendingStage();
+}
+
+base::TimeDelta UnresponsiveWatchdog::WarnThreshold(void) const {
+  double adaptive = baseline_ + deviations_ * deviation_;
+  return std::max(warn_after_, base::TimeDelta::FromMillisecondsD(adaptive));
+}
+
+base::TimeDelta UnresponsiveWatchdog::UnresponsiveThreshold(void) const {
+  return std::max(unresponsive_after_, WarnThreshold() * 2);
+}
+
+void UnresponsiveWatchdog::SendPing(void) {
+  if (!enabled_ || !started_) {
+    return;
+  }
+  if (!delegate_->SendPing(++seq_)) {
+    timer_.Start(FROM_HERE, interval_, base::Bind(&UnresponsiveWatchdog::SendPing, base::Unretained(this)));
+    return;
+  }
+  ping_sent_ = base::TimeTicks::Now();
+  timer_.Start(FROM_HERE, WarnThreshold(), base::Bind(&UnresponsiveWatchdog::Check, base::Unretained(this)));
+}
+
+void UnresponsiveWatchdog::OnPong(int seq) {
+  if (seq != seq_ || ping_sent_.is_null()) {
+    return;
+  }
+  base::TimeDelta rtt = base::TimeTicks::Now() - ping_sent_;
+  ping_sent_ = base::TimeTicks();
+  // a hang is not taken as the usual latency.
+  if (rtt < UnresponsiveThreshold()) {
+    Learn(rtt);
+  }
+  Recover("watchdog", rtt);
+  timer_.Start(FROM_HERE, interval_, base::Bind(&UnresponsiveWatchdog::SendPing, base::Unretained(this)));
+}
+
+void UnresponsiveWatchdog::Learn(base::TimeDelta rtt) {
+  double ms = rtt.InMillisecondsF();
+  if (samples_ == 0) {
+    baseline_ = ms;
+    deviation_ = ms / 2;
+  } else {
+    double diff = ms - baseline_;
+    baseline_ += diff / 8;
+    deviation_ += (std::fabs(diff) - deviation_) / 4;
+  }
+  samples_++;
+}
+
+void UnresponsiveWatchdog::Check(void) {
+  if (ping_sent_.is_null()) {
+    return;
+  }
+  if (!delegate_->CanEscalate()) {
+    // the time the events are suppressed is not counted.
+    ping_sent_ = base::TimeTicks::Now();
+    timer_.Start(FROM_HERE, WarnThreshold(), base::Bind(&UnresponsiveWatchdog::Check, base::Unretained(this)));
+    return;
+  }
+  base::TimeDelta elapsed = base::TimeTicks::Now() - ping_sent_;
+  base::TimeDelta warn = WarnThreshold();
+  base::TimeDelta unresponsive = UnresponsiveThreshold();
+  base::TimeDelta kill = std::max(kill_after_, unresponsive);
+  if (stage_ < WARNING && elapsed >= warn) {
+    EnterStage(WARNING, "watchdog", elapsed, warn);
+  }
+  if (stage_ < UNRESPONSIVE && elapsed >= unresponsive) {
+    EnterStage(UNRESPONSIVE, "watchdog", elapsed, unresponsive);
+  }
+  if (!kill_after_.is_zero() && elapsed >= kill) {
+    EnterStage(KILLED, "watchdog", elapsed, kill);
+    return;
+  }
+
+  base::TimeDelta next;
+  if (stage_ < UNRESPONSIVE) {
+    next = unresponsive;
+  } else if (!kill_after_.is_zero()) {
+    next = kill;
+  } else {
+    // waits for the answer (or a new renderer).
+    return;
+  }
+  timer_.Start(FROM_HERE, next - elapsed, base::Bind(&UnresponsiveWatchdog::Check, base::Unretained(this)));
+}
+
+void UnresponsiveWatchdog::Escalate(const std::string& source) {
+  if (stage_ >= UNRESPONSIVE) {
+    return;
+  }
+  base::TimeDelta elapsed;
+  if (!ping_sent_.is_null()) {
+    elapsed = base::TimeTicks::Now() - ping_sent_;
+  }
+  EnterStage(UNRESPONSIVE, source, elapsed, UnresponsiveThreshold());
+}
+
+void UnresponsiveWatchdog::OnResponsive(const std::string& source) {
+  base::TimeDelta elapsed;
+  if (!ping_sent_.is_null()) {
+    elapsed = base::TimeTicks::Now() - ping_sent_;
+  }
+  Recover(source, elapsed);
+}
+
+void UnresponsiveWatchdog::Recover(const std::string& source, base::TimeDelta elapsed) {
+  // sent once, by whichever of the ping and the hang monitor sees it first.
+  if (stage_ != WARNING && stage_ != UNRESPONSIVE) {
+    return;
+  }
+  recoveries_++;
+  FlushPendingStage();
+  stage_ = RESPONSIVE;
+  base::DictionaryValue details;
+  details.SetString("stage", StageToString(RESPONSIVE));
+  details.SetString("source", source);
+  details.SetDouble("elapsed", elapsed.InMillisecondsF());
+  details.SetDouble("baseline", baseline_);
+  details.SetDouble("deviation", deviation_);
+  delegate_->OnWatchdogStage(RESPONSIVE, details);
+}
+
+void UnresponsiveWatchdog::EnterStage(Stage stage, const std::string& source, base::TimeDelta elapsed, base::TimeDelta threshold) {
+  FlushPendingStage();
+  if (stage == KILLED && !delegate_->KillRenderer()) {
+    // stays unresponsive, and waits for the answer.
+    LOG(WARNING) << __PRETTY_FUNCTION__ << " : the renderer is not killed, its process hosts other pages";
+    timer_.Stop();
+    return;
+  }
+  stage_ = stage;
+  LOG(INFO) << __PRETTY_FUNCTION__ << " : " << StageToString(stage) << " (" << source << ") " << elapsed.InMilliseconds() << "ms";
+
+  std::unique_ptr<base::DictionaryValue> details(new base::DictionaryValue());
+  details->SetString("stage", StageToString(stage));
+  details->SetString("source", source);
+  details->SetDouble("elapsed", elapsed.InMillisecondsF());
+  details->SetDouble("baseline", baseline_);
+  details->SetDouble("deviation", deviation_);
+  details->SetDouble("threshold", threshold.InMillisecondsF());
+
+  if (stage == KILLED) {
+    kills_++;
+    timer_.Stop();
+    ping_sent_ = base::TimeTicks();
+    // no time to wait for a stack, the one of the stages before is sent.
+    details->SetString("stack", last_stack_);
+    delegate_->OnWatchdogStage(KILLED, *details);
+    return;
+  }
+
+  if (stage == WARNING) {
+    warnings_++;
+  } else {
+    unresponsive_++;
+  }
+  pending_stage_ = stage;
+  pending_details_ = std::move(details);
+  delegate_->RequestHangStack(++stack_request_id_, stack_timeout_);
+  stack_timer_.Start(FROM_HERE, stack_timeout_, base::Bind(&UnresponsiveWatchdog::FlushPendingStage, base::Unretained(this)));
+}
+
+void UnresponsiveWatchdog::OnHangStack(int request_id, const std::string& stack) {
+  if (request_id != stack_request_id_) {
+    return;
+  }
+  stacks_captured_++;
+  last_stack_ = stack;
+  if (pending_details_) {
+    pending_details_->SetString("stack", stack);
+    FlushPendingStage();
+  }
+}
+
+void UnresponsiveWatchdog::FlushPendingStage(void) {
+  stack_timer_.Stop();
+  if (!pending_details_) {
+    return;
+  }
+  std::unique_ptr<base::DictionaryValue> details = std::move(pending_details_);
+  if (!details->HasKey("stack")) {
+    details->SetString("stack", std::string());
+  }
+  delegate_->OnWatchdogStage(pending_stage_, *details);
+}
+
+std::unique_ptr<base::DictionaryValue> UnresponsiveWatchdog::GetStatistics(void) const {
+  std::unique_ptr<base::DictionaryValue> stats(new base::DictionaryValue());
+  stats->SetBoolean("enabled", enabled_);
+  stats->SetString("stage", StageToString(stage_));
+  stats->SetInteger("samples", samples_);
+  // milliseconds.
+  stats->SetDouble("baseline", baseline_);
+  stats->SetDouble("deviation", deviation_);
+  stats->SetDouble("warnThreshold", WarnThreshold().InMillisecondsF());
+  stats->SetDouble("unresponsiveThreshold", UnresponsiveThreshold().InMillisecondsF());
+  stats->SetInteger("warnings", warnings_);
+  stats->SetInteger("unresponsive", unresponsive_);
+  stats->SetInteger("kills", kills_);
+  stats->SetInteger("recoveries", recoveries_);
+  stats->SetInteger("stacksCaptured", stacks_captured_);
+  return stats;
+}
+
+// static
+const char* UnresponsiveWatchdog::StageToString(Stage stage) {
+  switch (stage) {
+  case RESPONSIVE:
+    return "responsive";
+  case WARNING:
+    return "warning";
+  case UNRESPONSIVE:
+    return "unresponsive";
+  case KILLED:
+    return "killed";
+  }
+  return "unknown";
+}
+}
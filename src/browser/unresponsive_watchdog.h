@@ -0,0 +1,125 @@
+//-*-c++-*-
+#pragma once
+
+#include <memory>
+#include <string>
+#include "base/macros.h"
+#include "base/time/time.h"
+#include "base/timer/timer.h"
+#include "base/values.h"
+
+namespace meson {
+// Watches the main thread of the renderer of a window.
+// The renderer is pinged every |interval|, and the round trips are learned as
+// a moving average and deviation, so a page that is slow anyway (e.g. busy
+// with GC) is not taken as hung. A ping that is not answered escalates:
+//  WARNING:      past max(warnAfter, average + deviations * deviation).
+//  UNRESPONSIVE: past max(unresponsiveAfter, 2 * the warning threshold).
+//  KILLED:       past killAfter, if it is set and the process is not shared.
+// A JS stack of the renderer is asked for on each stage, and the stage is
+// reported with it (or without, if it does not come in time).
+// The watchdog is the only one to report the stages, including RESPONSIVE,
+// the hang monitor of content is fed to it by Escalate() and OnResponsive().
+class UnresponsiveWatchdog {
+ public:
+  enum Stage {
+    RESPONSIVE,
+    WARNING,
+    UNRESPONSIVE,
+    KILLED,
+  };
+
+  class Delegate {
+   public:
+    // false if there is no live renderer to ping.
+    virtual bool SendPing(int seq) = 0;
+    // the stack is not taken after |timeout|.
+    virtual void RequestHangStack(int request_id, base::TimeDelta timeout) = 0;
+    // false while the events are suppressed (e.g. a modal dialog is shown).
+    virtual bool CanEscalate() = 0;
+    // false if it is not killed (e.g. the process hosts other pages).
+    virtual bool KillRenderer() = 0;
+    // |details|: {stage, source, elapsed, baseline, deviation, threshold, stack}
+    virtual void OnWatchdogStage(Stage stage, const base::DictionaryValue& details) = 0;
+
+   protected:
+    virtual ~Delegate() {}
+  };
+
+  explicit UnresponsiveWatchdog(Delegate* delegate);
+  ~UnresponsiveWatchdog(void);
+
+  // options: {enabled, interval, warnAfter, unresponsiveAfter, killAfter,
+  //           deviations, stackTimeout} (milliseconds)
+  bool Configure(const base::DictionaryValue& options);
+
+  // a new renderer is ready, the one before is forgotten.
+  void Start(void);
+  void Stop(void);
+
+  void OnPong(int seq);
+  void OnHangStack(int request_id, const std::string& stack);
+  // the renderer is reported hung by someone else (the content hang monitor).
+  void Escalate(const std::string& source);
+  // the renderer is reported responsive by someone else.
+  void OnResponsive(const std::string& source);
+
+  Stage stage(void) const { return stage_; }
+
+  // {enabled, stage, samples, baseline, deviation, warnThreshold,
+  //  unresponsiveThreshold, warnings, unresponsive, kills, recoveries,
+  //  stacksCaptured}
+  std::unique_ptr<base::DictionaryValue> GetStatistics(void) const;
+
+  static const char* StageToString(Stage stage);
+
+ private:
+  base::TimeDelta WarnThreshold(void) const;
+  base::TimeDelta UnresponsiveThreshold(void) const;
+  void SendPing(void);
+  void Check(void);
+  void EnterStage(Stage stage, const std::string& source, base::TimeDelta elapsed, base::TimeDelta threshold);
+  void FlushPendingStage(void);
+  void Recover(const std::string& source, base::TimeDelta elapsed);
+  void Learn(base::TimeDelta rtt);
+
+ private:
+  Delegate* delegate_;
+
+  bool enabled_;
+  base::TimeDelta interval_;
+  base::TimeDelta warn_after_;
+  base::TimeDelta unresponsive_after_;
+  // zero: never.
+  base::TimeDelta kill_after_;
+  double deviations_;
+  base::TimeDelta stack_timeout_;
+
+  // there is a renderer to ping.
+  bool started_;
+  Stage stage_;
+  int seq_;
+  // zero if no ping is outstanding.
+  base::TimeTicks ping_sent_;
+  base::OneShotTimer timer_;
+
+  // milliseconds.
+  double baseline_;
+  double deviation_;
+  int samples_;
+
+  // the stage waiting for its stack.
+  int stack_request_id_;
+  std::unique_ptr<base::DictionaryValue> pending_details_;
+  Stage pending_stage_;
+  base::OneShotTimer stack_timer_;
+  std::string last_stack_;
+
+  int warnings_;
+  int unresponsive_;
+  int kills_;
+  int recoveries_;
+  int stacks_captured_;
+  DISALLOW_COPY_AND_ASSIGN(UnresponsiveWatchdog);
+};
+}
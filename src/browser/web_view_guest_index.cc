@@ -0,0 +1,166 @@
+#include "browser/web_view_guest_index.h"
+
+#include <vector>
+#include "base/time/time.h"
+
+namespace meson {
+WebViewGuestIndex::WebViewGuestIndex(void) {
+}
+
+WebViewGuestIndex::~WebViewGuestIndex(void) {
+}
+
+// static
+int64_t WebViewGuestIndex::ElementKey(int embedder_process_id, int element_instance_id) {
+  return (static_cast<int64_t>(embedder_process_id) << 32) | static_cast<uint32_t>(element_instance_id);
+}
+
+// static
+template <typename K>
+void WebViewGuestIndex::RemoveFromSet(std::unordered_map<K, GuestSet>* map, const K& key, int guest_instance_id) {
+  auto fiter = map->find(key);
+  if (fiter == map->end()) {
+    return;
+  }
+  (*fiter).second.erase(guest_instance_id);
+  if ((*fiter).second.empty()) {
+    map->erase(fiter);
+  }
+}
+
+void WebViewGuestIndex::Add(int guest_instance_id, const Entry& entry) {
+  Remove(guest_instance_id);
+  int64_t key = ElementKey(entry.embedder_process_id, entry.element_instance_id);
+  auto fiter = element_guests_.find(key);
+  if (fiter != element_guests_.end()) {
+    // the element is given a new guest.
+    Remove((*fiter).second);
+  }
+  entries_[guest_instance_id] = entry;
+  element_guests_[key] = guest_instance_id;
+  embedder_guests_[entry.embedder].insert(guest_instance_id);
+  if (entry.process_id != -1) {
+    process_guests_[entry.process_id].insert(guest_instance_id);
+  }
+}
+
+bool WebViewGuestIndex::Remove(int guest_instance_id) {
+  auto fiter = entries_.find(guest_instance_id);
+  if (fiter == entries_.end()) {
+    return false;
+  }
+  const Entry& entry = (*fiter).second;
+  element_guests_.erase(ElementKey(entry.embedder_process_id, entry.element_instance_id));
+  RemoveFromSet(&embedder_guests_, entry.embedder, guest_instance_id);
+  RemoveFromSet(&process_guests_, entry.process_id, guest_instance_id);
+  entries_.erase(fiter);
+  return true;
+}
+
+void WebViewGuestIndex::SetProcess(int guest_instance_id, int process_id) {
+  auto fiter = entries_.find(guest_instance_id);
+  if (fiter == entries_.end() || (*fiter).second.process_id == process_id) {
+    return;
+  }
+  RemoveFromSet(&process_guests_, (*fiter).second.process_id, guest_instance_id);
+  (*fiter).second.process_id = process_id;
+  if (process_id != -1) {
+    process_guests_[process_id].insert(guest_instance_id);
+  }
+}
+
+const WebViewGuestIndex::Entry* WebViewGuestIndex::Get(int guest_instance_id) const {
+  auto fiter = entries_.find(guest_instance_id);
+  return fiter == entries_.end() ? nullptr : &(*fiter).second;
+}
+
+int WebViewGuestIndex::GetGuestForElement(int embedder_process_id, int element_instance_id) const {
+  auto fiter = element_guests_.find(ElementKey(embedder_process_id, element_instance_id));
+  return fiter == element_guests_.end() ? -1 : (*fiter).second;
+}
+
+const WebViewGuestIndex::GuestSet* WebViewGuestIndex::GetGuestsOfEmbedder(content::WebContents* embedder) const {
+  auto fiter = embedder_guests_.find(embedder);
+  return fiter == embedder_guests_.end() ? nullptr : &(*fiter).second;
+}
+
+const WebViewGuestIndex::GuestSet* WebViewGuestIndex::GetGuestsInProcess(int process_id) const {
+  auto fiter = process_guests_.find(process_id);
+  return fiter == process_guests_.end() ? nullptr : &(*fiter).second;
+}
+
+std::unique_ptr<base::DictionaryValue> WebViewGuestIndex::GetStatistics(void) const {
+  std::unique_ptr<base::DictionaryValue> stats(new base::DictionaryValue());
+  stats->SetInteger("guests", static_cast<int>(entries_.size()));
+  stats->SetInteger("embedders", static_cast<int>(embedder_guests_.size()));
+  stats->SetInteger("processes", static_cast<int>(process_guests_.size()));
+  return stats;
+}
+
+// static
+std::unique_ptr<base::DictionaryValue> WebViewGuestIndex::RunBenchmark(int guests, int embedders) {
+  WebViewGuestIndex index;
+  // the index never dereferences the web contents.
+  auto fake_contents = [](int n) { return reinterpret_cast<content::WebContents*>(static_cast<uintptr_t>(n + 1) * 16); };
+  // a few guests share each renderer process.
+  const int kGuestsPerProcess = 4;
+
+  base::TimeTicks start = base::TimeTicks::Now();
+  for (int i = 0; i < guests; ++i) {
+    int embedder = i % embedders;
+    Entry entry = {fake_contents(embedders + i), fake_contents(embedder), embedder, i / embedders, i / kGuestsPerProcess};
+    index.Add(i, entry);
+  }
+  base::TimeTicks added = base::TimeTicks::Now();
+
+  int found = 0;
+  for (int i = 0; i < guests; ++i) {
+    if (index.GetGuestForElement(i % embedders, i / embedders) == i) {
+      found++;
+    }
+  }
+  int enumerated = 0;
+  for (int e = 0; e < embedders; ++e) {
+    const GuestSet* set = index.GetGuestsOfEmbedder(fake_contents(e));
+    enumerated += set ? static_cast<int>(set->size()) : 0;
+  }
+  // as a guest process that is gone, then the guests moved to a new one.
+  int processes = (guests + kGuestsPerProcess - 1) / kGuestsPerProcess;
+  for (int p = 0; p < processes; ++p) {
+    const GuestSet* set = index.GetGuestsInProcess(p);
+    if (!set) {
+      continue;
+    }
+    std::vector<int> ids(set->begin(), set->end());
+    for (int id : ids) {
+      index.SetProcess(id, processes + p);
+    }
+  }
+  base::TimeTicks looked_up = base::TimeTicks::Now();
+
+  // as WebViewManager::OnDestroyEmbedder() does.
+  for (int e = 0; e < embedders; ++e) {
+    const GuestSet* set = index.GetGuestsOfEmbedder(fake_contents(e));
+    if (!set) {
+      continue;
+    }
+    std::vector<int> ids(set->begin(), set->end());
+    for (int id : ids) {
+      index.Remove(id);
+    }
+  }
+  base::TimeTicks torn_down = base::TimeTicks::Now();
+
+  std::unique_ptr<base::DictionaryValue> result(new base::DictionaryValue());
+  result->SetInteger("guests", guests);
+  result->SetInteger("embedders", embedders);
+  result->SetInteger("found", found);
+  result->SetInteger("enumerated", enumerated);
+  result->SetInteger("processes", processes);
+  result->SetInteger("remaining", static_cast<int>(index.size()));
+  result->SetDouble("addTime", (added - start).InMillisecondsF());
+  result->SetDouble("lookupTime", (looked_up - added).InMillisecondsF());
+  result->SetDouble("teardownTime", (torn_down - looked_up).InMillisecondsF());
+  return result;
+}
+}
@@ -0,0 +1,67 @@
+//-*-c++-*-
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include "base/macros.h"
+#include "base/values.h"
+
+namespace content {
+class WebContents;
+}
+
+namespace meson {
+// The attached guests of a WebViewManager, indexed by guest instance id,
+// by element (embedder process, element instance id), by embedder and by
+// guest process, so that adding, removing and enumerating guests does not
+// scan all of them. A guest whose process is gone (process id -1) is not in
+// the process index until it has a renderer again.
+class WebViewGuestIndex {
+ public:
+  struct Entry {
+    content::WebContents* web_contents;
+    content::WebContents* embedder;
+    int embedder_process_id;
+    int element_instance_id;
+    int process_id;
+  };
+  using GuestSet = std::unordered_set<int>;
+
+  WebViewGuestIndex(void);
+  ~WebViewGuestIndex(void);
+
+  // replaces the entry of |guest_instance_id|, and the guest of its element.
+  void Add(int guest_instance_id, const Entry& entry);
+  bool Remove(int guest_instance_id);
+  // the guest was moved to |process_id|, -1 if its process is gone.
+  void SetProcess(int guest_instance_id, int process_id);
+  const Entry* Get(int guest_instance_id) const;
+  // -1 if the element has no guest.
+  int GetGuestForElement(int embedder_process_id, int element_instance_id) const;
+  // nullptr if none.
+  const GuestSet* GetGuestsOfEmbedder(content::WebContents* embedder) const;
+  const GuestSet* GetGuestsInProcess(int process_id) const;
+  size_t size(void) const { return entries_.size(); }
+
+  // {guests, embedders, processes}
+  std::unique_ptr<base::DictionaryValue> GetStatistics(void) const;
+  // Adds |guests| synthetic guests spread over |embedders|, looks each one up,
+  // moves the guests of each process to another one and tears the embedders
+  // down. Times are in milliseconds.
+  static std::unique_ptr<base::DictionaryValue> RunBenchmark(int guests, int embedders);
+
+ private:
+  static int64_t ElementKey(int embedder_process_id, int element_instance_id);
+  template <typename K>
+  static void RemoveFromSet(std::unordered_map<K, GuestSet>* map, const K& key, int guest_instance_id);
+
+ private:
+  std::unordered_map<int, Entry> entries_;
+  // element key -> guest instance id
+  std::unordered_map<int64_t, int> element_guests_;
+  std::unordered_map<content::WebContents*, GuestSet> embedder_guests_;
+  std::unordered_map<int, GuestSet> process_guests_;
+  DISALLOW_COPY_AND_ASSIGN(WebViewGuestIndex);
+};
+}
@@ -1,6 +1,11 @@
 #include "browser/web_view_manager.h"
 
+#include <algorithm>
+#include <vector>
+
+#include "base/bind.h"
 #include "base/strings/utf_string_conversions.h"
+#include "base/threading/thread_task_runner_handle.h"
 #include "browser/session/meson_browser_context.h"
 #include "content/public/browser/render_process_host.h"
 #include "content/public/browser/web_contents.h"
@@ -10,10 +15,21 @@
 #include "common/options_switches.h"
 #include "api/api.h"
 #include "api/api_binding.h"
+#include "browser/guest_process_policy.h"
 #include "browser/web_view_guest_delegate.h"
 #include "browser/web_contents_preferences.h"
 
 namespace meson {
+namespace {
+// guests whose creation timings are kept.
+const size_t kMaxGuestTimings = 64;
+
+GuestProcessPolicy* GetGuestProcessPolicy(WebContentsBinding* guest) {
+  // the guest may be in another partition than its embedder.
+  return static_cast<MesonBrowserContext*>(guest->GetWebContents()->GetBrowserContext())->GetGuestProcessPolicy();
+}
+}
+
 class IWebViewClient {
  public:
   virtual void EmitEvent(scoped_refptr<api::EventArg> event) = 0;
@@ -89,11 +105,15 @@ class WebViewManager::GuestInstance final : public base::RefCountedThreadSafe<Gu
   unsigned int binding_id_;
   int guestInstanceId;
   int elementInstanceId;
+  int embedderId;
   base::DictionaryValue attachParams;
   scoped_refptr<WebViewBindingRemote> remote_;
 
  private:
   bool allowPopups;
+  // all events are sent until the embedder tells its subscriptions.
+  bool filterEvents;
+  std::set<std::string> subscribedEvents;
 
  public:
   GuestInstance(WebViewManager& m, int giid, scoped_refptr<WebContentsBinding> c)
@@ -101,8 +121,10 @@ class WebViewManager::GuestInstance final : public base::RefCountedThreadSafe<Gu
         binding_id_(c->GetID()),
         guestInstanceId(giid),
         elementInstanceId(-1),
+        embedderId(c->GetEmbedder() ? c->GetEmbedder()->GetID() : 0),
         remote_(make_scoped_refptr(new WebViewBindingRemote(*this, c))),
-        allowPopups(false) {
+        allowPopups(false),
+        filterEvents(false) {
     LOG(INFO) << __PRETTY_FUNCTION__ << " : " << binding_id_;
     WebContentsBinding::Class().SetRemote(c->GetID(), remote_.get());
   }
@@ -121,7 +143,29 @@ class WebViewManager::GuestInstance final : public base::RefCountedThreadSafe<Gu
     if (name == "did-attach") {
       OnDidAttach();
     }
-    Binding()->WebViewEmit(name, *event->event_);
+    mgr_.RecordGuestTiming(guestInstanceId, name);
+    auto& stats = mgr_.guest_events_;
+    if (stats.filtering && filterEvents && !base::ContainsKey(subscribedEvents, name)) {
+      stats.filtered++;
+      stats.filtered_types[name]++;
+      return;
+    }
+    size_t size = Binding()->WebViewEmit(name, *event->event_);
+    if (size > 0) {
+      stats.forwarded++;
+      stats.forwarded_bytes += size;
+    }
+  }
+
+  void SetSubscriptions(const base::ListValue& events) {
+    subscribedEvents.clear();
+    for (const auto& value : events) {
+      std::string type;
+      if (value->GetAsString(&type)) {
+        subscribedEvents.insert(type);
+      }
+    }
+    filterEvents = true;
   }
 
  private:
@@ -167,22 +211,22 @@ class WebViewManager::GuestInstance final : public base::RefCountedThreadSafe<Gu
 };
 
 WebViewManager::WebViewManager(void)
-    : nextGuestInstanceId_(0) {
+    : nextGuestInstanceId_(0),
+      guest_pools_closed_(false),
+      guest_processes_gone_(0),
+      guests_in_gone_processes_(0),
+      weak_factory_(this) {
   LOG(INFO) << __PRETTY_FUNCTION__;
 }
 
 WebViewManager::~WebViewManager() {
   LOG(INFO) << __PRETTY_FUNCTION__;
+  CloseGuestPools();
 }
 
 int WebViewManager::GetGuestInstanceID(const content::WebContents* embedder, int element_instance_id) {
   int owner_process_id = embedder->GetRenderProcessHost()->GetID();
-  ElementInstanceKey key(owner_process_id, element_instance_id);
-  auto fiter = element_instance_id_to_guest_map_.find(key);
-  if (fiter == element_instance_id_to_guest_map_.end()) {
-    return -1;
-  }
-  return (*fiter).second;
+  return guest_index_.GetGuestForElement(owner_process_id, element_instance_id);
 }
 
 void WebViewManager::AddGuest(int guest_instance_id,
@@ -190,53 +234,47 @@ void WebViewManager::AddGuest(int guest_instance_id,
                               content::WebContents* embedder,
                               content::WebContents* web_contents) {
   LOG(INFO) << __PRETTY_FUNCTION__;
-  web_contents_embedder_map_[guest_instance_id] = {web_contents, embedder};
-
   // Map the element in embedder to guest.
-  int owner_process_id = embedder->GetRenderProcessHost()->GetID();
-  ElementInstanceKey key(owner_process_id, element_instance_id);
-  element_instance_id_to_guest_map_[key] = guest_instance_id;
+  WebViewGuestIndex::Entry entry;
+  entry.web_contents = web_contents;
+  entry.embedder = embedder;
+  entry.embedder_process_id = embedder->GetRenderProcessHost()->GetID();
+  entry.element_instance_id = element_instance_id;
+  entry.process_id = web_contents->GetRenderProcessHost()->GetID();
+  guest_index_.Add(guest_instance_id, entry);
 }
 
 void WebViewManager::RemoveGuest(int guest_instance_id) {
   LOG(INFO) << __PRETTY_FUNCTION__;
-
-  web_contents_embedder_map_.erase(guest_instance_id);
-
-  // Remove the record of element in embedder too.
-  for (const auto& element : element_instance_id_to_guest_map_)
-    if (element.second == guest_instance_id) {
-      element_instance_id_to_guest_map_.erase(element.first);
-      break;
-    }
+  guest_index_.Remove(guest_instance_id);
 }
 
 content::WebContents* WebViewManager::GetEmbedder(int guest_instance_id) {
-  if (base::ContainsKey(web_contents_embedder_map_, guest_instance_id))
-    return web_contents_embedder_map_[guest_instance_id].embedder;
-  else
-    return nullptr;
+  auto entry = guest_index_.Get(guest_instance_id);
+  return entry ? entry->embedder : nullptr;
 }
 
 content::WebContents* WebViewManager::GetGuestByInstanceID(
     int owner_process_id,
     int element_instance_id) {
-  ElementInstanceKey key(owner_process_id, element_instance_id);
-  if (!base::ContainsKey(element_instance_id_to_guest_map_, key))
-    return nullptr;
-
-  int guest_instance_id = element_instance_id_to_guest_map_[key];
-  if (base::ContainsKey(web_contents_embedder_map_, guest_instance_id))
-    return web_contents_embedder_map_[guest_instance_id].web_contents;
-  else
-    return nullptr;
+  int guest_instance_id = guest_index_.GetGuestForElement(owner_process_id, element_instance_id);
+  auto entry = guest_index_.Get(guest_instance_id);
+  return entry ? entry->web_contents : nullptr;
 }
 
 bool WebViewManager::ForEachGuest(content::WebContents* embedder_web_contents,
                                   const GuestCallback& callback) {
-  for (auto& item : web_contents_embedder_map_)
-    if (item.second.embedder == embedder_web_contents && callback.Run(item.second.web_contents))
+  auto guests = guest_index_.GetGuestsOfEmbedder(embedder_web_contents);
+  if (!guests) {
+    return false;
+  }
+  // the callback may remove guests.
+  std::vector<int> ids(guests->begin(), guests->end());
+  for (int id : ids) {
+    auto entry = guest_index_.Get(id);
+    if (entry && callback.Run(entry->web_contents))
       return true;
+  }
   return false;
 }
 
@@ -263,33 +301,117 @@ bool WebViewManager::OnMessageReceived(const IPC::Message& message, content::Web
 }
 #endif
 
-void WebViewManager::OnCreateWebViewGuest(content::WebContents* web_contents, const base::DictionaryValue& params, int* guest_instance_id) {
+int WebViewManager::OnCreateWebViewGuest(content::WebContents* web_contents, const base::DictionaryValue& params) {
   LOG(INFO) << __PRETTY_FUNCTION__ << "(" << params << ")";
-  int guestInstanceId = GetNextGuestInstanceId();
-  std::unique_ptr<base::DictionaryValue> opt(new base::DictionaryValue());
-  opt->SetBoolean("isGuest", true);
-  opt->SetInteger("guest_instance_id", guestInstanceId);
   std::string partition;
-  if (params.GetStringWithoutPathExpansion("partition", &partition)) {
-    opt->SetString("partition", partition);
-  }
+  bool has_partition = params.GetStringWithoutPathExpansion("partition", &partition);
 
   auto parentapi = WebContentsBinding::Class().FindBinding([web_contents](const WebContentsBinding& b) {
     return b.GetWebContents() == web_contents;
   });
   CHECK(parentapi) << "Parent api is not found!";
   WatchEmbedder(parentapi.get());
+  guest_creation_.requested++;
+  base::TimeTicks now = base::TimeTicks::Now();
+
+  auto api = TakePooledGuest(partition);
+  if (api) {
+    // there is nothing to construct.
+    int guestInstanceId = api->GetGuestInstanceID();
+    api->AttachToEmbedder(parentapi.get());
+    AddGuestInstance(guestInstanceId, api, now, true);
+    return guestInstanceId;
+  }
+
+  int guestInstanceId = GetNextGuestInstanceId();
+  auto& pending = pending_guests_[guestInstanceId];
+  pending.embedder_id = parentapi->GetID();
+  pending.has_partition = has_partition;
+  pending.partition = partition;
+  // the process policy groups the guests by the origin of their first page.
+  params.GetStringWithoutPathExpansion("src", &pending.src);
+  pending.requested = now;
+  base::ThreadTaskRunnerHandle::Get()->PostTask(FROM_HERE, base::Bind(&WebViewManager::CreatePendingGuest, weak_factory_.GetWeakPtr(), guestInstanceId, false));
+  return guestInstanceId;
+}
+
+void WebViewManager::CreatePendingGuest(int guest_instance_id, bool on_demand) {
+  auto fiter = pending_guests_.find(guest_instance_id);
+  if (fiter == pending_guests_.end()) {
+    return;
+  }
+  PendingGuest pending = (*fiter).second;
+  pending_guests_.erase(fiter);
+  LOG(INFO) << __PRETTY_FUNCTION__ << "(" << guest_instance_id << ", " << on_demand << ")";
+
+  auto parentapi = WebContentsBinding::Class().GetBinding(pending.embedder_id);
+  if (!parentapi) {
+    return;
+  }
+  if (on_demand) {
+    guest_creation_.on_demand++;
+  }
+  std::unique_ptr<base::DictionaryValue> opt(new base::DictionaryValue());
+  opt->SetBoolean("isGuest", true);
+  opt->SetInteger("guest_instance_id", guest_instance_id);
+  if (pending.has_partition) {
+    opt->SetString("partition", pending.partition);
+  }
   opt->SetInteger("embedder", parentapi->GetID());
+  if (!pending.src.empty()) {
+    opt->SetString("src", pending.src);
+  }
   auto api = static_cast<WebContentsClassBinding&>(WebContentsBinding::Class()).NewInstance(*opt);
+  AddGuestInstance(guest_instance_id, api, pending.requested, false);
+}
 
-  auto client = make_scoped_refptr(new GuestInstance(*this, guestInstanceId, api));
-  guest_instances_[guestInstanceId] = client;
+void WebViewManager::AddGuestInstance(int guest_instance_id, scoped_refptr<WebContentsBinding> guest, base::TimeTicks requested, bool pooled) {
+  auto client = make_scoped_refptr(new GuestInstance(*this, guest_instance_id, guest));
+  guest_instances_[guest_instance_id] = client;
+  embedder_guest_instances_[client->embedderId].insert(guest_instance_id);
+
+  if (guest_creation_.timings.find(guest_instance_id) == guest_creation_.timings.end()) {
+    guest_creation_.timing_order.push_back(guest_instance_id);
+  }
+  auto& timing = guest_creation_.timings[guest_instance_id];
+  timing.pooled = pooled;
+  timing.requested = requested;
+  timing.spawn = base::TimeTicks::Now() - requested;
+  // pooled guests are not placed by the policy, and are ignored by it.
+  GetGuestProcessPolicy(guest.get())->RecordSpawn(guest_instance_id, timing.spawn);
+  // pooled guests get their id when the pool is filled, before the guests
+  // added since, so the oldest is the first inserted, not the smallest id.
+  if (guest_creation_.timings.size() > kMaxGuestTimings) {
+    guest_creation_.timings.erase(guest_creation_.timing_order.front());
+    guest_creation_.timing_order.pop_front();
+  }
+}
 
-  *guest_instance_id = guestInstanceId;
+void WebViewManager::RecordGuestTiming(int guest_instance_id, const std::string& event) {
+  auto fiter = guest_creation_.timings.find(guest_instance_id);
+  if (fiter == guest_creation_.timings.end()) {
+    return;
+  }
+  auto& timing = (*fiter).second;
+  if (event == "did-attach" && !timing.attached) {
+    timing.attached = true;
+    timing.attach = base::TimeTicks::Now() - timing.requested;
+  } else if (event == "did-first-visually-non-empty-paint" && !timing.painted) {
+    timing.painted = true;
+    timing.first_paint = base::TimeTicks::Now() - timing.requested;
+    auto fguest = guest_instances_.find(guest_instance_id);
+    if (fguest != guest_instances_.end()) {
+      auto guest = (*fguest).second->Binding();
+      if (guest) {
+        GetGuestProcessPolicy(guest.get())->RecordFirstPaint(guest_instance_id, timing.first_paint);
+      }
+    }
+  }
 }
 
 void WebViewManager::OnAttachWindowGuest(content::WebContents* web_contents, int internal_instance_id, int guest_instance_id, const base::DictionaryValue& params) {
   LOG(INFO) << __PRETTY_FUNCTION__ << "(" << internal_instance_id << ", " << guest_instance_id << ")";
+  CreatePendingGuest(guest_instance_id, true);
   auto fiter = guest_instances_.find(guest_instance_id);
   // If this isn't a valid guest instance then do nothing.
   if (fiter == guest_instances_.end()) {
@@ -358,12 +480,25 @@ void WebViewManager::OnAttachWindowGuest(content::WebContents* web_contents, int
 
 void WebViewManager::OnDestroyWebViewGuest(int guest_instance_id) {
   LOG(INFO) << __PRETTY_FUNCTION__ << "(" << guest_instance_id << ")";
+  if (pending_guests_.erase(guest_instance_id) > 0) {
+    // destroyed before its web contents was created.
+    guest_creation_.cancelled++;
+    return;
+  }
   auto fiter = guest_instances_.find(guest_instance_id);
   scoped_refptr<GuestInstance> guest;
   if (fiter != guest_instances_.end()) {
     guest = (*fiter).second;
     guest_instances_.erase(fiter);
+    auto eiter = embedder_guest_instances_.find(guest->embedderId);
+    if (eiter != embedder_guest_instances_.end()) {
+      (*eiter).second.erase(guest_instance_id);
+      if ((*eiter).second.empty()) {
+        embedder_guest_instances_.erase(eiter);
+      }
+    }
   }
+  RemoveGuest(guest_instance_id);
   if (guest) {
     auto binding = guest->Binding();
     if (binding) {
@@ -373,6 +508,7 @@ void WebViewManager::OnDestroyWebViewGuest(int guest_instance_id) {
 }
 void WebViewManager::OnWebViewGuestSetAutoSize(content::WebContents* web_contents, int guest_instance_id, const base::DictionaryValue& params) {
   LOG(INFO) << __PRETTY_FUNCTION__ << "(" << guest_instance_id << ", " << params << ")";
+  CreatePendingGuest(guest_instance_id, true);
   auto fiter = guest_instances_.find(guest_instance_id);
   CHECK(fiter != guest_instances_.end()) << " invalid guest id.";
   auto client = (*fiter).second;
@@ -403,6 +539,7 @@ void WebViewManager::OnWebViewGuestSetAutoSize(content::WebContents* web_content
 
 void WebViewManager::OnWebViewGuestLoadUrl(content::WebContents* web_contents, int guest_instance_id, const std::string& url) {
   LOG(INFO) << __PRETTY_FUNCTION__ << "(" << guest_instance_id << ", " << url << ")";
+  CreatePendingGuest(guest_instance_id, true);
   auto fiter = guest_instances_.find(guest_instance_id);
   CHECK(fiter != guest_instances_.end()) << " invalid guest id.";
   auto guest = (*fiter).second;
@@ -414,6 +551,7 @@ void WebViewManager::OnWebViewGuestLoadUrl(content::WebContents* web_contents, i
 
 void WebViewManager::OnWebViewGuestGo(content::WebContents* web_contents, int guest_instance_id, int relative_index) {
   LOG(INFO) << __PRETTY_FUNCTION__ << "(" << guest_instance_id << ", " << relative_index << ")";
+  CreatePendingGuest(guest_instance_id, true);
   auto fiter = guest_instances_.find(guest_instance_id);
   CHECK(fiter != guest_instances_.end()) << " invalid guest id.";
   auto guest = (*fiter).second;
@@ -425,6 +563,7 @@ void WebViewManager::OnWebViewGuestGo(content::WebContents* web_contents, int gu
 void WebViewManager::OnWebViewGuestReload(content::WebContents* web_contents, int guest_instance_id, bool ignore_cache) {
   LOG(INFO) << __PRETTY_FUNCTION__ << "(" << guest_instance_id << ", " << ignore_cache << ")"
             << "is not implement yet.";
+  CreatePendingGuest(guest_instance_id, true);
   auto fiter = guest_instances_.find(guest_instance_id);
   CHECK(fiter != guest_instances_.end()) << " invalid guest id.";
   //auto& guestInstance = (*fiter).second;
@@ -435,6 +574,7 @@ void WebViewManager::OnWebViewGuestReload(content::WebContents* web_contents, in
 
 void WebViewManager::OnWebViewGuestStop(content::WebContents* web_contents, int guest_instance_id) {
   LOG(INFO) << __PRETTY_FUNCTION__ << "(" << guest_instance_id << ")";
+  CreatePendingGuest(guest_instance_id, true);
   auto fiter = guest_instances_.find(guest_instance_id);
   CHECK(fiter != guest_instances_.end()) << " invalid guest id.";
   auto guest = (*fiter).second;
@@ -446,6 +586,7 @@ void WebViewManager::OnWebViewGuestStop(content::WebContents* web_contents, int
 void WebViewManager::OnWebViewGuestSetZoom(content::WebContents* web_contents, int guest_instance_id, double zoom_factor) {
   LOG(INFO) << __PRETTY_FUNCTION__ << "(" << guest_instance_id << ")"
             << "is not implement yet.";
+  CreatePendingGuest(guest_instance_id, true);
   auto fiter = guest_instances_.find(guest_instance_id);
   CHECK(fiter != guest_instances_.end()) << " invalid guest id.";
   //auto& guestInstance = (*fiter).second;
@@ -457,6 +598,7 @@ void WebViewManager::OnWebViewGuestSetZoom(content::WebContents* web_contents, i
 
 void WebViewManager::OnWebViewGuestFind(content::WebContents* web_contents, int guest_instance_id, int request_id, const std::string& search_text, const base::DictionaryValue& options) {
   LOG(INFO) << __PRETTY_FUNCTION__ << "(" << guest_instance_id << ", " << search_text << ", " << options << ")";
+  CreatePendingGuest(guest_instance_id, true);
   auto fiter = guest_instances_.find(guest_instance_id);
   CHECK(fiter != guest_instances_.end()) << " invalid guest id.";
   auto guest = (*fiter).second;
@@ -469,12 +611,17 @@ void WebViewManager::OnWebViewGuestFind(content::WebContents* web_contents, int
   options.GetBoolean("find_next", &findopt.findNext);
   options.GetBoolean("word_start", &findopt.wordStart);
   options.GetBoolean("medial_capital_as_word_start", &findopt.medialCapitalAsWordStart);
+  bool stream = false;
+  int batch_interval = 50;
+  options.GetBoolean("stream", &stream);
+  options.GetInteger("batch_interval", &batch_interval);
 
-  api->web_contents()->Find(request_id, search_text16, findopt);
+  api->Find(request_id, search_text16, findopt, stream, std::max(batch_interval, 0));
 }
 
 void WebViewManager::OnWebViewGuestStopFinding(content::WebContents* web_contents, int guest_instance_id, const std::string& action) {
   LOG(INFO) << __PRETTY_FUNCTION__ << "(" << guest_instance_id << ", " << action << ")";
+  CreatePendingGuest(guest_instance_id, true);
   auto fiter = guest_instances_.find(guest_instance_id);
   CHECK(fiter != guest_instances_.end()) << " invalid guest id.";
   auto guest = (*fiter).second;
@@ -495,6 +642,7 @@ void WebViewManager::OnWebViewGuestStopFinding(content::WebContents* web_content
 
 void WebViewManager::OnWebViewGuestExecuteScript(content::WebContents* web_contents, int guest_instance_id, const std::string& script) {
   LOG(INFO) << __PRETTY_FUNCTION__ << "(" << guest_instance_id << ", " << script << ")";
+  CreatePendingGuest(guest_instance_id, true);
   auto fiter = guest_instances_.find(guest_instance_id);
   CHECK(fiter != guest_instances_.end()) << " invalid guest id.";
   auto guest = (*fiter).second;
@@ -504,6 +652,7 @@ void WebViewManager::OnWebViewGuestExecuteScript(content::WebContents* web_conte
 }
 void WebViewManager::OnWebViewGuestOpenDevTools(content::WebContents* web_contents, int guest_instance_id) {
   LOG(INFO) << __PRETTY_FUNCTION__ << "(" << guest_instance_id << ")";
+  CreatePendingGuest(guest_instance_id, true);
   auto fiter = guest_instances_.find(guest_instance_id);
   CHECK(fiter != guest_instances_.end()) << " invalid guest id.";
   auto guest = (*fiter).second;
@@ -513,6 +662,7 @@ void WebViewManager::OnWebViewGuestOpenDevTools(content::WebContents* web_conten
 }
 void WebViewManager::OnWebViewGuestCloseDevTools(content::WebContents* web_contents, int guest_instance_id) {
   LOG(INFO) << __PRETTY_FUNCTION__ << "(" << guest_instance_id << ")";
+  CreatePendingGuest(guest_instance_id, true);
   auto fiter = guest_instances_.find(guest_instance_id);
   CHECK(fiter != guest_instances_.end()) << " invalid guest id.";
   auto guest = (*fiter).second;
@@ -522,6 +672,7 @@ void WebViewManager::OnWebViewGuestCloseDevTools(content::WebContents* web_conte
 }
 void WebViewManager::OnWebViewGuestIsDevToolsOpened(int guest_instance_id, bool* open) {
   LOG(INFO) << __PRETTY_FUNCTION__ << "(" << guest_instance_id << ")";
+  CreatePendingGuest(guest_instance_id, true);
   auto fiter = guest_instances_.find(guest_instance_id);
   CHECK(fiter != guest_instances_.end()) << " invalid guest id.";
   auto guest = (*fiter).second;
@@ -532,6 +683,7 @@ void WebViewManager::OnWebViewGuestIsDevToolsOpened(int guest_instance_id, bool*
 void WebViewManager::OnWebViewGuestJavaScriptDialogClosed(content::WebContents* web_contents, int guest_instance_id, bool success, const std::string& response) {
   LOG(INFO) << __PRETTY_FUNCTION__ << "(" << guest_instance_id << ", " << success << ", " << response << ")"
             << " is not implement yet.";
+  CreatePendingGuest(guest_instance_id, true);
   auto fiter = guest_instances_.find(guest_instance_id);
   CHECK(fiter != guest_instances_.end()) << " invalid guest id.";
   //auto& guestInstance = (*fiter).second;
@@ -540,6 +692,89 @@ void WebViewManager::OnWebViewGuestJavaScriptDialogClosed(content::WebContents*
   //auto api = (*fiter).second;
 }
 
+void WebViewManager::OnWebViewGuestSetEventSubscriptions(content::WebContents* web_contents, int guest_instance_id, const base::ListValue& events) {
+  LOG(INFO) << __PRETTY_FUNCTION__ << "(" << guest_instance_id << ", " << events << ")";
+  CreatePendingGuest(guest_instance_id, true);
+  auto fiter = guest_instances_.find(guest_instance_id);
+  CHECK(fiter != guest_instances_.end()) << " invalid guest id.";
+  (*fiter).second->SetSubscriptions(events);
+}
+
+void WebViewManager::OnWebViewGuestBatch(content::WebContents* web_contents, const base::ListValue& commands) {
+  LOG(INFO) << __PRETTY_FUNCTION__ << "(" << commands.GetSize() << ")";
+  for (const auto& value : commands) {
+    const base::DictionaryValue* command = nullptr;
+    int guest_instance_id = -1;
+    std::string type;
+    if (!value->GetAsDictionary(&command) ||
+        !command->GetInteger("guestInstanceId", &guest_instance_id) ||
+        !command->GetString("command", &type)) {
+      LOG(ERROR) << __PRETTY_FUNCTION__ << " : invalid command : " << *value;
+      continue;
+    }
+    CreatePendingGuest(guest_instance_id, true);
+    if (!base::ContainsKey(guest_instances_, guest_instance_id)) {
+      // the guest may be destroyed while the batch was in flight.
+      LOG(INFO) << __PRETTY_FUNCTION__ << " : guest(" << guest_instance_id << ") is already destroyed";
+      continue;
+    }
+
+    int i = 0;
+    bool b = false;
+    double d = 0.0;
+    std::string s;
+    if (type == "SetAutoSize") {
+      OnWebViewGuestSetAutoSize(web_contents, guest_instance_id, *command);
+    } else if (type == "Go") {
+      command->GetInteger("index", &i);
+      OnWebViewGuestGo(web_contents, guest_instance_id, i);
+    } else if (type == "LoadUrl") {
+      command->GetString("url", &s);
+      OnWebViewGuestLoadUrl(web_contents, guest_instance_id, s);
+    } else if (type == "Reload") {
+      command->GetBoolean("ignoreCache", &b);
+      OnWebViewGuestReload(web_contents, guest_instance_id, b);
+    } else if (type == "Stop") {
+      OnWebViewGuestStop(web_contents, guest_instance_id);
+    } else if (type == "SetZoom") {
+      command->GetDouble("zoomFactor", &d);
+      OnWebViewGuestSetZoom(web_contents, guest_instance_id, d);
+    } else if (type == "Find") {
+      const base::DictionaryValue* options = nullptr;
+      base::DictionaryValue empty;
+      command->GetInteger("requestId", &i);
+      command->GetString("searchText", &s);
+      if (!command->GetDictionary("options", &options)) {
+        options = &empty;
+      }
+      OnWebViewGuestFind(web_contents, guest_instance_id, i, s, *options);
+    } else if (type == "StopFinding") {
+      command->GetString("action", &s);
+      OnWebViewGuestStopFinding(web_contents, guest_instance_id, s);
+    } else if (type == "ExecuteScript") {
+      command->GetString("script", &s);
+      OnWebViewGuestExecuteScript(web_contents, guest_instance_id, s);
+    } else if (type == "OpenDevTools") {
+      OnWebViewGuestOpenDevTools(web_contents, guest_instance_id);
+    } else if (type == "CloseDevTools") {
+      OnWebViewGuestCloseDevTools(web_contents, guest_instance_id);
+    } else if (type == "JavaScriptDialogClosed") {
+      command->GetBoolean("success", &b);
+      command->GetString("response", &s);
+      OnWebViewGuestJavaScriptDialogClosed(web_contents, guest_instance_id, b, s);
+    } else if (type == "SetEventSubscriptions") {
+      const base::ListValue* events = nullptr;
+      base::ListValue empty;
+      if (!command->GetList("events", &events)) {
+        events = &empty;
+      }
+      OnWebViewGuestSetEventSubscriptions(web_contents, guest_instance_id, *events);
+    } else {
+      LOG(ERROR) << __PRETTY_FUNCTION__ << " : unknown command : " << type;
+    }
+  }
+}
+
 void WebViewManager::WatchEmbedder(scoped_refptr<WebContentsBinding> embedder) {
   LOG(INFO) << __PRETTY_FUNCTION__ << " : " << embedder->GetID();
   unsigned int embedder_id = embedder->GetID();
@@ -557,11 +792,15 @@ void WebViewManager::OnDestroyEmbedder(WebContentsBinding* embedder) {
   auto emb = make_scoped_refptr(embedder);
   unsigned int embedder_id = emb->GetID();
   std::vector<int> destroyed_guests;
-  for (auto& kv : guest_instances_) {
-    auto e = kv.second->Binding()->GetEmbedder();
-    CHECK(e);
-    if (e->GetID() == embedder_id) {
-      destroyed_guests.push_back(kv.first);
+  auto eiter = embedder_guest_instances_.find(embedder_id);
+  if (eiter != embedder_guest_instances_.end()) {
+    destroyed_guests.assign((*eiter).second.begin(), (*eiter).second.end());
+  }
+  for (auto iter = pending_guests_.begin(); iter != pending_guests_.end();) {
+    if ((*iter).second.embedder_id == static_cast<int>(embedder_id)) {
+      iter = pending_guests_.erase(iter);
+    } else {
+      ++iter;
     }
   }
   embedded_clients_.erase(emb->GetID());
@@ -569,4 +808,211 @@ void WebViewManager::OnDestroyEmbedder(WebContentsBinding* embedder) {
     OnDestroyWebViewGuest(giid);
   }
 }
+
+void WebViewManager::SetGuestPoolSize(const std::string& partition, int size) {
+  LOG(INFO) << __PRETTY_FUNCTION__ << "(" << partition << ", " << size << ")";
+  if (guest_pools_closed_) {
+    return;
+  }
+  auto& pool = guest_pools_[partition];
+  pool.size = std::max(size, 0);
+  while (static_cast<int>(pool.guests.size()) > pool.size) {
+    auto guest = pool.guests.back();
+    pool.guests.pop_back();
+    WebContentsBinding::Class().RemoveBinding(guest.get());
+  }
+  ScheduleFillGuestPool(partition);
+}
+
+std::unique_ptr<base::DictionaryValue> WebViewManager::GetGuestPoolStatistics(void) const {
+  std::unique_ptr<base::DictionaryValue> result(new base::DictionaryValue());
+  int hits = 0;
+  int misses = 0;
+  std::unique_ptr<base::DictionaryValue> partitions(new base::DictionaryValue());
+  for (const auto& kv : guest_pools_) {
+    std::unique_ptr<base::DictionaryValue> stat(new base::DictionaryValue());
+    stat->SetInteger("size", kv.second.size);
+    stat->SetInteger("ready", static_cast<int>(kv.second.guests.size()));
+    stat->SetInteger("hits", kv.second.hits);
+    stat->SetInteger("misses", kv.second.misses);
+    partitions->SetWithoutPathExpansion(kv.first, std::move(stat));
+    hits += kv.second.hits;
+    misses += kv.second.misses;
+  }
+  result->SetInteger("hits", hits);
+  result->SetInteger("misses", misses);
+  result->Set("partitions", std::move(partitions));
+  return result;
+}
+
+void WebViewManager::SetGuestEventFiltering(bool enabled) {
+  LOG(INFO) << __PRETTY_FUNCTION__ << "(" << enabled << ")";
+  guest_events_ = GuestEventStatistics();
+  guest_events_.filtering = enabled;
+}
+
+std::unique_ptr<base::DictionaryValue> WebViewManager::GetGuestEventStatistics(void) const {
+  std::unique_ptr<base::DictionaryValue> result(new base::DictionaryValue());
+  result->SetBoolean("filtering", guest_events_.filtering);
+  result->SetInteger("forwarded", guest_events_.forwarded);
+  // size of the MesonFrameMsg_WebViewEmit messages.
+  result->SetDouble("forwardedBytes", static_cast<double>(guest_events_.forwarded_bytes));
+  result->SetInteger("filtered", guest_events_.filtered);
+  std::unique_ptr<base::DictionaryValue> types(new base::DictionaryValue());
+  for (const auto& kv : guest_events_.filtered_types) {
+    types->SetIntegerWithoutPathExpansion(kv.first, kv.second);
+  }
+  result->Set("filteredTypes", std::move(types));
+  return result;
+}
+
+std::unique_ptr<base::DictionaryValue> WebViewManager::GetGuestCreationStatistics(void) const {
+  std::unique_ptr<base::DictionaryValue> result(new base::DictionaryValue());
+  result->SetInteger("requested", guest_creation_.requested);
+  // created by a message of the embedder before their task ran.
+  result->SetInteger("onDemand", guest_creation_.on_demand);
+  result->SetInteger("cancelled", guest_creation_.cancelled);
+  result->SetInteger("pending", static_cast<int>(pending_guests_.size()));
+  std::unique_ptr<base::ListValue> guests(new base::ListValue());
+  for (const auto& kv : guest_creation_.timings) {
+    const auto& timing = kv.second;
+    std::unique_ptr<base::DictionaryValue> guest(new base::DictionaryValue());
+    guest->SetInteger("guestInstanceId", kv.first);
+    guest->SetBoolean("pooled", timing.pooled);
+    // milliseconds, null until it happens.
+    guest->SetDouble("createToSpawn", timing.spawn.InMillisecondsF());
+    if (timing.attached) {
+      guest->SetDouble("createToAttach", timing.attach.InMillisecondsF());
+    } else {
+      guest->Set("createToAttach", base::Value::CreateNullValue());
+    }
+    if (timing.painted) {
+      guest->SetDouble("createToFirstPaint", timing.first_paint.InMillisecondsF());
+    } else {
+      guest->Set("createToFirstPaint", base::Value::CreateNullValue());
+    }
+    guests->Append(std::move(guest));
+  }
+  result->Set("guests", std::move(guests));
+  return result;
+}
+
+std::unique_ptr<base::DictionaryValue> WebViewManager::GetGuestIndexStatistics(void) const {
+  std::unique_ptr<base::DictionaryValue> result = guest_index_.GetStatistics();
+  result->SetInteger("guestInstances", static_cast<int>(guest_instances_.size()));
+  result->SetInteger("processesGone", guest_processes_gone_);
+  result->SetInteger("guestsInGoneProcesses", guests_in_gone_processes_);
+  return result;
+}
+
+void WebViewManager::GuestProcessChanged(int guest_instance_id, int process_id) {
+  guest_index_.SetProcess(guest_instance_id, process_id);
+}
+
+void WebViewManager::GuestProcessGone(int process_id) {
+  auto guests = guest_index_.GetGuestsInProcess(process_id);
+  if (!guests) {
+    // already done for another guest of the process.
+    return;
+  }
+  std::vector<int> ids(guests->begin(), guests->end());
+  LOG(INFO) << __PRETTY_FUNCTION__ << "(" << process_id << ") : " << ids.size() << " guests";
+  guest_processes_gone_++;
+  guests_in_gone_processes_ += static_cast<int>(ids.size());
+  // they get a new process when they are reloaded.
+  for (int id : ids) {
+    guest_index_.SetProcess(id, -1);
+  }
+}
+
+scoped_refptr<WebContentsBinding> WebViewManager::TakePooledGuest(const std::string& partition) {
+  auto fiter = guest_pools_.find(partition);
+  // partitions without a pool are neither hits nor misses.
+  if (fiter == guest_pools_.end() || (*fiter).second.size == 0) {
+    return nullptr;
+  }
+  auto& pool = (*fiter).second;
+  scoped_refptr<WebContentsBinding> guest;
+  while (!pool.guests.empty() && !guest) {
+    guest = pool.guests.front();
+    pool.guests.pop_front();
+    // drop guests whose renderer died while waiting in the pool.
+    if (!WebContentsBinding::Class().GetBinding(guest->GetID()) || guest->web_contents()->IsCrashed()) {
+      WebContentsBinding::Class().RemoveBinding(guest.get());
+      guest = nullptr;
+    }
+  }
+  if (guest) {
+    pool.hits++;
+  } else {
+    pool.misses++;
+  }
+  ScheduleFillGuestPool(partition);
+  return guest;
+}
+
+void WebViewManager::ScheduleFillGuestPool(const std::string& partition) {
+  auto fiter = guest_pools_.find(partition);
+  if (fiter == guest_pools_.end()) {
+    return;
+  }
+  auto& pool = (*fiter).second;
+  if (pool.fill_scheduled || static_cast<int>(pool.guests.size()) >= pool.size) {
+    return;
+  }
+  pool.fill_scheduled = true;
+  base::ThreadTaskRunnerHandle::Get()->PostTask(FROM_HERE, base::Bind(&WebViewManager::FillGuestPool, weak_factory_.GetWeakPtr(), partition));
+}
+
+void WebViewManager::FillGuestPool(const std::string& partition) {
+  auto fiter = guest_pools_.find(partition);
+  // the pool was cleared since.
+  if (fiter == guest_pools_.end()) {
+    return;
+  }
+  auto& pool = (*fiter).second;
+  pool.fill_scheduled = false;
+  if (static_cast<int>(pool.guests.size()) >= pool.size) {
+    return;
+  }
+  LOG(INFO) << __PRETTY_FUNCTION__ << "(" << partition << ") : " << pool.guests.size() << "/" << pool.size;
+  // embedder is attached when the guest is adopted by OnCreateWebViewGuest.
+  std::unique_ptr<base::DictionaryValue> opt(new base::DictionaryValue());
+  opt->SetBoolean("isGuest", true);
+  opt->SetInteger("guest_instance_id", GetNextGuestInstanceId());
+  if (!partition.empty()) {
+    opt->SetString("partition", partition);
+  }
+  auto api = static_cast<WebContentsClassBinding&>(WebContentsBinding::Class()).NewInstance(*opt);
+  // spawn the renderer process now, so adoption does not wait for it.
+  api->web_contents()->GetRenderProcessHost()->Init();
+  pool.guests.push_back(api);
+
+  // one guest per task, to keep the UI thread responsive.
+  ScheduleFillGuestPool(partition);
+}
+
+void WebViewManager::CloseGuestPools(void) {
+  guest_pools_closed_ = true;
+  std::vector<std::string> partitions;
+  for (const auto& kv : guest_pools_) {
+    partitions.push_back(kv.first);
+  }
+  // the fills already posted find no pool.
+  for (const auto& partition : partitions) {
+    ClearGuestPool(partition);
+  }
+}
+
+void WebViewManager::ClearGuestPool(const std::string& partition) {
+  auto fiter = guest_pools_.find(partition);
+  if (fiter == guest_pools_.end()) {
+    return;
+  }
+  auto guests = std::move((*fiter).second.guests);
+  guest_pools_.erase(fiter);
+  for (auto& guest : guests) {
+    WebContentsBinding::Class().RemoveBinding(guest.get());
+  }
+}
 }
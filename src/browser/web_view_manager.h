@@ -1,10 +1,15 @@
 //-*-c++-*-
 #pragma once
+#include <deque>
 #include <map>
+#include <set>
 
+#include "base/memory/weak_ptr.h"
+#include "base/time/time.h"
 #include "base/values.h"
 #include "content/public/browser/browser_plugin_guest_manager.h"
 #include "content/public/browser/render_frame_host.h"
+#include "browser/web_view_guest_index.h"
 
 namespace meson {
 class WebContentsBinding;
@@ -34,7 +39,10 @@ class WebViewManager : public content::BrowserPluginGuestManager {
 #endif
 
  public:
-  void OnCreateWebViewGuest(content::WebContents* web_contents, const base::DictionaryValue& params, int* guest_instance_id);
+  // Returns the guest instance id at once, the guest web contents is created
+  // by a later task (or by the first message which needs it).
+  int OnCreateWebViewGuest(content::WebContents* web_contents, const base::DictionaryValue& params);
+  void CreatePendingGuest(int guest_instance_id, bool on_demand);
   void OnAttachWindowGuest(content::WebContents* web_contents, int internal_instance_id, int guest_instance_id, const base::DictionaryValue& params);
   void OnDestroyWebViewGuest(int guest_instance_id);
   void OnWebViewGuestSetAutoSize(content::WebContents* web_contents, int guest_instance_id, const base::DictionaryValue& params);
@@ -50,11 +58,48 @@ class WebViewManager : public content::BrowserPluginGuestManager {
   void OnWebViewGuestCloseDevTools(content::WebContents* web_contents, int guest_instance_id);
   void OnWebViewGuestIsDevToolsOpened(int guest_instance_id, bool* open);
   void OnWebViewGuestJavaScriptDialogClosed(content::WebContents* web_contents, int guest_instance_id, bool success, const std::string& response);
+  // |events| are the types the <webview> has listeners for.
+  void OnWebViewGuestSetEventSubscriptions(content::WebContents* web_contents, int guest_instance_id, const base::ListValue& events);
+  void OnWebViewGuestBatch(content::WebContents* web_contents, const base::ListValue& commands);
 
  public:
   void WatchEmbedder(scoped_refptr<WebContentsBinding> embedder);
   void OnDestroyEmbedder(WebContentsBinding* embedder);
 
+ public:
+  // warm pool of pre-spawned guests (per partition).
+  void SetGuestPoolSize(const std::string& partition, int size);
+  std::unique_ptr<base::DictionaryValue> GetGuestPoolStatistics(void) const;
+  // releases the pooled guests of all the partitions, and fills no pool
+  // afterwards. the pooled guests hold the session, so it is not left to
+  // the destructor.
+  void CloseGuestPools(void);
+
+  // only the events subscribed by the embedder are sent to it.
+  // the counters start over, to compare both modes.
+  void SetGuestEventFiltering(bool enabled);
+  std::unique_ptr<base::DictionaryValue> GetGuestEventStatistics(void) const;
+
+  // create-to-spawn, create-to-attach and create-to-first-paint of the recent guests.
+  std::unique_ptr<base::DictionaryValue> GetGuestCreationStatistics(void) const;
+
+  // {guests, embedders, processes, guestInstances, processesGone, guestsInGoneProcesses}
+  std::unique_ptr<base::DictionaryValue> GetGuestIndexStatistics(void) const;
+
+  // keep the process index of the attached guests up to date.
+  void GuestProcessChanged(int guest_instance_id, int process_id);
+  // all the guests sharing |process_id| lost their renderer.
+  void GuestProcessGone(int process_id);
+
+ private:
+  scoped_refptr<WebContentsBinding> TakePooledGuest(const std::string& partition);
+  void ScheduleFillGuestPool(const std::string& partition);
+  void FillGuestPool(const std::string& partition);
+  void ClearGuestPool(const std::string& partition);
+  void AddGuestInstance(int guest_instance_id, scoped_refptr<WebContentsBinding> guest, base::TimeTicks requested, bool pooled);
+  // |event| is emitted by the guest.
+  void RecordGuestTiming(int guest_instance_id, const std::string& event);
+
  protected:
   // content::BrowserPluginGuestManager:
   content::WebContents* GetGuestByInstanceID(int owner_process_id, int element_instance_id) override;
@@ -62,38 +107,70 @@ class WebViewManager : public content::BrowserPluginGuestManager {
 
  private:
   int nextGuestInstanceId_;
-  struct WebContentsWithEmbedder {
-    content::WebContents* web_contents;
-    content::WebContents* embedder;
-  };
-  // guest_instance_id => (web_contents, embedder)
-  std::map<int, WebContentsWithEmbedder> web_contents_embedder_map_;
+  // attached guests
+  WebViewGuestIndex guest_index_;
   // guestInstanceID -> GuestInstance
   std::map<int, scoped_refptr<GuestInstance>> guest_instances_;
   // embedder's WebContentsBindingID -> EmbeddedClient
   std::map<int, scoped_refptr<EmbeddedClient>> embedded_clients_;
-
-  struct ElementInstanceKey {
-    int embedder_process_id;
-    int element_instance_id;
-
-    ElementInstanceKey(int embedder_process_id, int element_instance_id)
-        : embedder_process_id(embedder_process_id),
-          element_instance_id(element_instance_id) {}
-
-    bool operator<(const ElementInstanceKey& other) const {
-      if (embedder_process_id != other.embedder_process_id)
-        return embedder_process_id < other.embedder_process_id;
-      return element_instance_id < other.element_instance_id;
-    }
-
-    bool operator==(const ElementInstanceKey& other) const {
-      return (embedder_process_id == other.embedder_process_id) &&
-             (element_instance_id == other.element_instance_id);
-    }
+  // embedder's WebContentsBindingID -> guestInstanceIDs
+  std::unordered_map<int, WebViewGuestIndex::GuestSet> embedder_guest_instances_;
+
+  struct GuestPool {
+    int size = 0;
+    bool fill_scheduled = false;
+    int hits = 0;
+    int misses = 0;
+    std::deque<scoped_refptr<WebContentsBinding>> guests;
+  };
+  // partition -> GuestPool
+  std::map<std::string, GuestPool> guest_pools_;
+  bool guest_pools_closed_;
+
+  struct GuestEventStatistics {
+    bool filtering = true;
+    int forwarded = 0;
+    int64_t forwarded_bytes = 0;
+    int filtered = 0;
+    // event type -> filtered count
+    std::map<std::string, int> filtered_types;
+  };
+  GuestEventStatistics guest_events_;
+
+  struct PendingGuest {
+    int embedder_id = 0;
+    bool has_partition = false;
+    std::string partition;
+    std::string src;
+    base::TimeTicks requested;
   };
-  // (embedder_process_id, element_instance_id) => guest_instance_id
-  std::map<ElementInstanceKey, int> element_instance_id_to_guest_map_;
+  // guestInstanceID -> PendingGuest, the ids given to the renderer whose
+  // web contents is not created yet.
+  std::map<int, PendingGuest> pending_guests_;
+
+  struct GuestTiming {
+    bool pooled = false;
+    base::TimeTicks requested;
+    base::TimeDelta spawn;
+    base::TimeDelta attach;
+    base::TimeDelta first_paint;
+    bool attached = false;
+    bool painted = false;
+  };
+  struct GuestCreationStatistics {
+    int requested = 0;
+    int on_demand = 0;
+    int cancelled = 0;
+    // guestInstanceID -> GuestTiming, the recent guests only.
+    std::map<int, GuestTiming> timings;
+    // guestInstanceIDs of |timings|, oldest first.
+    std::deque<int> timing_order;
+  };
+  GuestCreationStatistics guest_creation_;
+  int guest_processes_gone_;
+  int guests_in_gone_processes_;
+
+  base::WeakPtrFactory<WebViewManager> weak_factory_;
 
   DISALLOW_COPY_AND_ASSIGN(WebViewManager);
 };
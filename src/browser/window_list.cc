@@ -4,7 +4,9 @@
 
 #include "browser/native_window.h"
 #include "browser/window_list_observer.h"
+#include "base/bind.h"
 #include "base/logging.h"
+#include "base/threading/thread_task_runner_handle.h"
 
 namespace meson {
 
@@ -27,10 +29,22 @@ void WindowList::AddWindow(NativeWindow* window) {
     observer.OnWindowAdded(window);
 }
 
+WindowList::CloseOptions::CloseOptions()
+    : force(false) {
+}
+
 void WindowList::RemoveWindow(NativeWindow* window) {
-  WindowVector& windows = GetInstance()->windows_;
+  WindowList* list = GetInstance();
+  WindowVector& windows = list->windows_;
   windows.erase(std::remove(windows.begin(), windows.end(), window), windows.end());
 
+  // done before OnWindowAllClosed(), which may shut down.
+  if (list->closing_.erase(window)) {
+    list->close_closed_++;
+    if (list->closing_.empty())
+      list->FinishClosing(list->close_forced_ ? "forced" : "closed");
+  }
+
   for (WindowListObserver& observer : observers_.Get())
     observer.OnWindowRemoved(window);
 
@@ -41,6 +55,17 @@ void WindowList::RemoveWindow(NativeWindow* window) {
 }
 
 void WindowList::WindowCloseCancelled(NativeWindow* window) {
+  WindowList* list = GetInstance();
+  if (list->closing_.count(window)) {
+    list->close_cancelled_++;
+    if (list->close_options_.force) {
+      // the close goes on, the window is destroyed once out of its handler.
+      base::ThreadTaskRunnerHandle::Get()->PostTask(FROM_HERE, base::Bind(&WindowList::ForceClose, window->GetWeakPtr()));
+      return;
+    }
+    list->FinishClosing("cancelled");
+  }
+
   for (WindowListObserver& observer : observers_.Get())
     observer.OnWindowCloseCancelled(window);
 }
@@ -53,14 +78,111 @@ void WindowList::RemoveObserver(WindowListObserver* observer) {
   observers_.Get().RemoveObserver(observer);
 }
 
-void WindowList::CloseAllWindows() {
-  WindowVector windows = GetInstance()->windows_;
-  for (const auto& window : windows)
+void WindowList::CloseAllWindows(const CloseOptions& options) {
+  WindowList* list = GetInstance();
+  if (list->closing_all_) {
+    // the one in progress goes on, with the new options.
+    list->close_options_ = options;
+    return;
+  }
+  WindowVector windows = list->windows_;
+  list->closing_all_ = true;
+  list->close_options_ = options;
+  list->close_start_ = base::TimeTicks::Now();
+  list->close_result_.clear();
+  list->close_windows_ = 0;
+  list->close_closed_ = 0;
+  list->close_cancelled_ = 0;
+  list->close_forced_ = 0;
+  list->close_dispatch_time_ = base::TimeDelta();
+  list->close_time_ = base::TimeDelta();
+  for (auto* window : windows) {
+    if (!window->IsClosed())
+      list->closing_.insert(window);
+  }
+  list->close_windows_ = static_cast<int>(list->closing_.size());
+  if (list->closing_.empty()) {
+    list->FinishClosing("closed");
+    return;
+  }
+  if (!options.timeout.is_zero())
+    list->close_timer_.Start(FROM_HERE, options.timeout, base::Bind(&WindowList::OnCloseTimeout, base::Unretained(list)));
+
+  // Close() returns once the beforeunload handler is dispatched, so the
+  // handlers of all the windows run at the same time. Every window is asked,
+  // as before, even once one has cancelled and the batch is no longer tracked.
+  for (auto* window : windows) {
     if (!window->IsClosed())
       window->Close();
+  }
+  list->close_dispatch_time_ = base::TimeTicks::Now() - list->close_start_;
+}
+
+void WindowList::FinishClosing(const std::string& result) {
+  if (!closing_all_)
+    return;
+  closing_all_ = false;
+  closing_.clear();
+  close_timer_.Stop();
+  close_result_ = result;
+  close_time_ = base::TimeTicks::Now() - close_start_;
+  LOG(INFO) << __PRETTY_FUNCTION__ << " : " << result << " " << close_closed_ << "/" << close_windows_ << " in " << close_time_.InMilliseconds() << "ms";
+}
+
+void WindowList::OnCloseTimeout() {
+  if (!close_options_.force) {
+    // the windows may still close, but no longer as a whole. taken as
+    // cancelled by the windows still open, so the quit is given up.
+    std::vector<NativeWindow*> windows(closing_.begin(), closing_.end());
+    FinishClosing("timeout");
+    for (auto* window : windows) {
+      for (WindowListObserver& observer : observers_.Get())
+        observer.OnWindowCloseCancelled(window);
+    }
+    return;
+  }
+  std::vector<NativeWindow*> windows(closing_.begin(), closing_.end());
+  for (auto* window : windows)
+    ForceClose(window->GetWeakPtr());
+}
+
+// static
+void WindowList::ForceClose(base::WeakPtr<NativeWindow> window) {
+  if (!window || window->IsClosed())
+    return;
+  WindowList* list = GetInstance();
+  if (!list->closing_.count(window.get()))
+    return;
+  list->close_forced_++;
+  // same as Browser::Exit(), the page is not asked.
+  window->CloseContents(nullptr);
+}
+
+// static
+std::unique_ptr<base::DictionaryValue> WindowList::GetCloseStatistics() {
+  WindowList* list = GetInstance();
+  std::unique_ptr<base::DictionaryValue> stats(new base::DictionaryValue());
+  stats->SetBoolean("inProgress", list->closing_all_);
+  stats->SetString("result", list->close_result_);
+  stats->SetInteger("windows", list->close_windows_);
+  stats->SetInteger("closed", list->close_closed_);
+  stats->SetInteger("cancelled", list->close_cancelled_);
+  stats->SetInteger("forced", list->close_forced_);
+  // milliseconds.
+  stats->SetDouble("timeout", list->close_options_.timeout.InMillisecondsF());
+  stats->SetBoolean("force", list->close_options_.force);
+  // until all the windows are asked, and until the last one is removed.
+  stats->SetDouble("dispatchTime", list->close_dispatch_time_.InMillisecondsF());
+  stats->SetDouble("closeTime", (list->closing_all_ ? base::TimeTicks::Now() - list->close_start_ : list->close_time_).InMillisecondsF());
+  return stats;
 }
 
-WindowList::WindowList() {}
+WindowList::WindowList()
+    : closing_all_(false),
+      close_windows_(0),
+      close_closed_(0),
+      close_cancelled_(0),
+      close_forced_(0) {}
 
 WindowList::~WindowList() {}
 
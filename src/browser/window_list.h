@@ -1,11 +1,18 @@
 //-*-c++-*-
 #pragma once
 
+#include <memory>
+#include <string>
+#include <unordered_set>
 #include <vector>
 
 #include "base/lazy_instance.h"
 #include "base/macros.h"
+#include "base/memory/weak_ptr.h"
 #include "base/observer_list.h"
+#include "base/time/time.h"
+#include "base/timer/timer.h"
+#include "base/values.h"
 
 namespace meson {
 class NativeWindow;
@@ -17,6 +24,15 @@ class WindowList {
   typedef WindowVector::iterator iterator;
   typedef WindowVector::const_iterator const_iterator;
 
+  struct CloseOptions {
+    CloseOptions();
+    // for all the windows, zero waits as long as it takes.
+    base::TimeDelta timeout;
+    // destroys the windows which cancel the close or are still open at the
+    // timeout, instead of giving up.
+    bool force;
+  };
+
   const_iterator begin() const { return windows_.begin(); }
   const_iterator end() const { return windows_.end(); }
 
@@ -38,14 +54,41 @@ class WindowList {
   static void AddObserver(WindowListObserver* observer);
   static void RemoveObserver(WindowListObserver* observer);
 
-  static void CloseAllWindows();
+  // Asks all the windows to close at once, their beforeunload handlers run
+  // concurrently. The close is given up when a window cancels it (unless
+  // forced) and is over when the last one is removed or at the timeout.
+  // A timeout without force is reported as a cancel of the open windows.
+  static void CloseAllWindows(const CloseOptions& options = CloseOptions());
+
+  // of the last CloseAllWindows():
+  // {inProgress, result, windows, closed, cancelled, forced, timeout, force,
+  //  dispatchTime, closeTime}
+  static std::unique_ptr<base::DictionaryValue> GetCloseStatistics();
 
  private:
   WindowList();
   ~WindowList();
 
+  void FinishClosing(const std::string& result);
+  void OnCloseTimeout();
+  static void ForceClose(base::WeakPtr<NativeWindow> window);
+
   WindowVector windows_;
 
+  // the windows CloseAllWindows() waits for.
+  std::unordered_set<NativeWindow*> closing_;
+  bool closing_all_;
+  CloseOptions close_options_;
+  base::OneShotTimer close_timer_;
+  base::TimeTicks close_start_;
+  std::string close_result_;
+  int close_windows_;
+  int close_closed_;
+  int close_cancelled_;
+  int close_forced_;
+  base::TimeDelta close_dispatch_time_;
+  base::TimeDelta close_time_;
+
   static base::LazyInstance<base::ObserverList<WindowListObserver>>::Leaky observers_;
 
   static WindowList* instance_;
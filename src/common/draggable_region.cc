@@ -3,4 +3,11 @@
 namespace meson {
 DraggableRegion::DraggableRegion()
     : draggable(false) {}
+
+bool DraggableRegion::operator==(const DraggableRegion& other) const {
+  return draggable == other.draggable && bounds == other.bounds;
+}
+
+DraggableRegionChange::DraggableRegionChange()
+    : index(0) {}
 }
@@ -1,6 +1,7 @@
 //-*-c++-*-
 #pragma once
 
+#include <stdint.h>
 #include "ui/gfx/geometry/rect.h"
 
 namespace meson {
@@ -9,5 +10,15 @@ struct DraggableRegion {
   gfx::Rect bounds;
 
   DraggableRegion();
+  bool operator==(const DraggableRegion& other) const;
+  bool operator!=(const DraggableRegion& other) const { return !(*this == other); }
+};
+
+// the region at |index| of the list the renderer sent last time is replaced.
+struct DraggableRegionChange {
+  uint32_t index;
+  DraggableRegion region;
+
+  DraggableRegionChange();
 };
 }
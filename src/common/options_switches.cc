@@ -141,6 +141,9 @@ const char kRegisterServiceWorkerSchemes[] = "register-service-worker-schemes";
 // The browser process app model ID
 const char kAppUserModelId[] = "app-user-model-id";
 
+// Enables the API methods only meant for tests (e.g. simulateMemoryPressure).
+const char kEnableTestHooks[] = "enable-test-hooks";
+
 // The command line switch versions of the options.
 const char kBackgroundColor[] = "background-color";
 const char kZoomFactor[] = "zoom-factor";
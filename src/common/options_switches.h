@@ -70,6 +70,7 @@ extern const char kDisableHttpCache[];
 extern const char kStandardSchemes[];
 extern const char kRegisterServiceWorkerSchemes[];
 extern const char kAppUserModelId[];
+extern const char kEnableTestHooks[];
 
 extern const char kBackgroundColor[];
 extern const char kZoomFactor[];
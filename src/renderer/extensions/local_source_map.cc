@@ -4,24 +4,75 @@
 
 #include "renderer/extensions/local_source_map.h"
 
+#include <string.h>
+
+#include "base/logging.h"
+#include "third_party/zlib/zlib.h"
+
 #include "renderer/extensions/static_v8_external_string_resource.h"
 
 namespace extensions {
 
+namespace {
+
+// Inflates the gzip |input| in place of the embedded array, without a copy.
+// The size of the output is read from the gzip trailer.
+bool GzipUncompress(const base::StringPiece& input, std::string* output) {
+  // header (10) + trailer (8)
+  if (input.size() < 18)
+    return false;
+  const uint8_t* trailer = reinterpret_cast<const uint8_t*>(input.data() + input.size() - 4);
+  uint32_t size = trailer[0] | (trailer[1] << 8) | (trailer[2] << 16) | (static_cast<uint32_t>(trailer[3]) << 24);
+  output->resize(size);
+
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+  stream.avail_in = static_cast<uInt>(input.size());
+  stream.next_out = size ? reinterpret_cast<Bytef*>(&(*output)[0]) : nullptr;
+  stream.avail_out = size;
+  // 16: gzip header.
+  if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK)
+    return false;
+  int result = inflate(&stream, Z_FINISH);
+  inflateEnd(&stream);
+  return result == Z_STREAM_END && stream.total_out == size;
+}
+
+}  // namespace
+
 LocalSourceMap::LocalSourceMap() {
 }
 
 LocalSourceMap::~LocalSourceMap() {
 }
 
-void LocalSourceMap::RegisterSource(const std::string& name, const std::string& source) {
-  source_map_[name] = source;
+void LocalSourceMap::RegisterSource(const std::string& name, const base::StringPiece& source) {
+  Source& entry = source_map_[name];
+  entry.data = source;
+  entry.compressed = false;
+  entry.uncompressed.clear();
+}
+
+void LocalSourceMap::RegisterCompressedSource(const std::string& name, const base::StringPiece& source) {
+  Source& entry = source_map_[name];
+  entry.data = source;
+  entry.compressed = true;
+  entry.uncompressed.clear();
 }
 
 v8::Handle<v8::Value> LocalSourceMap::GetSource(v8::Isolate* isolate, const std::string& name) {
   if (!Contains(name))
     return v8::Undefined(isolate);
-  return ConvertString(isolate, source_map_[name]);
+
+  auto& strings = strings_[isolate];
+  auto fiter = strings.find(name);
+  if (fiter != strings.end())
+    return v8::Local<v8::String>::New(isolate, (*fiter).second);
+
+  v8::Local<v8::String> string = ConvertString(isolate, GetSourceData(name));
+  strings[name].Reset(isolate, string);
+  return string;
 }
 
 bool LocalSourceMap::Contains(
@@ -29,6 +80,17 @@ bool LocalSourceMap::Contains(
   return !!source_map_.count(name);
 }
 
+const base::StringPiece& LocalSourceMap::GetSourceData(const std::string& name) {
+  Source& entry = source_map_[name];
+  if (entry.compressed) {
+    bool success = GzipUncompress(entry.data, &entry.uncompressed);
+    CHECK(success) << "failed to decompress module " << name;
+    entry.data = entry.uncompressed;
+    entry.compressed = false;
+  }
+  return entry.data;
+}
+
 v8::Handle<v8::String> LocalSourceMap::ConvertString(v8::Isolate* isolate, const base::StringPiece& string) {
   // v8 takes ownership of the StaticV8ExternalAsciiStringResource (see
   // v8::String::NewExternal()).
@@ -20,7 +20,16 @@ class LocalSourceMap : public ModuleSystem::SourceMap {
   LocalSourceMap();
   ~LocalSourceMap();
 
-  void RegisterSource(const std::string& name, const std::string& source);
+  // ### RegisterSource
+  //
+  // Registers |source| without copying it. The buffer must outlive the
+  // source map (the embedded .bin arrays are static)
+  void RegisterSource(const std::string& name, const base::StringPiece& source);
+
+  // ### RegisterCompressedSource
+  //
+  // Registers a gzip compressed |source|. It is decompressed on first use
+  void RegisterCompressedSource(const std::string& name, const base::StringPiece& source);
 
   /****************************************************************************/
   /* SOURCEMAP IMPLEMENTATION */
@@ -31,8 +40,20 @@ class LocalSourceMap : public ModuleSystem::SourceMap {
  private:
   v8::Handle<v8::String> ConvertString(v8::Isolate* isolate,
                                        const base::StringPiece& string);
-
-  std::map<std::string, std::string> source_map_;
+  const base::StringPiece& GetSourceData(const std::string& name);
+
+  struct Source {
+    base::StringPiece data;
+    bool compressed;
+    // owns |data| once decompressed.
+    std::string uncompressed;
+  };
+  std::map<std::string, Source> source_map_;
+
+  // The external strings are created once per isolate and shared by all the
+  // contexts of that isolate, across navigations. They live as long as the
+  // isolate (the main thread one lives as long as the renderer).
+  std::map<v8::Isolate*, std::map<std::string, v8::Global<v8::String>>> strings_;
 };
 
 }  // namespace extensions
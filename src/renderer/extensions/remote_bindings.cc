@@ -12,6 +12,7 @@
 #include "content/public/child/v8_value_converter.h"
 #include "content/public/renderer/render_frame.h"
 #include "content/public/renderer/render_frame_observer.h"
+#include "content/public/renderer/render_thread.h"
 
 #include "renderer/extensions/script_context.h"
 #include "api/api_messages.h"
@@ -26,6 +27,9 @@ RemoteBindings::RemoteBindings(ScriptContext* context)
   RouteFunction("SendMessage",
                 base::Bind(&RemoteBindings::SendMessage,
                            base::Unretained(this)));
+  RouteFunction("SendBuffer",
+                base::Bind(&RemoteBindings::SendBuffer,
+                           base::Unretained(this)));
   RouteFunction("SetHandler",
                 base::Bind(&RemoteBindings::SetHandler,
                            base::Unretained(this)));
@@ -81,6 +85,55 @@ void RemoteBindings::SendMessage(const v8::FunctionCallbackInfo<v8::Value>& args
       *message.get()));
 }
 
+void RemoteBindings::SendBuffer(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  if (args.Length() != 2 || !args[0]->IsObject() ||
+      !(args[1]->IsArrayBuffer() || args[1]->IsArrayBufferView())) {
+    NOTREACHED();
+    return;
+  }
+
+  std::unique_ptr<V8ValueConverter> converter(V8ValueConverter::create());
+  std::unique_ptr<base::Value> value(converter->FromV8Value(args[0], context()->v8_context()));
+  base::DictionaryValue* message = nullptr;
+  if (!value || !value->GetAsDictionary(&message)) {
+    return;
+  }
+
+  v8::Local<v8::ArrayBuffer> buffer;
+  size_t offset = 0;
+  size_t length = 0;
+  if (args[1]->IsArrayBufferView()) {
+    v8::Local<v8::ArrayBufferView> view = v8::Local<v8::ArrayBufferView>::Cast(args[1]);
+    buffer = view->Buffer();
+    offset = view->ByteOffset();
+    length = view->ByteLength();
+  } else {
+    buffer = v8::Local<v8::ArrayBuffer>::Cast(args[1]);
+    length = buffer->ByteLength();
+  }
+  if (length == 0) {
+    return;
+  }
+
+  // The sandboxed renderer can not create shared memory by itself, so ask
+  // the browser for the region. This is the only copy of the payload.
+  std::unique_ptr<base::SharedMemory> memory = RenderThread::Get()->HostAllocateSharedMemoryBuffer(length);
+  if (!memory || !memory->Map(length)) {
+    LOG(ERROR) << "REMOTE_BINDINGS: SendBuffer : failed to allocate " << length << " bytes";
+    return;
+  }
+  v8::ArrayBuffer::Contents contents = buffer->GetContents();
+  memcpy(memory->memory(), static_cast<const char*>(contents.Data()) + offset, length);
+
+  LOG(INFO) << "REMOTE_BINDINGS: SendBuffer : " << length;
+
+  render_frame_observer_->Send(new MesonFrameHostMsg_RemoteSendBuffer(
+      render_frame_observer_->routing_id(),
+      base::SharedMemory::DuplicateHandle(memory->handle()),
+      static_cast<uint32_t>(length),
+      *message));
+}
+
 void RemoteBindings::SetHandler(const v8::FunctionCallbackInfo<v8::Value>& args) {
   if (args.Length() != 1 || !args[0]->IsFunction()) {
     NOTREACHED();
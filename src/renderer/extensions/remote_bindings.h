@@ -34,6 +34,7 @@ class RemoteBindings : public ObjectBackedNativeHandler {
   // @args {FunctionCallbackInfo} v8 args and return
   // ```
   void SendMessage(const v8::FunctionCallbackInfo<v8::Value>& args);
+  void SendBuffer(const v8::FunctionCallbackInfo<v8::Value>& args);
   void SetHandler(const v8::FunctionCallbackInfo<v8::Value>& args);
 
   v8::Persistent<v8::Function> message_handler_;
@@ -21,9 +21,19 @@
 using namespace content;
 
 namespace extensions {
+namespace {
+int g_next_create_request_id = 0;
+
+// Commands which only keep their last value.
+bool IsCoalescableCommand(const std::string& command) {
+  return command == "SetAutoSize" || command == "SetZoom" || command == "SetEventSubscriptions";
+}
+}
 
 WebViewBindings::WebViewBindings(ScriptContext* context)
-    : ObjectBackedNativeHandler(context) {
+    : ObjectBackedNativeHandler(context),
+      flush_scheduled_(false),
+      isolate_(context->isolate()) {
   LOG(INFO) << __PRETTY_FUNCTION__;
   RouteFunction("CreateGuest",
                 base::Bind(&WebViewBindings::CreateGuest,
@@ -79,8 +89,12 @@ WebViewBindings::WebViewBindings(ScriptContext* context)
   RouteFunction("JavaScriptDialogClosed",
                 base::Bind(&WebViewBindings::JavaScriptDialogClosed,
                            base::Unretained(this)));
+  RouteFunction("SetEventSubscriptions",
+                base::Bind(&WebViewBindings::SetEventSubscriptions,
+                           base::Unretained(this)));
 
   RouteFunction("RegisterElementResizeCallback", base::Bind(&WebViewBindings::RegisterElementReiszeCallback, base::Unretained(this)));
+  RouteFunction("GetResizeStatistics", base::Bind(&WebViewBindings::GetResizeStatistics, base::Unretained(this)));
 
   render_frame_observer_ = meson::MesonRenderFrameObserver::FromRenderFrame(
       RenderFrame::FromWebFrame(this->context()->web_frame()));
@@ -90,6 +104,19 @@ WebViewBindings::WebViewBindings(ScriptContext* context)
 }
 
 WebViewBindings::~WebViewBindings() {
+  // the frame is going away, no IPC is sent from here.
+  if (!pending_commands_.empty()) {
+    LOG(INFO) << "WEB_VIEW_BINDINGS: dropped " << pending_commands_.GetSize() << " commands";
+  }
+  if (!flush_holder_.IsEmpty()) {
+    // a microtask still queued does nothing.
+    v8::HandleScope handle_scope(isolate_);
+    v8::Local<v8::Object>::New(isolate_, flush_holder_)->SetAlignedPointerInInternalField(0, nullptr);
+  }
+  for (auto& kv : create_callbacks_) {
+    kv.second.Reset();
+  }
+  create_callbacks_.clear();
   render_frame_observer_->RemoveWebViewBindings(this);
 
   LOG(INFO) << "WebViewBindings Destructor " << this;
@@ -110,13 +137,31 @@ bool WebViewBindings::AttemptEmitEvent(int guest_instance_id,
 
     v8::Local<v8::Value> argv[2] = {type_arg, event_arg};
     context()->CallFunction(handler, 2, argv);
+    return true;
   }
   return false;
 }
 
+bool WebViewBindings::AttemptGuestCreated(int request_id, int guest_instance_id) {
+  LOG(INFO) << __PRETTY_FUNCTION__ << "(" << request_id << ", " << guest_instance_id << ")";
+  auto fiter = create_callbacks_.find(request_id);
+  if (fiter == create_callbacks_.end()) {
+    return false;
+  }
+  v8::HandleScope handle_scope(context()->isolate());
+  v8::Local<v8::Function> callback = v8::Local<v8::Function>::New(context()->isolate(), (*fiter).second);
+  (*fiter).second.Reset();
+  create_callbacks_.erase(fiter);
+
+  v8::Local<v8::Value> argv[1] = {v8::Integer::New(context()->isolate(), guest_instance_id)};
+  context()->CallFunction(callback, 1, argv);
+  return true;
+}
+
 void WebViewBindings::CreateGuest(const v8::FunctionCallbackInfo<v8::Value>& args) {
   DLOG(INFO) << __PRETTY_FUNCTION__ << "(" << args.Length() << ")";
-  if (args.Length() != 1 || !args[0]->IsObject()) {
+  if (args.Length() < 1 || args.Length() > 2 || !args[0]->IsObject() ||
+      (args.Length() == 2 && !args[1]->IsFunction())) {
     NOTREACHED();
     return;
   }
@@ -137,6 +182,18 @@ void WebViewBindings::CreateGuest(const v8::FunctionCallbackInfo<v8::Value>& arg
 
   LOG(INFO) << "WEB_VIEW_BINDINGS: CreateGuest";
 
+  FlushCommands();
+
+  if (args.Length() == 2) {
+    // Asynchronous creation, the guest id is passed to the callback.
+    int request_id = ++g_next_create_request_id;
+    create_callbacks_[request_id].Reset(context()->isolate(), v8::Local<v8::Function>::Cast(args[1]));
+    render_frame_observer_->Send(new MesonFrameHostMsg_CreateWebViewGuestAsync(
+        render_frame_observer_->routing_id(),
+        request_id, *params.get()));
+    return;
+  }
+
   int id = 0;
   render_frame_observer_->Send(new MesonFrameHostMsg_CreateWebViewGuest(
       render_frame_observer_->routing_id(),
@@ -168,6 +225,8 @@ void WebViewBindings::AttachWindowGuest(const v8::FunctionCallbackInfo<v8::Value
 
   LOG(INFO) << "WEB_VIEW_BINDINGS: AttachWindowGuest " << guest_instance_id;
 
+  FlushCommands();
+
   render_frame_observer_->Send(new MesonFrameHostMsg_AttachWindowGuest(
       render_frame_observer_->routing_id(),
       internal_instance_id,
@@ -187,6 +246,8 @@ void WebViewBindings::DestroyGuest(const v8::FunctionCallbackInfo<v8::Value>& ar
   int guest_instance_id = args[0]->NumberValue();
   LOG(INFO) << "WEB_VIEW_BINDINGS: DestroyGuest " << guest_instance_id;
 
+  FlushCommands();
+
   render_frame_observer_->Send(new MesonFrameHostMsg_DestroyWebViewGuest(
       render_frame_observer_->routing_id(),
       guest_instance_id));
@@ -231,9 +292,7 @@ void WebViewBindings::SetAutoSize(const v8::FunctionCallbackInfo<v8::Value>& arg
 
   LOG(INFO) << "WEB_VIEW_BINDINGS: SetAutoSize " << guest_instance_id;
 
-  render_frame_observer_->Send(new MesonFrameHostMsg_WebViewGuestSetAutoSize(render_frame_observer_->routing_id(),
-                                                                             guest_instance_id,
-                                                                             *params.get()));
+  QueueCommand(guest_instance_id, "SetAutoSize", std::move(params));
 }
 
 void WebViewBindings::Go(const v8::FunctionCallbackInfo<v8::Value>& args) {
@@ -248,9 +307,9 @@ void WebViewBindings::Go(const v8::FunctionCallbackInfo<v8::Value>& args) {
 
   LOG(INFO) << "WEB_VIEW_BINDINGS: Go " << guest_instance_id << " " << index;
 
-  render_frame_observer_->Send(new MesonFrameHostMsg_WebViewGuestGo(
-      render_frame_observer_->routing_id(),
-      guest_instance_id, index));
+  std::unique_ptr<base::DictionaryValue> command(new base::DictionaryValue);
+  command->SetInteger("index", index);
+  QueueCommand(guest_instance_id, "Go", std::move(command));
 }
 
 void WebViewBindings::LoadUrl(const v8::FunctionCallbackInfo<v8::Value>& args) {
@@ -265,9 +324,9 @@ void WebViewBindings::LoadUrl(const v8::FunctionCallbackInfo<v8::Value>& args) {
 
   LOG(INFO) << "WEB_VIEW_BINDINGS: LoadUrl " << guest_instance_id << " " << url;
 
-  render_frame_observer_->Send(new MesonFrameHostMsg_WebViewGuestLoadUrl(
-      render_frame_observer_->routing_id(),
-      guest_instance_id, url));
+  std::unique_ptr<base::DictionaryValue> command(new base::DictionaryValue);
+  command->SetString("url", url);
+  QueueCommand(guest_instance_id, "LoadUrl", std::move(command));
 }
 
 void WebViewBindings::Reload(const v8::FunctionCallbackInfo<v8::Value>& args) {
@@ -282,9 +341,9 @@ void WebViewBindings::Reload(const v8::FunctionCallbackInfo<v8::Value>& args) {
 
   LOG(INFO) << "WEB_VIEW_BINDINGS: Reload " << guest_instance_id << " " << ignore_cache;
 
-  render_frame_observer_->Send(new MesonFrameHostMsg_WebViewGuestReload(
-      render_frame_observer_->routing_id(),
-      guest_instance_id, ignore_cache));
+  std::unique_ptr<base::DictionaryValue> command(new base::DictionaryValue);
+  command->SetBoolean("ignoreCache", ignore_cache);
+  QueueCommand(guest_instance_id, "Reload", std::move(command));
 }
 
 void WebViewBindings::Stop(const v8::FunctionCallbackInfo<v8::Value>& args) {
@@ -298,9 +357,7 @@ void WebViewBindings::Stop(const v8::FunctionCallbackInfo<v8::Value>& args) {
 
   LOG(INFO) << "WEB_VIEW_BINDINGS: Stop " << guest_instance_id;
 
-  render_frame_observer_->Send(new MesonFrameHostMsg_WebViewGuestStop(
-      render_frame_observer_->routing_id(),
-      guest_instance_id));
+  QueueCommand(guest_instance_id, "Stop", std::unique_ptr<base::DictionaryValue>(new base::DictionaryValue));
 }
 
 void WebViewBindings::SetZoom(const v8::FunctionCallbackInfo<v8::Value>& args) {
@@ -315,9 +372,9 @@ void WebViewBindings::SetZoom(const v8::FunctionCallbackInfo<v8::Value>& args) {
 
   LOG(INFO) << "WEB_VIEW_BINDINGS: SetZoom " << guest_instance_id << " " << zoom_factor;
 
-  render_frame_observer_->Send(new MesonFrameHostMsg_WebViewGuestSetZoom(
-      render_frame_observer_->routing_id(),
-      guest_instance_id, zoom_factor));
+  std::unique_ptr<base::DictionaryValue> command(new base::DictionaryValue);
+  command->SetDouble("zoomFactor", zoom_factor);
+  QueueCommand(guest_instance_id, "SetZoom", std::move(command));
 }
 
 void WebViewBindings::Find(const v8::FunctionCallbackInfo<v8::Value>& args) {
@@ -348,9 +405,11 @@ void WebViewBindings::Find(const v8::FunctionCallbackInfo<v8::Value>& args) {
   LOG(INFO) << "WEB_VIEW_BINDINGS: Find " << guest_instance_id << " "
             << request_id << " " << search_text;
 
-  render_frame_observer_->Send(new MesonFrameHostMsg_WebViewGuestFind(
-      render_frame_observer_->routing_id(),
-      guest_instance_id, request_id, search_text, *options.get()));
+  std::unique_ptr<base::DictionaryValue> command(new base::DictionaryValue);
+  command->SetInteger("requestId", request_id);
+  command->SetString("searchText", search_text);
+  command->Set("options", std::move(options));
+  QueueCommand(guest_instance_id, "Find", std::move(command));
 }
 
 void WebViewBindings::StopFinding(const v8::FunctionCallbackInfo<v8::Value>& args) {
@@ -365,9 +424,9 @@ void WebViewBindings::StopFinding(const v8::FunctionCallbackInfo<v8::Value>& arg
 
   LOG(INFO) << "WEB_VIEW_BINDINGS: StopFinding " << guest_instance_id << " " << action;
 
-  render_frame_observer_->Send(new MesonFrameHostMsg_WebViewGuestStopFinding(
-      render_frame_observer_->routing_id(),
-      guest_instance_id, action));
+  std::unique_ptr<base::DictionaryValue> command(new base::DictionaryValue);
+  command->SetString("action", action);
+  QueueCommand(guest_instance_id, "StopFinding", std::move(command));
 }
 
 void WebViewBindings::InsertCSS(const v8::FunctionCallbackInfo<v8::Value>& args) {
@@ -396,9 +455,9 @@ void WebViewBindings::ExecuteScript(const v8::FunctionCallbackInfo<v8::Value>& a
 
   LOG(INFO) << "WEB_VIEW_BINDINGS: ExecuteScript " << guest_instance_id;
 
-  render_frame_observer_->Send(new MesonFrameHostMsg_WebViewGuestExecuteScript(
-      render_frame_observer_->routing_id(),
-      guest_instance_id, script));
+  std::unique_ptr<base::DictionaryValue> command(new base::DictionaryValue);
+  command->SetString("script", script);
+  QueueCommand(guest_instance_id, "ExecuteScript", std::move(command));
 }
 
 void WebViewBindings::OpenDevTools(const v8::FunctionCallbackInfo<v8::Value>& args) {
@@ -412,9 +471,7 @@ void WebViewBindings::OpenDevTools(const v8::FunctionCallbackInfo<v8::Value>& ar
 
   LOG(INFO) << "WEB_VIEW_BINDINGS: OpenDevTools " << guest_instance_id;
 
-  render_frame_observer_->Send(new MesonFrameHostMsg_WebViewGuestOpenDevTools(
-      render_frame_observer_->routing_id(),
-      guest_instance_id));
+  QueueCommand(guest_instance_id, "OpenDevTools", std::unique_ptr<base::DictionaryValue>(new base::DictionaryValue));
 }
 
 void WebViewBindings::CloseDevTools(const v8::FunctionCallbackInfo<v8::Value>& args) {
@@ -428,9 +485,7 @@ void WebViewBindings::CloseDevTools(const v8::FunctionCallbackInfo<v8::Value>& a
 
   LOG(INFO) << "WEB_VIEW_BINDINGS: CloseDevTools " << guest_instance_id;
 
-  render_frame_observer_->Send(new MesonFrameHostMsg_WebViewGuestCloseDevTools(
-      render_frame_observer_->routing_id(),
-      guest_instance_id));
+  QueueCommand(guest_instance_id, "CloseDevTools", std::unique_ptr<base::DictionaryValue>(new base::DictionaryValue));
 }
 
 void WebViewBindings::IsDevToolsOpened(const v8::FunctionCallbackInfo<v8::Value>& args) {
@@ -444,6 +499,8 @@ void WebViewBindings::IsDevToolsOpened(const v8::FunctionCallbackInfo<v8::Value>
 
   LOG(INFO) << "WEB_VIEW_BINDINGS: IsDevToolsOpened " << guest_instance_id;
 
+  FlushCommands();
+
   bool open = false;
   render_frame_observer_->Send(new MesonFrameHostMsg_WebViewGuestIsDevToolsOpened(
       render_frame_observer_->routing_id(),
@@ -467,9 +524,36 @@ void WebViewBindings::JavaScriptDialogClosed(const v8::FunctionCallbackInfo<v8::
   LOG(INFO) << "WEB_VIEW_BINDINGS: JavaScriptDialogClosed " << guest_instance_id << " "
             << success << " " << response;
 
-  render_frame_observer_->Send(new MesonFrameHostMsg_WebViewGuestJavaScriptDialogClosed(
-      render_frame_observer_->routing_id(),
-      guest_instance_id, success, response));
+  std::unique_ptr<base::DictionaryValue> command(new base::DictionaryValue);
+  command->SetBoolean("success", success);
+  command->SetString("response", response);
+  QueueCommand(guest_instance_id, "JavaScriptDialogClosed", std::move(command));
+}
+
+void WebViewBindings::SetEventSubscriptions(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  LOG(INFO) << __PRETTY_FUNCTION__ << " : " << args.Length();
+  if (args.Length() != 2 || !args[0]->IsNumber() || !args[1]->IsArray()) {
+    NOTREACHED();
+    return;
+  }
+
+  int guest_instance_id = args[0]->NumberValue();
+
+  std::unique_ptr<V8ValueConverter> converter(V8ValueConverter::create());
+  std::unique_ptr<base::Value> value(converter->FromV8Value(args[1], context()->v8_context()));
+
+  if (!value) {
+    return;
+  }
+  if (!value->IsType(base::Value::TYPE_LIST)) {
+    return;
+  }
+
+  LOG(INFO) << "WEB_VIEW_BINDINGS: SetEventSubscriptions " << guest_instance_id;
+
+  std::unique_ptr<base::DictionaryValue> command(new base::DictionaryValue);
+  command->Set("events", std::move(value));
+  QueueCommand(guest_instance_id, "SetEventSubscriptions", std::move(command));
 }
 
 void WebViewBindings::RegisterElementReiszeCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
@@ -489,6 +573,17 @@ void WebViewBindings::RegisterElementReiszeCallback(const v8::FunctionCallbackIn
   }
 }
 
+void WebViewBindings::GetResizeStatistics(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  std::unique_ptr<base::DictionaryValue> stats = meson::GuestViewContainer::GetResizeStatistics();
+  int observed = 0;
+  int dispatched = 0;
+  stats->GetInteger("observed", &observed);
+  stats->GetInteger("dispatched", &dispatched);
+  stats->SetInteger("saved", observed - dispatched);
+  std::unique_ptr<content::V8ValueConverter> converter(content::V8ValueConverter::create());
+  args.GetReturnValue().Set(converter->ToV8Value(stats.get(), context()->v8_context()));
+}
+
 void WebViewBindings::OnResizeCallback(const gfx::Size& size) {
   LOG(INFO) << __PRETTY_FUNCTION__ << "(" << size.width() << ", " << size.height() << ")";
   if (!resize_callback_.IsEmpty()) {
@@ -504,4 +599,74 @@ void WebViewBindings::OnResizeCallback(const gfx::Size& size) {
   }
 }
 
+void WebViewBindings::QueueCommand(int guest_instance_id,
+                                   const std::string& command,
+                                   std::unique_ptr<base::DictionaryValue> args) {
+  if (IsCoalescableCommand(command)) {
+    // Look for the latest pending command of this guest.
+    for (size_t i = pending_commands_.GetSize(); i > 0; --i) {
+      base::DictionaryValue* pending = nullptr;
+      int id = 0;
+      std::string type;
+      pending_commands_.GetDictionary(i - 1, &pending);
+      pending->GetInteger("guestInstanceId", &id);
+      if (id != guest_instance_id) {
+        continue;
+      }
+      pending->GetString("command", &type);
+      if (type == command) {
+        // the command is replaced as a whole, keys of the old one would
+        // otherwise survive (e.g. SetAutoSize turned off).
+        args->SetInteger("guestInstanceId", guest_instance_id);
+        args->SetString("command", command);
+        pending_commands_.Set(i - 1, std::move(args));
+        return;
+      }
+      break;
+    }
+  }
+
+  args->SetInteger("guestInstanceId", guest_instance_id);
+  args->SetString("command", command);
+  pending_commands_.Append(std::move(args));
+
+  if (!flush_scheduled_) {
+    flush_scheduled_ = true;
+    v8::HandleScope handle_scope(isolate_);
+    if (flush_function_.IsEmpty()) {
+      v8::Local<v8::ObjectTemplate> holder_template = v8::ObjectTemplate::New(isolate_);
+      holder_template->SetInternalFieldCount(1);
+      v8::Local<v8::Object> holder = holder_template->NewInstance(context()->v8_context()).ToLocalChecked();
+      holder->SetAlignedPointerInInternalField(0, this);
+      flush_holder_.Reset(isolate_, holder);
+      flush_function_.Reset(isolate_, v8::Function::New(context()->v8_context(), &WebViewBindings::FlushCommandsCallback, holder).ToLocalChecked());
+    }
+    // owned by the microtask queue (and the GC), nothing leaks if it never runs.
+    isolate_->EnqueueMicrotask(v8::Local<v8::Function>::New(isolate_, flush_function_));
+  }
+}
+
+void WebViewBindings::FlushCommands() {
+  flush_scheduled_ = false;
+  if (pending_commands_.empty()) {
+    return;
+  }
+  LOG(INFO) << "WEB_VIEW_BINDINGS: FlushCommands " << pending_commands_.GetSize();
+
+  base::ListValue commands;
+  commands.Swap(&pending_commands_);
+  render_frame_observer_->Send(new MesonFrameHostMsg_WebViewGuestBatch(
+      render_frame_observer_->routing_id(),
+      commands));
+}
+
+// static
+void WebViewBindings::FlushCommandsCallback(const v8::FunctionCallbackInfo<v8::Value>& info) {
+  v8::Local<v8::Object> holder = v8::Local<v8::Object>::Cast(info.Data());
+  auto* self = static_cast<WebViewBindings*>(holder->GetAlignedPointerFromInternalField(0));
+  if (self) {
+    self->FlushCommands();
+  }
+}
+
 }  // namespace extensions
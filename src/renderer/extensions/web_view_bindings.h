@@ -26,9 +26,16 @@ class WebViewBindings : public ObjectBackedNativeHandler {
   // ### AttemptEmitEvent
   //
   // Attempts to emit an event for the given guest_instance_id. The event gets
-  // emitted only if this WebViewBindings has an handler for it
+  // emitted only if this WebViewBindings has an handler for it, in which case
+  // true is returned
   bool AttemptEmitEvent(int guest_instance_id, const std::string type, const base::DictionaryValue& event);
 
+  // ### AttemptGuestCreated
+  //
+  // Runs the callback of an asynchronous CreateGuest if the request was
+  // issued by this WebViewBindings
+  bool AttemptGuestCreated(int request_id, int guest_instance_id);
+
  private:
   // ### [RouteFunction]
   //
@@ -53,12 +60,31 @@ class WebViewBindings : public ObjectBackedNativeHandler {
   void CloseDevTools(const v8::FunctionCallbackInfo<v8::Value>& args);
   void IsDevToolsOpened(const v8::FunctionCallbackInfo<v8::Value>& args);
   void JavaScriptDialogClosed(const v8::FunctionCallbackInfo<v8::Value>& args);
+  void SetEventSubscriptions(const v8::FunctionCallbackInfo<v8::Value>& args);
   void RegisterElementReiszeCallback(const v8::FunctionCallbackInfo<v8::Value>& args);
+  void GetResizeStatistics(const v8::FunctionCallbackInfo<v8::Value>& args);
   void OnResizeCallback(const gfx::Size& size);
 
+  // ### QueueCommand
+  //
+  // Queues a guest command. The queue is sent as one IPC at the next
+  // microtask checkpoint. SetAutoSize, SetZoom and SetEventSubscriptions are
+  // replace the pending command of the same guest when it has the same type.
+  void QueueCommand(int guest_instance_id, const std::string& command, std::unique_ptr<base::DictionaryValue> args);
+  void FlushCommands();
+  // the microtask, it holds |this| in an internal field of its data which
+  // the destructor clears.
+  static void FlushCommandsCallback(const v8::FunctionCallbackInfo<v8::Value>& info);
+
   std::map<int, v8::Persistent<v8::Function, v8::CopyablePersistentTraits<v8::Function>>> guest_handlers_;
   meson::MesonRenderFrameObserver* render_frame_observer_;
   v8::Persistent<v8::Function> resize_callback_;
+  std::map<int, v8::Persistent<v8::Function, v8::CopyablePersistentTraits<v8::Function>>> create_callbacks_;
+  base::ListValue pending_commands_;
+  bool flush_scheduled_;
+  v8::Isolate* isolate_;
+  v8::Global<v8::Object> flush_holder_;
+  v8::Global<v8::Function> flush_function_;
 };
 
 }  // namespace extensions
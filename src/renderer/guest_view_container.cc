@@ -1,11 +1,12 @@
 #include "renderer/guest_view_container.h"
 
+#include <algorithm>
+#include <cstdlib>
 #include <map>
 
 #include "base/bind.h"
 #include "base/lazy_instance.h"
-#include "base/threading/thread_task_runner_handle.h"
-#include "ui/gfx/geometry/size.h"
+#include "base/values.h"
 
 namespace meson {
 
@@ -15,10 +16,30 @@ using GuestViewContainerMap = std::map<int, GuestViewContainer*>;
 static base::LazyInstance<GuestViewContainerMap> g_guest_view_container_map =
     LAZY_INSTANCE_INITIALIZER;
 
+// One resize per frame (a 60Hz frame, the renderer has no vsync signal here).
+const int kResizeFrameIntervalMs = 16;
+// Size changes smaller than this (in px) are only sent once resizing settles,
+// i.e. no other change comes within the delay.
+const int kResizeThreshold = 2;
+const int kResizeSettleDelayMs = 100;
+
+int g_resize_observed = 0;
+int g_resize_dispatched = 0;
+// from the first change observed to its dispatch.
+base::TimeDelta g_resize_latency_total;
+base::TimeDelta g_resize_latency_max;
+
+bool IsSmallResize(const gfx::Size& a, const gfx::Size& b) {
+  return std::abs(a.width() - b.width()) < kResizeThreshold &&
+         std::abs(a.height() - b.height()) < kResizeThreshold;
+}
+
 }  // namespace
 
 GuestViewContainer::GuestViewContainer(content::RenderFrame* render_frame)
-    : weak_ptr_factory_(this) {
+    : element_instance_id_(-1),
+      settling_(false),
+      weak_ptr_factory_(this) {
 }
 
 GuestViewContainer::~GuestViewContainer() {
@@ -34,6 +55,20 @@ GuestViewContainer* GuestViewContainer::FromID(int element_instance_id) {
   return it == guest_view_containers->end() ? nullptr : it->second;
 }
 
+// static
+std::unique_ptr<base::DictionaryValue> GuestViewContainer::GetResizeStatistics(void) {
+  std::unique_ptr<base::DictionaryValue> stats(new base::DictionaryValue());
+  stats->SetInteger("observed", g_resize_observed);
+  stats->SetInteger("dispatched", g_resize_dispatched);
+  // milliseconds.
+  double average = 0.0;
+  if (g_resize_dispatched > 0)
+    average = g_resize_latency_total.InMillisecondsF() / g_resize_dispatched;
+  stats->SetDouble("averageLatency", average);
+  stats->SetDouble("maxLatency", g_resize_latency_max.InMillisecondsF());
+  return stats;
+}
+
 void GuestViewContainer::RegisterElementResizeCallback(const ResizeCallback& callback) {
   LOG(INFO) << __PRETTY_FUNCTION__;
   element_resize_callback_ = callback;
@@ -45,11 +80,52 @@ void GuestViewContainer::SetElementInstanceID(int element_instance_id) {
 }
 
 void GuestViewContainer::DidResizeElement(const gfx::Size& new_size) {
-  LOG(INFO) << __PRETTY_FUNCTION__ << "(" << new_size.width() << "," << new_size.height() << ") : " << element_resize_callback_.is_null();
+  DLOG(INFO) << __PRETTY_FUNCTION__ << "(" << new_size.width() << "," << new_size.height() << ") : " << element_resize_callback_.is_null();
+  ++g_resize_observed;
   if (element_resize_callback_.is_null())
     return;
 
-  base::ThreadTaskRunnerHandle::Get()->PostTask(FROM_HERE, base::Bind(element_resize_callback_, new_size));
+  pending_size_ = new_size;
+  if (pending_since_.is_null())
+    pending_since_ = base::TimeTicks::Now();
+  if (resize_timer_.IsRunning()) {
+    if (!settling_)
+      return;
+    if (IsSmallResize(pending_size_, last_dispatched_size_)) {
+      // still changing, the settle delay starts over.
+      resize_timer_.Start(FROM_HERE, base::TimeDelta::FromMilliseconds(kResizeSettleDelayMs), base::Bind(&GuestViewContainer::DispatchResize, base::Unretained(this)));
+      return;
+    }
+    // a real resize arrived while waiting for a small one to settle.
+    settling_ = false;
+  }
+
+  base::TimeDelta delay = base::TimeDelta::FromMilliseconds(kResizeFrameIntervalMs) - (base::TimeTicks::Now() - last_dispatch_time_);
+  if (delay < base::TimeDelta())
+    delay = base::TimeDelta();
+  resize_timer_.Start(FROM_HERE, delay, base::Bind(&GuestViewContainer::DispatchResize, base::Unretained(this)));
+}
+
+void GuestViewContainer::DispatchResize() {
+  if (element_resize_callback_.is_null() || pending_size_ == last_dispatched_size_) {
+    settling_ = false;
+    pending_since_ = base::TimeTicks();
+    return;
+  }
+  if (!settling_ && IsSmallResize(pending_size_, last_dispatched_size_)) {
+    settling_ = true;
+    resize_timer_.Start(FROM_HERE, base::TimeDelta::FromMilliseconds(kResizeSettleDelayMs), base::Bind(&GuestViewContainer::DispatchResize, base::Unretained(this)));
+    return;
+  }
+  settling_ = false;
+  last_dispatched_size_ = pending_size_;
+  last_dispatch_time_ = base::TimeTicks::Now();
+  ++g_resize_dispatched;
+  base::TimeDelta latency = last_dispatch_time_ - pending_since_;
+  g_resize_latency_total += latency;
+  g_resize_latency_max = std::max(g_resize_latency_max, latency);
+  pending_since_ = base::TimeTicks();
+  element_resize_callback_.Run(pending_size_);
 }
 
 base::WeakPtr<content::BrowserPluginDelegate> GuestViewContainer::GetWeakPtr() {
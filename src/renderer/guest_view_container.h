@@ -1,10 +1,14 @@
 #pragma once
+#include <memory>
 #include "base/callback.h"
+#include "base/time/time.h"
+#include "base/timer/timer.h"
+#include "ui/gfx/geometry/size.h"
 #include "content/public/renderer/browser_plugin_delegate.h"
 #include "content/public/renderer/render_frame.h"
 
-namespace gfx {
-class Size;
+namespace base {
+class DictionaryValue;
 }
 
 namespace meson {
@@ -18,6 +22,11 @@ class GuestViewContainer : public content::BrowserPluginDelegate {
 
   static GuestViewContainer* FromID(int element_instance_id);
 
+  // Resize notifications observed from blink and actually dispatched to the
+  // resize callbacks, for all the containers of this process.
+  // {observed, dispatched, averageLatency, maxLatency}
+  static std::unique_ptr<base::DictionaryValue> GetResizeStatistics(void);
+
   void RegisterElementResizeCallback(const ResizeCallback& callback);
 
   // content::BrowserPluginDelegate:
@@ -25,11 +34,23 @@ class GuestViewContainer : public content::BrowserPluginDelegate {
   void DidResizeElement(const gfx::Size& new_size) final;
   base::WeakPtr<BrowserPluginDelegate> GetWeakPtr() final;
 
+ private:
+  void DispatchResize();
+
  private:
   int element_instance_id_;
 
   ResizeCallback element_resize_callback_;
 
+  // Resizes are coalesced to one dispatch per frame.
+  gfx::Size pending_size_;
+  gfx::Size last_dispatched_size_;
+  base::TimeTicks last_dispatch_time_;
+  // the first change not dispatched yet.
+  base::TimeTicks pending_since_;
+  bool settling_;
+  base::OneShotTimer resize_timer_;
+
   base::WeakPtrFactory<GuestViewContainer> weak_ptr_factory_;
 
   DISALLOW_COPY_AND_ASSIGN(GuestViewContainer);
@@ -0,0 +1,102 @@
+#include "renderer/hang_monitor_filter.h"
+
+#include <tuple>
+#include "api/api_messages.h"
+#include "base/strings/stringprintf.h"
+#include "content/public/renderer/render_thread.h"
+#include "v8/include/v8.h"
+
+namespace meson {
+namespace {
+const int kMaxStackFrames = 32;
+
+std::string ToString(v8::Local<v8::String> value) {
+  v8::String::Utf8Value utf8(value);
+  return (*utf8 && utf8.length()) ? std::string(*utf8, utf8.length()) : std::string();
+}
+}
+
+HangMonitorFilter::HangMonitorFilter()
+    : isolate_(nullptr),
+      interrupt_requested_(false) {
+}
+
+HangMonitorFilter::~HangMonitorFilter() {
+}
+
+void HangMonitorFilter::SetIsolate(v8::Isolate* isolate) {
+  base::AutoLock lock(lock_);
+  isolate_ = isolate;
+}
+
+bool HangMonitorFilter::OnMessageReceived(const IPC::Message& message) {
+  if (message.type() != MesonViewMsg_CaptureHangStack::ID) {
+    return false;
+  }
+  MesonViewMsg_CaptureHangStack::Param param;
+  if (!MesonViewMsg_CaptureHangStack::Read(&message, &param)) {
+    return true;
+  }
+  base::AutoLock lock(lock_);
+  if (!isolate_) {
+    return true;
+  }
+  StackRequest& request = requests_[message.routing_id()];
+  request.request_id = std::get<0>(param);
+  request.deadline = base::TimeTicks::Now() + base::TimeDelta::FromMilliseconds(std::get<1>(param));
+  if (!interrupt_requested_) {
+    interrupt_requested_ = true;
+    AddRef();
+    // the only V8 call which is safe off the main thread.
+    isolate_->RequestInterrupt(&HangMonitorFilter::OnInterrupt, this);
+  }
+  return true;
+}
+
+// static
+void HangMonitorFilter::OnInterrupt(v8::Isolate* isolate, void* data) {
+  HangMonitorFilter* filter = static_cast<HangMonitorFilter*>(data);
+  filter->SendStacks(isolate);
+  filter->Release();
+}
+
+void HangMonitorFilter::SendStacks(v8::Isolate* isolate) {
+  std::map<int, StackRequest> requests;
+  {
+    base::AutoLock lock(lock_);
+    requests.swap(requests_);
+    interrupt_requested_ = false;
+  }
+  base::TimeTicks now = base::TimeTicks::Now();
+  std::string stack;
+  bool captured = false;
+  for (const auto& pair : requests) {
+    // the script running now is not the one which hung.
+    if (now > pair.second.deadline) {
+      continue;
+    }
+    if (!captured) {
+      stack = CaptureStack(isolate);
+      captured = true;
+    }
+    content::RenderThread::Get()->Send(new MesonViewHostMsg_HangStack(pair.first, pair.second.request_id, stack));
+  }
+}
+
+// static
+std::string HangMonitorFilter::CaptureStack(v8::Isolate* isolate) {
+  v8::HandleScope handle_scope(isolate);
+  v8::Local<v8::StackTrace> trace = v8::StackTrace::CurrentStackTrace(isolate, kMaxStackFrames, v8::StackTrace::kDetailed);
+  std::string stack;
+  for (int i = 0; i < trace->GetFrameCount(); ++i) {
+    v8::Local<v8::StackFrame> frame = trace->GetFrame(i);
+    std::string function_name = ToString(frame->GetFunctionName());
+    std::string script_name = ToString(frame->GetScriptNameOrSourceURL());
+    base::StringAppendF(&stack, "    at %s (%s:%d:%d)\n",
+                        function_name.empty() ? "<anonymous>" : function_name.c_str(),
+                        script_name.empty() ? "<unknown>" : script_name.c_str(),
+                        frame->GetLineNumber(), frame->GetColumn());
+  }
+  return stack;
+}
+}
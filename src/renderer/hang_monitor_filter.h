@@ -0,0 +1,54 @@
+//-*-c++-*-
+#pragma once
+
+#include <map>
+#include <string>
+#include "base/macros.h"
+#include "base/synchronization/lock.h"
+#include "base/time/time.h"
+#include "ipc/message_filter.h"
+
+namespace v8 {
+class Isolate;
+}
+
+namespace meson {
+// Takes the JS stack of a hung main thread for the browser.
+// The request is received on the IO thread, as the main thread may not get to
+// it, and V8 is asked to interrupt the running script, which then sends the
+// stack from the main thread.
+// The requests are kept here until the interrupt comes, one per view (a newer
+// one replaces it), and the ones past their timeout are dropped.
+class HangMonitorFilter : public IPC::MessageFilter {
+ public:
+  HangMonitorFilter();
+
+  // called on the main thread once the isolate exists.
+  void SetIsolate(v8::Isolate* isolate);
+
+  // IPC::MessageFilter:
+  bool OnMessageReceived(const IPC::Message& message) override;
+
+ private:
+  ~HangMonitorFilter() override;
+
+  struct StackRequest {
+    int request_id;
+    base::TimeTicks deadline;
+  };
+
+  // |data| is the filter, referenced until the interrupt comes.
+  static void OnInterrupt(v8::Isolate* isolate, void* data);
+  void SendStacks(v8::Isolate* isolate);
+  static std::string CaptureStack(v8::Isolate* isolate);
+
+ private:
+  base::Lock lock_;
+  v8::Isolate* isolate_;
+  // routing id -> the request not answered yet.
+  std::map<int, StackRequest> requests_;
+  bool interrupt_requested_;
+
+  DISALLOW_COPY_AND_ASSIGN(HangMonitorFilter);
+};
+}
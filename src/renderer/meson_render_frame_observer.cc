@@ -77,6 +77,8 @@ bool MesonRenderFrameObserver::OnMessageReceived(const IPC::Message& message) {
   IPC_BEGIN_MESSAGE_MAP(MesonRenderFrameObserver, message)
     IPC_MESSAGE_HANDLER(MesonFrameMsg_WebViewEmit,
                         WebViewEmit)
+    IPC_MESSAGE_HANDLER(MesonFrameMsg_WebViewGuestCreated,
+                        WebViewGuestCreated)
     IPC_MESSAGE_HANDLER(MesonFrameMsg_RemoteDispatch,
                         RemoteDispatch)
     IPC_MESSAGE_UNHANDLED(handled = false)
@@ -108,11 +110,21 @@ void MesonRenderFrameObserver::WebViewEmit(int guest_instance_id,
                                            const std::string type,
                                            const base::DictionaryValue& event) {
   LOG(INFO) << __PRETTY_FUNCTION__;
+  // every bindings which registered a handler for the guest gets the event.
   for (size_t i = 0; i < web_view_bindings_.size(); ++i) {
     web_view_bindings_[i]->AttemptEmitEvent(guest_instance_id, type, event);
   }
 }
 
+void MesonRenderFrameObserver::WebViewGuestCreated(int request_id, int guest_instance_id) {
+  LOG(INFO) << __PRETTY_FUNCTION__;
+  for (size_t i = 0; i < web_view_bindings_.size(); ++i) {
+    if (web_view_bindings_[i]->AttemptGuestCreated(request_id, guest_instance_id)) {
+      break;
+    }
+  }
+}
+
 /******************************************************************************/
 /* REMOTE MESSAGE HANDLING */
 /******************************************************************************/
@@ -36,6 +36,7 @@ class MesonRenderFrameObserver : public content::RenderFrameObserver {
   void AddWebViewBindings(extensions::WebViewBindings* bindings);
   void RemoveWebViewBindings(extensions::WebViewBindings* bindings);
   void WebViewEmit(int guest_instance_id, const std::string type, const base::DictionaryValue& event);
+  void WebViewGuestCreated(int request_id, int guest_instance_id);
 
   // REMOTE MESSAGE HANDLING
   void AddRemoteBindings(extensions::RemoteBindings* bindings);
@@ -65,7 +65,7 @@ base::StringPiece NetResourceProvider(int key) {
 }  // namespace
 
 MesonRenderViewObserver::MesonRenderViewObserver(content::RenderView* render_view, MesonRendererClient* renderer_client)
-    : content::RenderViewObserver(render_view), document_created_(false) {
+    : content::RenderViewObserver(render_view), document_created_(false), frozen_(false), draggable_regions_sent_(false), draggable_regions_generation_(0) {
   LOG(INFO) << __PRETTY_FUNCTION__;
   // Initialise resource for directory listing.
   net::NetModule::SetResourceProvider(NetResourceProvider);
@@ -127,13 +127,35 @@ void MesonRenderViewObserver::DraggableRegionsChanged(blink::WebFrame* frame) {
     region.draggable = webregion.draggable;
     regions.push_back(region);
   }
-  Send(new MesonViewHostMsg_UpdateDraggableRegions(routing_id(), regions));
+  if (!draggable_regions_sent_) {
+    draggable_regions_sent_ = true;
+    Send(new MesonViewHostMsg_UpdateDraggableRegions(routing_id(), ++draggable_regions_generation_, regions));
+  } else {
+    // most layout changes do not move the regions, or only a few of them.
+    std::vector<DraggableRegionChange> changes;
+    for (size_t i = 0; i < regions.size(); ++i) {
+      if (i >= draggable_regions_.size() || regions[i] != draggable_regions_[i]) {
+        DraggableRegionChange change;
+        change.index = static_cast<uint32_t>(i);
+        change.region = regions[i];
+        changes.push_back(change);
+      }
+    }
+    if (changes.empty() && regions.size() == draggable_regions_.size()) {
+      return;
+    }
+    Send(new MesonViewHostMsg_UpdateDraggableRegionChanges(routing_id(), ++draggable_regions_generation_, static_cast<uint32_t>(regions.size()), changes));
+  }
+  draggable_regions_.swap(regions);
 }
 
 bool MesonRenderViewObserver::OnMessageReceived(const IPC::Message& message) {
   bool handled = true;
   IPC_BEGIN_MESSAGE_MAP(MesonRenderViewObserver, message)
     IPC_MESSAGE_HANDLER(MesonViewMsg_Message, OnBrowserMessage)
+    IPC_MESSAGE_HANDLER(MesonViewMsg_SetFrozen, OnSetFrozen)
+    IPC_MESSAGE_HANDLER(MesonViewMsg_Ping, OnPing)
+    IPC_MESSAGE_HANDLER(MesonViewMsg_ResendDraggableRegions, OnResendDraggableRegions)
     IPC_MESSAGE_UNHANDLED(handled = false)
   IPC_END_MESSAGE_MAP()
 
@@ -142,9 +164,34 @@ bool MesonRenderViewObserver::OnMessageReceived(const IPC::Message& message) {
 
 void MesonRenderViewObserver::OnDestruct() {
   LOG(INFO) << __PRETTY_FUNCTION__ << (long )this;
+  if (frozen_)
+    OnSetFrozen(false);
   delete this;
 }
 
+void MesonRenderViewObserver::OnSetFrozen(bool frozen) {
+  if (frozen == frozen_ || !render_view()->GetWebView())
+    return;
+  frozen_ = frozen;
+  // Same as a modal loop: timers, loading and active DOM objects are suspended.
+  if (frozen)
+    render_view()->GetWebView()->willEnterModalLoop();
+  else
+    render_view()->GetWebView()->didExitModalLoop();
+}
+
+void MesonRenderViewObserver::OnPing(int seq) {
+  // answered even when frozen, a frozen page is not hung.
+  Send(new MesonViewHostMsg_Pong(routing_id(), seq));
+}
+
+void MesonRenderViewObserver::OnResendDraggableRegions() {
+  // the browser lost track of the list (e.g. the contents moved to another
+  // window), the changes after this are based on it.
+  draggable_regions_sent_ = true;
+  Send(new MesonViewHostMsg_UpdateDraggableRegions(routing_id(), ++draggable_regions_generation_, draggable_regions_));
+}
+
 void MesonRenderViewObserver::OnBrowserMessage(bool send_to_all, const base::string16& channel, const base::ListValue& args) {
   LOG(INFO) << __PRETTY_FUNCTION__;
   if (!document_created_)
@@ -1,7 +1,9 @@
 //-*-c++-*-
 #pragma once
 
+#include <vector>
 #include "base/strings/string16.h"
+#include "common/draggable_region.h"
 #include "content/public/renderer/render_view_observer.h"
 #include "third_party/WebKit/public/web/WebFrame.h"
 
@@ -32,9 +34,18 @@ class MesonRenderViewObserver : public content::RenderViewObserver {
   void OnDestruct() override;
 
   void OnBrowserMessage(bool send_to_all, const base::string16& channel, const base::ListValue& args);
+  void OnSetFrozen(bool frozen);
+  void OnPing(int seq);
+  void OnResendDraggableRegions();
 
   // Whether the document object has been created.
   bool document_created_;
+  // Whether the page is suspended by the background throttling policy.
+  bool frozen_;
+  // The draggable regions last sent, the browser is sent the changes only.
+  std::vector<DraggableRegion> draggable_regions_;
+  bool draggable_regions_sent_;
+  uint32_t draggable_regions_generation_;
 
   DISALLOW_COPY_AND_ASSIGN(MesonRenderViewObserver);
 };
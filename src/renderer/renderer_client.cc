@@ -36,6 +36,7 @@
 #include "renderer/meson_render_frame_observer.h"
 #include "renderer/preferences_manager.h"
 #include "renderer/guest_view_container.h"
+#include "renderer/hang_monitor_filter.h"
 #include "renderer/extensions/document_bindings.h"
 #include "renderer/extensions/web_view_bindings.h"
 #include "renderer/extensions/remote_bindings.h"
@@ -93,17 +94,18 @@ void MesonRendererClient::RenderThreadStarted() {
   auto thread = content::RenderThread::Get();
   thread->RegisterExtension(extensions::SafeBuiltins::CreateV8Extension());
 
+  hang_monitor_filter_ = new HangMonitorFilter();
+  thread->AddFilter(hang_monitor_filter_.get());
+
+  // The sources refer to the embedded arrays directly, web_view.js is
+  // embedded gzip compressed and inflated on its first require.
   static const
-#include "renderer/resources/extensions/web_view.js.bin"
-      std::string
-      web_view_src(reinterpret_cast<const char*>(src_renderer_resources_extensions_web_view_js), src_renderer_resources_extensions_web_view_js_len);
-  source_map_.RegisterSource("webview", web_view_src);
+#include "renderer/resources/extensions/web_view.js.gz.bin"
+  source_map_.RegisterCompressedSource("webview", base::StringPiece(reinterpret_cast<const char*>(src_renderer_resources_extensions_web_view_js_gz), src_renderer_resources_extensions_web_view_js_gz_len));
 
   static const
 #include "renderer/resources/extensions/remote.js.bin"
-      std::string
-      remote_src(reinterpret_cast<const char*>(src_renderer_resources_extensions_remote_js), src_renderer_resources_extensions_remote_js_len);
-  source_map_.RegisterSource("remote", remote_src);
+  source_map_.RegisterSource("remote", base::StringPiece(reinterpret_cast<const char*>(src_renderer_resources_extensions_remote_js), src_renderer_resources_extensions_remote_js_len));
 }
 
 void MesonRendererClient::RenderFrameCreated(content::RenderFrame* render_frame) {
@@ -117,6 +119,8 @@ void MesonRendererClient::RenderFrameCreated(content::RenderFrame* render_frame)
 void MesonRendererClient::RenderViewCreated(content::RenderView* render_view) {
   LOG(INFO) << __PRETTY_FUNCTION__;
   new MesonRenderViewObserver(render_view, this);
+  // the isolate is created with the first view.
+  hang_monitor_filter_->SetIsolate(blink::mainThreadIsolate());
 
   auto* web_frame_widget = render_view->GetWebFrameWidget();
   if (!web_frame_widget)
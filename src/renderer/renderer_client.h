@@ -2,10 +2,12 @@
 #pragma once
 
 #include <memory>
+#include "base/memory/ref_counted.h"
 #include "content/public/renderer/content_renderer_client.h"
 #include "renderer/extensions/local_source_map.h"
 
 namespace meson {
+class HangMonitorFilter;
 class PreferencesManager;
 class MesonRendererClient : public content::ContentRendererClient {
  public:
@@ -48,6 +50,7 @@ class MesonRendererClient : public content::ContentRendererClient {
 
  private:
   std::unique_ptr<PreferencesManager> preferences_manager_;
+  scoped_refptr<HangMonitorFilter> hang_monitor_filter_;
   extensions::LocalSourceMap source_map_;
   DISALLOW_COPY_AND_ASSIGN(MesonRendererClient);
 };
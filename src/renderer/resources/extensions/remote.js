@@ -12,9 +12,10 @@ var remote = function(spec, my) {
   //
   // _public_
   //
-  var send;    /* send(message); */
-  var listen;  /* listen(cb_); */
-  var remove;  /* remove(cb_); */
+  var send;       /* send(message); */
+  var sendBuffer; /* sendBuffer(buffer, message); */
+  var listen;     /* listen(cb_); */
+  var remove;     /* remove(cb_); */
 
   //
   // _private_
@@ -57,6 +58,24 @@ var remote = function(spec, my) {
     RemoteNatives.SendMessage(message);
   };
 
+  // ### sendBuffer
+  //
+  // Sends an ArrayBuffer (or a view on it) through shared memory. The host
+  // receives it with the `remote-buffer` event and must release it.
+  // ```
+  // @buffer  {ArrayBuffer|ArrayBufferView} the data to send
+  // @message {object} optional message sent along with the buffer
+  // ```
+  sendBuffer = function(buffer, message) {
+    if(typeof message === 'undefined') {
+      message = {};
+    }
+    else if(typeof message !== 'object') {
+      message = { payload: message };
+    }
+    RemoteNatives.SendBuffer(message, buffer);
+  };
+
   // ### listen
   //
   // Adds a listener for remote messages
@@ -85,6 +104,7 @@ var remote = function(spec, my) {
   RemoteNatives.SetHandler(handler);
 
   that.send = send;
+  that.sendBuffer = sendBuffer;
   that.listen = listen;
   that.remove = remove;
 
@@ -51,9 +51,20 @@ var WEB_VIEW_EVENTS = {
   'crashed': ['process_id', 'reason'],
   'destroyed': [],
   'dialog': ['origin_url', 'accept_lang', 'message_type', 'message_text', 'default_prompt_text'],
-  'title-set': ['title', 'explicit_set']
+  'title-set': ['title', 'explicit_set'],
+  'found-in-page': ['result'],
+  'find-in-page-update': ['requestId', 'schema', 'updates', 'matches',
+                          'activeMatchOrdinal', 'finalUpdate', 'cancelled']
 };
 
+/* Events handled by the webview itself, they are sent without listeners. */
+var INTERNAL_WEB_VIEW_EVENTS = [
+  'did-commit-provisional-load',
+  'zoom-changed',
+  'title-set',
+  'dialog'
+];
+
 /* TODO(spolu): FixMe Chrome 39 */
 var PLUGIN_METHOD_ATTACH = '-internal-attach';
 
@@ -232,6 +243,14 @@ var webview = function(spec, my) {
   my.zoom_factor = 1.0;
   my.title = '';
 
+  /* Last size sent to the guest and resize counters */
+  my.normal_size = null;
+  my.resize_observed = 0;
+  my.resize_sent = 0;
+
+  /* Listeners of the guest events: type -> [[listener, capture]] */
+  my.event_listeners = {};
+
   //
   // _public_
     //
@@ -263,6 +282,7 @@ var webview = function(spec, my) {
   var api_closeDevTools;               /* api_closeDevTools(); */
   var api_isDevToolsOpened;            /* api_isDevToolsOpened(); */
   var api_getTitle;                    /* api_getTitle(); */
+  var api_getResizeStatistics;         /* api_getResizeStatistics(); */
   
   //
   // _private_
@@ -276,6 +296,8 @@ var webview = function(spec, my) {
   var build_attach_params;             /* build_attach_params(); */
   var attach_window;                   /* attach_window(instance_id); */
   var create_guest;                    /* create_guest(); */
+  var send_event_subscriptions;        /* send_event_subscriptions(); */
+  var setup_event_subscriptions;       /* setup_event_subscriptions(); */
   var attr_src_parse;                  /* attr_src_parse(); */
 
   //
@@ -409,22 +431,96 @@ var webview = function(spec, my) {
 
   // ### create_guest
   //
-  // Triggers the creation of the guest
+  // Triggers the creation of the guest. The creation is asynchronous, the
+  // guest is attached once the browser replies with its instance id.
   create_guest = function() {
     var params = {};
+    if(my.src) {
+      /* The process policy places the guest by the origin of its first page. */
+      try {
+        params.src = new URL(my.src, document.baseURI).href;
+      } catch(e) {}
+    }
 
-      console.log("create_guest0");
-    var instance_id = WebViewNatives.CreateGuest(params);
-
-    /* We register the event handler for events coming from the WebViewGuest. */
+    WebViewNatives.CreateGuest(params, function(instance_id) {
+      /* We register the event handler for events coming from the WebViewGuest. */
       WebViewNatives.SetEventHandler(instance_id, event_handler);
-      console.log("create_guest1");
 
-    if(!my.attached) {
-      WebViewNatives.DestroyGuest(instance_id);
+      if(!my.attached) {
+        WebViewNatives.DestroyGuest(instance_id);
+        my.before_first_navigation = true;
+        return;
+      }
+      attach_window(instance_id, false);
+      send_event_subscriptions();
+    });
+  };
+
+  // ### send_event_subscriptions
+  //
+  // Tells the browser which guest events have listeners, the others are not
+  // sent to this renderer
+  send_event_subscriptions = function() {
+    if(!my.guest_instance_id) {
       return;
     }
-    attach_window(instance_id, false);
+    var events = INTERNAL_WEB_VIEW_EVENTS.slice();
+    Object.keys(my.event_listeners).forEach(function(type) {
+      if(my.event_listeners[type].length > 0 && events.indexOf(type) < 0) {
+        events.push(type);
+      }
+    });
+    WebViewNatives.SetEventSubscriptions(my.guest_instance_id, events);
+  };
+
+  // ### setup_event_subscriptions
+  //
+  // Tracks the listeners of the guest events added to the node. Listeners
+  // added with `once` stay subscribed, which only costs unused events
+  setup_event_subscriptions = function() {
+    var node = my.webview_node;
+    var add = node.addEventListener;
+    var remove = node.removeEventListener;
+    var is_capture = function(options) {
+      return options === true || !!(options && options.capture);
+    };
+    var index_of = function(listeners, listener, capture) {
+      for(var i = 0; i < listeners.length; i++) {
+        if(listeners[i][0] === listener && listeners[i][1] === capture) {
+          return i;
+        }
+      }
+      return -1;
+    };
+
+    node.addEventListener = function(type, listener, options) {
+      var result = $Function.apply(add, node, arguments);
+      if(WEB_VIEW_EVENTS[type] && listener) {
+        var listeners = my.event_listeners[type] = my.event_listeners[type] || [];
+        var capture = is_capture(options);
+        if(index_of(listeners, listener, capture) < 0) {
+          listeners.push([listener, capture]);
+          if(listeners.length === 1) {
+            send_event_subscriptions();
+          }
+        }
+      }
+      return result;
+    };
+    node.removeEventListener = function(type, listener, options) {
+      var result = $Function.apply(remove, node, arguments);
+      var listeners = my.event_listeners[type];
+      if(listeners) {
+        var i = index_of(listeners, listener, is_capture(options));
+        if(i >= 0) {
+          listeners.splice(i, 1);
+          if(listeners.length === 0) {
+            send_event_subscriptions();
+          }
+        }
+      }
+      return result;
+    };
   };
 
   // ### attr_src_parse
@@ -577,7 +673,8 @@ var webview = function(spec, my) {
   // @request_id  {number} request id
   // @search_text {string} the search string
   // @options     {object} forward, match_case, find_next, 
-  //                       world_start, medial_capital_as_word_start
+  //                       world_start, medial_capital_as_word_start,
+  //                       stream, batch_interval
   // ```
   api_find = function(request_id, search_text, options) {
     if(!my.guest_instance_id) {
@@ -590,6 +687,11 @@ var webview = function(spec, my) {
     opt.word_start = (options || {}).word_start || false;
     opt.medial_capital_as_word_start = 
       (options || {}).medial_capital_as_word_start || false;
+    /* Streams "find-in-page-update" events while the page is scanned. */
+    opt.stream = (options || {}).stream || false;
+    /* 0 sends every update right away. */
+    opt.batch_interval = (options || {}).batch_interval === undefined ?
+      50 : options.batch_interval;
 
     WebViewNatives.Find(my.guest_instance_id, request_id, search_text, opt);
   };
@@ -677,6 +779,21 @@ var webview = function(spec, my) {
     return my.title;
   };
 
+  // ### api_getResizeStatistics
+  //
+  // Returns the resize notification counters of this webview along with the
+  // process wide ones (`observed`, `dispatched`, `saved`, and the time from a
+  // change to its dispatch in ms: `averageLatency`, `maxLatency`)
+  api_getResizeStatistics = function() {
+    var stats = WebViewNatives.GetResizeStatistics();
+    stats.webview = {
+      observed: my.resize_observed,
+      sent: my.resize_sent,
+      saved: my.resize_observed - my.resize_sent
+    };
+    return stats;
+  };
+
   /****************************************************************************/
   /* PUBLIC METHODS */
   /****************************************************************************/
@@ -708,7 +825,16 @@ var webview = function(spec, my) {
         resizeEvent.newWidth = newSize.width;
         resizeEvent.newHeight = newSize.height;
         my.webview_node.dispatchEvent(resizeEvent);
+        my.resize_observed++;
         if (my.guest_instance_id) {
+            /* Skip the IPC if the guest already has this size. */
+            if (my.normal_size &&
+                my.normal_size.width === newSize.width &&
+                my.normal_size.height === newSize.height) {
+                return;
+            }
+            my.normal_size = { width: newSize.width, height: newSize.height };
+            my.resize_sent++;
             api_setAutoSize({normal: newSize});
         }
     };
@@ -767,6 +893,7 @@ var webview = function(spec, my) {
       WebViewNatives.DestroyGuest(my.guest_instance_id);
       my.guest_instance_id = null;
       my.before_first_navigation = true;
+      my.normal_size = null;
     }
   };
 
@@ -817,6 +944,7 @@ var webview = function(spec, my) {
       r.innerHTML = '<!DOCTYPE html><style type="text/css">:host { display: flex; }</style>';
       setupWebViewAttributes();
       setupFocusPropagation();
+      setup_event_subscriptions();
       /* We create the shadow root for this element and append the browser */
       /* plugin node to it.                                                */
       r.appendChild(my.browser_plugin_node);
@@ -853,6 +981,7 @@ var webview = function(spec, my) {
     that.api_closeDevTools = api_closeDevTools;
     that.api_isDevToolsOpened = api_isDevToolsOpened;
     that.api_getTitle = api_getTitle;
+    that.api_getResizeStatistics = api_getResizeStatistics;
 
     init();
 
@@ -962,6 +1091,7 @@ function registerWebViewElement() {
     'closeDevTools',
     'isDevToolsOpened',
     'getTitle',
+    'getResizeStatistics',
     /*
     'clearData',
     'print',